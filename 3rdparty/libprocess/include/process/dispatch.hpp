@@ -15,13 +15,18 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <process/process.hpp>
 
 #include <stout/lambda.hpp>
+#include <stout/none.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/preprocessor.hpp>
 #include <stout/result_of.hpp>
+#include <stout/synchronized.hpp>
 
 namespace process {
 
@@ -468,6 +473,205 @@ auto dispatch(const UPID& pid, F&& f)
   return internal::Dispatch<R>()(pid, std::forward<F>(f));
 }
 
+
+
+// Coalescing dispatches.
+//
+// Some methods are idempotent in the sense that invoking them once is
+// just as good as invoking them several times in a row, e.g., a method
+// that recomputes some state from scratch. When such a method gets
+// dispatched repeatedly (e.g., every time some input changes) while
+// the process is busy, the redundant invocations pile up on the event
+// queue. Dispatching through a `Coalescer` collapses all dispatches
+// made while an earlier dispatch (made through the same `Coalescer`)
+// has not yet started running into that earlier dispatch; all of the
+// callers get the same future. A dispatch made once the earlier one
+// has started running results in a new event, so changes made
+// concurrently with the running invocation are never missed.
+//
+// For example:
+//
+//   class Allocator : public Process<Allocator>
+//   {
+//   public:
+//     Future<Nothing> allocate()
+//     {
+//       return dispatch(allocation, self(), &Allocator::_allocate);
+//     }
+//
+//   private:
+//     Nothing _allocate();
+//
+//     Coalescer<Nothing> allocation;
+//   };
+//
+// Only methods that take no arguments can be coalesced. A `Coalescer`
+// can be used from any thread.
+template <typename R>
+class Coalescer;
+
+
+namespace internal {
+
+// Dispatches `f` (a callable taking a `T*` and returning something
+// convertible to `Future<R>`) through `coalescer`.
+template <typename R, typename T, typename F>
+Future<R> coalesce(
+    Coalescer<R>& coalescer,
+    const PID<T>& pid,
+    const std::type_info* type,
+    F&& f);
+
+} // namespace internal {
+
+
+template <typename R>
+class Coalescer
+{
+public:
+  Coalescer() : data(new Data()) {}
+
+  // Returns whether a dispatch made through this coalescer has not
+  // yet started running, i.e., whether the next dispatch will be
+  // coalesced into it.
+  bool pending() const
+  {
+    synchronized (data->mutex) {
+      return data->pending();
+    }
+  }
+
+private:
+  template <typename S, typename T, typename F>
+  friend Future<S> internal::coalesce(
+      Coalescer<S>& coalescer,
+      const PID<T>& pid,
+      const std::type_info* type,
+      F&& f);
+
+  struct Data
+  {
+    bool pending() const
+    {
+      return future.isSome() &&
+        future->isPending() &&
+        !future->isAbandoned();
+    }
+
+    std::mutex mutex;
+
+    // The future of the dispatch that has not yet started running, if
+    // any. Note that if the process terminates before the dispatch
+    // runs the future gets abandoned.
+    Option<Future<R>> future;
+  };
+
+  std::shared_ptr<Data> data;
+};
+
+
+namespace internal {
+
+template <typename R, typename T, typename F>
+Future<R> coalesce(
+    Coalescer<R>& coalescer,
+    const PID<T>& pid,
+    const std::type_info* type,
+    F&& f)
+{
+  std::shared_ptr<typename Coalescer<R>::Data> data = coalescer.data;
+
+  std::unique_ptr<Promise<R>> promise(new Promise<R>());
+  Future<R> future = promise->future();
+
+  synchronized (data->mutex) {
+    if (data->pending()) {
+      return data->future.get();
+    }
+
+    data->future = future;
+  }
+
+  std::unique_ptr<lambda::CallableOnce<void(ProcessBase*)>> f_(
+      new lambda::CallableOnce<void(ProcessBase*)>(
+          lambda::partial(
+              [data](std::unique_ptr<Promise<R>> promise,
+                     typename std::decay<F>::type&& f,
+                     ProcessBase* process) {
+                assert(process != nullptr);
+                T* t = dynamic_cast<T*>(process);
+                assert(t != nullptr);
+
+                // Any dispatch from now on must result in a new
+                // invocation as it might have been triggered by
+                // changes this invocation won't observe.
+                synchronized (data->mutex) {
+                  if (data->future.isSome() &&
+                      data->future.get() == promise->future()) {
+                    data->future = None();
+                  }
+                }
+
+                promise->associate(std::move(f)(t));
+              },
+              std::move(promise),
+              std::forward<F>(f),
+              lambda::_1)));
+
+  internal::dispatch(pid, std::move(f_), type);
+
+  return future;
+}
+
+} // namespace internal {
+
+
+template <typename T>
+Future<Nothing> dispatch(
+    Coalescer<Nothing>& coalescer,
+    const PID<T>& pid,
+    void (T::*method)())
+{
+  return internal::coalesce(
+      coalescer,
+      pid,
+      &typeid(method),
+      [method](T* t) -> Future<Nothing> {
+        (t->*method)();
+        return Nothing();
+      });
+}
+
+template <typename R, typename T>
+Future<R> dispatch(
+    Coalescer<R>& coalescer,
+    const PID<T>& pid,
+    Future<R> (T::*method)())
+{
+  return internal::coalesce(
+      coalescer,
+      pid,
+      &typeid(method),
+      [method](T* t) -> Future<R> {
+        return (t->*method)();
+      });
+}
+
+template <typename R, typename T>
+Future<R> dispatch(
+    Coalescer<R>& coalescer,
+    const PID<T>& pid,
+    R (T::*method)())
+{
+  return internal::coalesce(
+      coalescer,
+      pid,
+      &typeid(method),
+      [method](T* t) -> Future<R> {
+        return (t->*method)();
+      });
+}
+
 } // namespace process {
 
 #endif // __PROCESS_DISPATCH_HPP__
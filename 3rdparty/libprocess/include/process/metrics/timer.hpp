@@ -87,6 +87,25 @@ public:
     return t;
   }
 
+  // Record a measurement that was taken by the caller, e.g., the
+  // total of several disjoint intervals.
+  T record(const Duration& duration)
+  {
+    const T t(duration);
+
+    double value = 0.0;
+
+    synchronized (data->lock) {
+      data->lastValue = t.value();
+
+      value = data->lastValue.get();
+    }
+
+    push(value);
+
+    return t;
+  }
+
   // Time an asynchronous event.
   template <typename U>
   Future<U> time(const Future<U>& future)
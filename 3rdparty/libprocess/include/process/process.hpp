@@ -484,6 +484,10 @@ private:
   // the process unmanaged and thus it may leak!
   bool manage = false;
 
+  // Index of the dedicated worker thread this process is pinned to,
+  // if any (see the `LIBPROCESS_DEDICATED_WORKERS` flag).
+  Option<size_t> dedicated;
+
   // Process PID.
   UPID pid;
 };
@@ -19,6 +19,7 @@
 #endif // __WINDOWS__
 
 #include <memory>
+#include <vector>
 
 #include <process/address.hpp>
 #include <process/future.hpp>
@@ -70,6 +71,18 @@ public:
 #endif
   };
 
+  /**
+   * A non-owning view of a contiguous range of bytes, used to send
+   * several buffers with a single gather write.
+   *
+   * @see send(const std::vector<Buffer>&)
+   */
+  struct Buffer
+  {
+    const char* data;
+    size_t size;
+  };
+
   /**
    * Returns the default `Kind` of implementation.
    */
@@ -154,6 +167,22 @@ public:
   virtual Future<size_t> send(const char* data, size_t size) = 0;
   virtual Future<size_t> sendfile(int_fd fd, off_t offset, size_t size) = 0;
 
+  /**
+   * An overload of `send`, which sends the specified buffers in order
+   * as though they were one contiguous buffer (i.e., `writev` or
+   * `sendmsg` semantics). The caller must keep the underlying data
+   * alive until the returned future is satisfied.
+   *
+   * Like the single buffer `send`, this may send fewer bytes than
+   * the total size of the buffers. The default implementation copies
+   * the buffers into a single buffer and sends that, so that it still
+   * takes a single send; implementations that support gather writes
+   * should override it.
+   *
+   * @return The number of bytes sent across all of the buffers.
+   */
+  virtual Future<size_t> send(const std::vector<Buffer>& buffers);
+
   /**
    * An overload of `recv`, which receives data based on the specified
    * 'size' parameter.
@@ -378,6 +407,12 @@ public:
     return impl->sendfile(fd, offset, size);
   }
 
+  Future<size_t> send(
+      const std::vector<internal::SocketImpl::Buffer>& buffers) const
+  {
+    return impl->send(buffers);
+  }
+
   Future<std::string> recv(const Option<ssize_t>& size = None())
   {
     return impl->recv(size);
@@ -23,16 +23,25 @@
 
 #include <deque>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <process/address.hpp>
 #include <process/http.hpp>
+#include <process/message.hpp>
 
 #include <stout/foreach.hpp>
 #include <stout/gzip.hpp>
 #include <stout/option.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
+#include "encoder.hpp"
+
 
 #if !(HTTP_PARSER_VERSION_MAJOR >= 2)
 #error HTTP Parser version >= 2 required.
@@ -84,13 +93,9 @@ public:
       failure = true;
     }
 
-    if (!requests.empty()) {
-      std::deque<http::Request*> result = requests;
-      requests.clear();
-      return result;
-    }
-
-    return std::deque<http::Request*>();
+    std::deque<http::Request*> result;
+    std::swap(result, requests);
+    return result;
   }
 
   bool failed() const
@@ -148,7 +153,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->request->headers[decoder->field] = decoder->value;
+      decoder->request->headers[std::move(decoder->field)] =
+        std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -175,7 +181,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     // Add final header.
-    decoder->request->headers[decoder->field] = decoder->value;
+    decoder->request->headers[std::move(decoder->field)] =
+      std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -329,13 +336,9 @@ public:
       failure = true;
     }
 
-    if (!responses.empty()) {
-      std::deque<http::Response*> result = responses;
-      responses.clear();
-      return result;
-    }
-
-    return std::deque<http::Response*>();
+    std::deque<http::Response*> result;
+    std::swap(result, responses);
+    return result;
   }
 
   bool failed() const
@@ -387,7 +390,8 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->response->headers[decoder->field] = decoder->value;
+      decoder->response->headers[std::move(decoder->field)] =
+        std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -414,7 +418,8 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     // Add final header.
-    decoder->response->headers[decoder->field] = decoder->value;
+    decoder->response->headers[std::move(decoder->field)] =
+      std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -632,7 +637,8 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->response->headers[decoder->field] = decoder->value;
+      decoder->response->headers[std::move(decoder->field)] =
+        std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -661,7 +667,8 @@ private:
     CHECK_NOTNULL(decoder->response);
 
     // Add final header.
-    decoder->response->headers[decoder->field] = decoder->value;
+    decoder->response->headers[std::move(decoder->field)] =
+      std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -753,11 +760,84 @@ private:
 // the request headers are received, but before the body data
 // is received. Callers are expected to read the body from the
 // Pipe::Reader in the request.
+// Requests decoded by a `StreamingRequestDecoder` that the caller is
+// done with, see `ProcessManager::handle`. Decoding the next request
+// on the connection reuses one of these (including its header map and
+// URL path buffer) instead of allocating a new request. Requests can
+// be released from any thread.
+class RequestPool
+{
+public:
+  RequestPool() = default;
+
+  RequestPool(const RequestPool&) = delete;
+  RequestPool& operator=(const RequestPool&) = delete;
+
+  ~RequestPool()
+  {
+    foreach (http::Request* request, requests) {
+      delete request;
+    }
+  }
+
+  http::Request* acquire()
+  {
+    http::Request* request = nullptr;
+
+    synchronized (mutex) {
+      if (requests.empty()) {
+        return new http::Request();
+      }
+
+      request = requests.back();
+      requests.pop_back();
+    }
+
+    // Reset everything but the (cleared) containers, which keep
+    // their capacity.
+    http::Headers headers = std::move(request->headers);
+    std::string path = std::move(request->url.path);
+
+    *request = http::Request();
+
+    headers.clear();
+    path.clear();
+
+    request->headers = std::move(headers);
+    request->url.path = std::move(path);
+
+    return request;
+  }
+
+  void release(http::Request* request)
+  {
+    synchronized (mutex) {
+      if (requests.size() < CAPACITY) {
+        requests.push_back(request);
+        return;
+      }
+    }
+
+    delete request;
+  }
+
+private:
+  // Bounds the memory held on to by an idle connection.
+  static const size_t CAPACITY = 4;
+
+  std::mutex mutex;
+  std::vector<http::Request*> requests;
+};
+
+
 class StreamingRequestDecoder
 {
 public:
   explicit StreamingRequestDecoder()
-    : failure(false), header(HEADER_FIELD), request(nullptr)
+    : failure(false),
+      header(HEADER_FIELD),
+      request(nullptr),
+      pool(std::make_shared<RequestPool>())
   {
     http_parser_settings_init(&settings);
 
@@ -801,7 +881,16 @@ public:
   std::deque<http::Request*> decode(const char* data, size_t length)
   {
     size_t parsed = http_parser_execute(&parser, &settings, data, length);
-    if (parsed != length) {
+    if (parsed != length &&
+        !failure &&
+        request == nullptr &&
+        writer.isNone() &&
+        data[parsed] == FRAME_MARKER) {
+      // The peer switched the connection to binary frames after its
+      // last complete request, see `SocketManager::framing`. The
+      // caller decodes the rest of the data with a `FrameDecoder`.
+      frames = parsed;
+    } else if (parsed != length) {
       // TODO(bmahler): joyent/http-parser exposes error reasons.
       failure = true;
 
@@ -827,6 +916,22 @@ public:
     return failure;
   }
 
+  // Returns the offset into the data passed to the last call to
+  // `decode` at which the peer started sending binary frames, if
+  // it did.
+  Option<size_t> framed() const
+  {
+    return frames;
+  }
+
+  // Returns the pool that the caller can hand the decoded requests
+  // back to once it is done with them. The pool may outlive the
+  // decoder.
+  const std::shared_ptr<RequestPool>& requestPool() const
+  {
+    return pool;
+  }
+
 private:
   static int on_message_begin(http_parser* p)
   {
@@ -843,7 +948,7 @@ private:
     CHECK(decoder->request == nullptr);
     CHECK_NONE(decoder->writer);
 
-    decoder->request = new http::Request();
+    decoder->request = decoder->pool->acquire();
     decoder->request->type = http::Request::PIPE;
     decoder->writer = None();
     decoder->decompressor.reset();
@@ -883,7 +988,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->request->headers[decoder->field] = decoder->value;
+      decoder->request->headers[std::move(decoder->field)] =
+        std::move(decoder->value);
       decoder->field.clear();
       decoder->value.clear();
     }
@@ -912,7 +1018,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     // Add final header.
-    decoder->request->headers[decoder->field] = decoder->value;
+    decoder->request->headers[std::move(decoder->field)] =
+      std::move(decoder->value);
     decoder->field.clear();
     decoder->value.clear();
 
@@ -934,7 +1041,7 @@ private:
     }
 
     if (url.field_set & (1 << UF_PATH)) {
-      decoder->request->url.path = std::string(
+      decoder->request->url.path.assign(
           decoder->url.data() + url.field_data[UF_PATH].off,
           url.field_data[UF_PATH].len);
     }
@@ -1060,6 +1167,113 @@ private:
   Owned<gzip::Decompressor> decompressor;
 
   std::deque<http::Request*> requests;
+
+  std::shared_ptr<RequestPool> pool;
+
+  Option<size_t> frames;
+};
+
+// Decodes messages sent using the binary framing, see `FrameEncoder`.
+// Only the receiver's ID is part of a frame, so every decoded message
+// is addressed to the local `address` passed at construction.
+class FrameDecoder
+{
+public:
+  explicit FrameDecoder(const network::inet::Address& _address)
+    : address(_address), failure(false) {}
+
+  std::deque<Message*> decode(const char* data, size_t length)
+  {
+    buffer.append(data, length);
+
+    std::deque<Message*> messages;
+
+    size_t index = 0;
+
+    while (buffer.size() - index >= FRAME_HEADER_SIZE) {
+      const char* frame = buffer.data() + index;
+
+      if (frame[0] != FRAME_MARKER) {
+        failure = true;
+        break;
+      }
+
+      const size_t name = read(frame + 1);
+      const size_t from = read(frame + 1 + sizeof(uint32_t));
+      const size_t to = read(frame + 1 + 2 * sizeof(uint32_t));
+      const size_t body = read(frame + 1 + 3 * sizeof(uint32_t));
+
+      const size_t size = FRAME_HEADER_SIZE + name + from + to + body;
+
+      // Don't let a peer make us buffer arbitrarily large frames.
+      if (name > FRAME_MAX_NAME_SIZE ||
+          from > FRAME_MAX_NAME_SIZE ||
+          to > FRAME_MAX_NAME_SIZE ||
+          size > FRAME_MAX_SIZE) {
+        failure = true;
+        break;
+      }
+
+      // Wait for the rest of the frame.
+      if (buffer.size() - index < size) {
+        break;
+      }
+
+      const char* next = frame + FRAME_HEADER_SIZE;
+
+      // Every message needs a sender that can be replied to, so a
+      // frame with a malformed sender is treated like a malformed
+      // frame (which closes the connection).
+      std::istringstream sender(std::string(next + name, from));
+      UPID pid;
+      sender >> pid;
+
+      if (!sender || !pid) {
+        failure = true;
+        break;
+      }
+
+      Message* message = new Message();
+      message->name.assign(next, name);
+      next += name;
+      message->from = std::move(pid);
+      next += from;
+      message->to = UPID(std::string(next, to), address);
+      next += to;
+      message->body.assign(next, body);
+
+      messages.push_back(message);
+
+      index += size;
+    }
+
+    // Only keep the bytes of the partially received frame (if any).
+    buffer.erase(0, index);
+
+    return messages;
+  }
+
+  bool failed() const
+  {
+    return failure;
+  }
+
+private:
+  static size_t read(const char* data)
+  {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    return (static_cast<size_t>(bytes[0]) << 24) |
+           (static_cast<size_t>(bytes[1]) << 16) |
+           (static_cast<size_t>(bytes[2]) << 8) |
+           static_cast<size_t>(bytes[3]);
+  }
+
+  const network::inet::Address address;
+
+  bool failure;
+
+  std::string buffer;
 };
 
 }  // namespace process {
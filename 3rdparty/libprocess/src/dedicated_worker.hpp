@@ -0,0 +1,79 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_DEDICATED_WORKER_HPP__
+#define __PROCESS_DEDICATED_WORKER_HPP__
+
+#include <string>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+namespace process {
+namespace internal {
+
+// An entry of the `--dedicated_workers` flag: processes whose ID
+// matches `id` get their own worker thread, optionally pinned to
+// `cpu`.
+struct DedicatedWorker
+{
+  static Try<std::vector<DedicatedWorker>> parse(const std::string& value)
+  {
+    std::vector<DedicatedWorker> workers;
+
+    foreach (const std::string& token, strings::tokenize(value, ",")) {
+      std::vector<std::string> parts =
+        strings::split(strings::trim(token), ":");
+
+      if (parts.size() > 2 || parts[0].empty()) {
+        return Error("Invalid entry '" + token + "'");
+      }
+
+      DedicatedWorker worker;
+      worker.id = parts[0];
+
+      if (parts.size() == 2) {
+        Try<int> cpu = numify<int>(parts[1]);
+        if (cpu.isError() || cpu.get() < 0) {
+          return Error("Invalid CPU '" + parts[1] + "' for '" + parts[0] + "'");
+        }
+
+        worker.cpu = cpu.get();
+      }
+
+      workers.push_back(worker);
+    }
+
+    return workers;
+  }
+
+  // Returns whether the process with the given ID should run on this
+  // dedicated worker, i.e., the ID is `id` or `id` followed by a
+  // suffix generated by `ID::generate`.
+  bool matches(const std::string& pid) const
+  {
+    return pid == id || strings::startsWith(pid, id + "(");
+  }
+
+  std::string id;
+  Option<int> cpu;
+};
+
+} // namespace internal {
+} // namespace process {
+
+#endif // __PROCESS_DEDICATED_WORKER_HPP__
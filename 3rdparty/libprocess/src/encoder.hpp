@@ -19,9 +19,12 @@
 #include <limits>
 #include <map>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <process/http.hpp>
 #include <process/process.hpp>
+#include <process/socket.hpp>
 
 #include <stout/foreach.hpp>
 #include <stout/gzip.hpp>
@@ -34,6 +37,17 @@ namespace process {
 
 const uint32_t GZIP_MINIMUM_BODY_LENGTH = 1024;
 
+// See `FrameEncoder` for the layout of a binary frame.
+const char FRAME_MARKER = '\0';
+const size_t FRAME_HEADER_SIZE = 1 + 4 * sizeof(uint32_t);
+
+// The maximum sizes of the name, sender and receiver of a frame, and
+// of the whole frame, above which the receiver closes the connection
+// instead of buffering the frame. Larger bodies could not be parsed
+// as protobuf messages anyway.
+const size_t FRAME_MAX_NAME_SIZE = 64 * 1024;
+const size_t FRAME_MAX_SIZE = std::numeric_limits<int32_t>::max();
+
 // Forward declarations.
 class Encoder;
 
@@ -44,7 +58,8 @@ public:
   enum Kind
   {
     DATA,
-    FILE
+    FILE,
+    IOVEC
   };
 
   Encoder() = default;
@@ -98,13 +113,112 @@ private:
 };
 
 
-class MessageEncoder : public DataEncoder
+// Encodes data held in one or more separately owned segments which
+// get sent with a single gather write (see `Socket::send`) rather
+// than first being copied into one contiguous buffer.
+class IOVecEncoder : public Encoder
+{
+public:
+  typedef network::internal::SocketImpl::Buffer Buffer;
+
+  IOVecEncoder(std::vector<std::string>&& _segments)
+    : segments(std::move(_segments)), size(0), index(0)
+  {
+    foreach (const std::string& segment, segments) {
+      size += segment.size();
+    }
+  }
+
+  virtual ~IOVecEncoder() {}
+
+  virtual Kind kind() const
+  {
+    return Encoder::IOVEC;
+  }
+
+  // Returns the buffers that remain to be sent and sets `length` to
+  // their total size. The returned buffers point into this encoder
+  // and stay valid until the encoder is deleted.
+  virtual std::vector<Buffer> next(size_t* length)
+  {
+    std::vector<Buffer> buffers;
+
+    size_t offset = index;
+    foreach (const std::string& segment, segments) {
+      if (offset >= segment.size()) {
+        offset -= segment.size();
+        continue;
+      }
+
+      buffers.push_back({segment.data() + offset, segment.size() - offset});
+      offset = 0;
+    }
+
+    *length = size - index;
+    index = size;
+    return buffers;
+  }
+
+  virtual void backup(size_t length)
+  {
+    if (index >= length) {
+      index -= length;
+    }
+  }
+
+  virtual size_t remaining() const
+  {
+    return size - index;
+  }
+
+private:
+  const std::vector<std::string> segments;
+  size_t size;
+  size_t index;
+};
+
+
+// Encodes a message as an HTTP POST, keeping the (possibly large)
+// body in its own segment so that it never gets copied when the
+// message is moved into the encoder.
+class MessageEncoder : public IOVecEncoder
 {
 public:
   MessageEncoder(const Message& message)
-    : DataEncoder(encode(message)) {}
+    : IOVecEncoder(split(Message(message))) {}
+
+  MessageEncoder(Message&& message)
+    : IOVecEncoder(split(std::move(message))) {}
 
   static std::string encode(const Message& message)
+  {
+    std::string result = header(message);
+
+    if (message.body.size() > 0) {
+      result.append(message.body);
+      result.append("\r\n0\r\n\r\n");
+    }
+
+    return result;
+  }
+
+private:
+  static std::vector<std::string> split(Message&& message)
+  {
+    std::vector<std::string> segments;
+    segments.push_back(header(message));
+
+    if (message.body.size() > 0) {
+      segments.push_back(std::move(message.body));
+      segments.push_back("\r\n0\r\n\r\n");
+    }
+
+    return segments;
+  }
+
+  // Returns everything that precedes the body, including the chunk
+  // size line when the message has a body.
+  static std::string header(const Message& message)
   {
     std::ostringstream out;
 
@@ -121,16 +235,13 @@ public:
     out << "/" << message.name << " HTTP/1.1\r\n"
         << "User-Agent: libprocess/" << message.from << "\r\n"
         << "Libprocess-From: " << message.from << "\r\n"
+        << "Libprocess-Framing: binary\r\n"
         << "Connection: Keep-Alive\r\n"
         << "Host: \r\n";
 
     if (message.body.size() > 0) {
       out << "Transfer-Encoding: chunked\r\n\r\n"
           << std::hex << message.body.size() << "\r\n";
-      out.write(message.body.data(), message.body.size());
-      out << "\r\n"
-          << "0\r\n"
-          << "\r\n";
     } else {
       out << "\r\n";
     }
@@ -140,6 +251,69 @@ public:
 };
 
 
+// Encodes a message using the binary framing negotiated between
+// libprocess instances, which avoids generating (and parsing) HTTP
+// headers. Each frame is laid out as:
+//
+//   FRAME_MARKER (1 byte, can never start an HTTP request line)
+//   length of the name (4 bytes, big endian)
+//   length of the sender's UPID (4 bytes, big endian)
+//   length of the receiver's ID (4 bytes, big endian)
+//   length of the body (4 bytes, big endian)
+//   name, sender's UPID, receiver's ID, body
+//
+// The receiver's address is implied by the connection. A peer
+// advertises that it can decode frames with the 'Libprocess-Framing'
+// header on the HTTP messages it sends, see `MessageEncoder`.
+class FrameEncoder : public IOVecEncoder
+{
+public:
+  FrameEncoder(const Message& message)
+    : IOVecEncoder(split(Message(message))) {}
+
+  FrameEncoder(Message&& message)
+    : IOVecEncoder(split(std::move(message))) {}
+
+private:
+  static void append(std::string* out, size_t length)
+  {
+    CHECK_LE(length, std::numeric_limits<uint32_t>::max());
+
+    out->push_back(static_cast<char>((length >> 24) & 0xff));
+    out->push_back(static_cast<char>((length >> 16) & 0xff));
+    out->push_back(static_cast<char>((length >> 8) & 0xff));
+    out->push_back(static_cast<char>(length & 0xff));
+  }
+
+  static std::vector<std::string> split(Message&& message)
+  {
+    const std::string from = stringify(message.from);
+    const std::string& to = message.to.id;
+
+    std::string header;
+    header.reserve(
+        FRAME_HEADER_SIZE + message.name.size() + from.size() + to.size());
+    header.push_back(FRAME_MARKER);
+    append(&header, message.name.size());
+    append(&header, from.size());
+    append(&header, to.size());
+    append(&header, message.body.size());
+    header.append(message.name);
+    header.append(from);
+    header.append(to);
+
+    std::vector<std::string> segments;
+    segments.push_back(std::move(header));
+
+    if (message.body.size() > 0) {
+      segments.push_back(std::move(message.body));
+    }
+
+    return segments;
+  }
+};
+
+
 class HttpResponseEncoder : public DataEncoder
 {
 public:
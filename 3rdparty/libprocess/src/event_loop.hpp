@@ -24,8 +24,11 @@ namespace process {
 class EventLoop
 {
 public:
-  // Initializes the event loop.
-  static void initialize();
+  // Initializes the event loop. Implementations that support it shard
+  // the I/O on file descriptors across `threads` event loops, each of
+  // which is run by its own thread (see `run`), and poll using io_uring
+  // if `io_uring` is true.
+  static void initialize(size_t threads, bool io_uring);
 
   // Invoke the specified function in the event loop after the
   // specified duration.
@@ -37,11 +40,15 @@ public:
   // Returns the current time w.r.t. the event loop.
   static double time();
 
-  // Runs the event loop.
+  // Runs the event loop(s), returning once they have been stopped.
   static void run();
 
   // Asynchronously tells the event loop to stop and then returns.
   static void stop();
+
+  // Releases the event loop(s) once `run` has returned, so that the
+  // event loop can be initialized again.
+  static void finalize();
 };
 
 } // namespace process {
@@ -41,6 +41,17 @@ namespace process {
 //   * Consumers _must_ call `empty()` before calling
 //     `dequeue()`. Failing to do so may result in undefined behavior.
 //
+//   * Consumers can call `empty(batch)` instead of `empty()` in order
+//     to move up to `batch` events out of the queue at once (i.e.,
+//     with a single lock acquisition or bulk dequeue). Subsequent
+//     calls to `empty(batch)` and `dequeue()` are then served from
+//     these _drained_ events without synchronizing with producers.
+//     Note that `empty()` does not necessarily account for drained
+//     events, so a consumer should only call it after it has
+//     dequeued all of them (i.e., after `empty(batch)` returned
+//     true). Drained events are still included in `count()` and
+//     `operator JSON::Array()`.
+//
 //   * After a consumer calls `decomission()` they _must_ not call any
 //     thing else (not even `empty()` and especially not
 //     `dequeue()`). Doing so is undefined behavior.
@@ -88,6 +99,7 @@ public:
   public:
     Event* dequeue() { return queue->dequeue(); }
     bool empty() { return queue->empty(); }
+    bool empty(size_t batch) { return queue->empty(batch); }
     void decomission() { queue->decomission(); }
     template <typename T>
     size_t count() { return queue->count<T>(); }
@@ -123,6 +135,12 @@ private:
 
   Event* dequeue()
   {
+    if (!drained.empty()) {
+      Event* event = drained.front();
+      drained.pop_front();
+      return event;
+    }
+
     Event* event = nullptr;
 
     synchronized (mutex) {
@@ -145,8 +163,30 @@ private:
     }
   }
 
+  bool empty(size_t batch)
+  {
+    if (!drained.empty()) {
+      return false;
+    }
+
+    synchronized (mutex) {
+      while (!events.empty() && drained.size() < batch) {
+        drained.push_back(events.front());
+        events.pop_front();
+      }
+    }
+
+    return drained.empty();
+  }
+
   void decomission()
   {
+    while (!drained.empty()) {
+      Event* event = drained.front();
+      drained.pop_front();
+      delete event;
+    }
+
     synchronized (mutex) {
       comissioned = false;
       while (!events.empty()) {
@@ -160,19 +200,25 @@ private:
   template <typename T>
   size_t count()
   {
+    auto is = [](const Event* event) {
+      return event->is<T>();
+    };
+
+    size_t count = std::count_if(drained.begin(), drained.end(), is);
+
     synchronized (mutex) {
-      return std::count_if(
-          events.begin(),
-          events.end(),
-          [](const Event* event) {
-            return event->is<T>();
-          });
+      return count + std::count_if(events.begin(), events.end(), is);
     }
   }
 
   operator JSON::Array()
   {
     JSON::Array array;
+
+    foreach (Event* event, drained) {
+      array.values.push_back(JSON::Object(*event));
+    }
+
     synchronized (mutex) {
       foreach (Event* event, events) {
         array.values.push_back(JSON::Object(*event));
@@ -184,6 +230,12 @@ private:
   std::mutex mutex;
   std::deque<Event*> events;
   bool comissioned = true;
+
+  // Events moved out of `events` by `empty(batch)` but not yet
+  // dequeued. Like the consumer itself this is only ever read or
+  // written by a single thread at a time so it's not protected by
+  // `mutex`.
+  std::deque<Event*> drained;
 #else // LOCK_FREE_EVENT_QUEUE
   void enqueue(Event* event)
   {
@@ -221,6 +273,22 @@ private:
     return (sequence.load() - next) == 0;
   }
 
+  bool empty(size_t batch)
+  {
+    if (empty()) {
+      return true;
+    }
+
+    // Bulk dequeue up to `batch` items now so that the subsequent
+    // `dequeue()` calls will likely find the next item in `items`
+    // without touching `queue` (see `try_dequeue()`).
+    if (items.empty()) {
+      queue.try_dequeue_bulk(std::back_inserter(items), batch);
+    }
+
+    return false;
+  }
+
   void decomission()
   {
     comissioned.store(true);
@@ -838,7 +838,7 @@ Try<vector<Response>> decodeResponses(const string& s)
 
   auto appendResult = [&result](const deque<http::Response*>& responses) {
     foreach (Response* response, responses) {
-      result.push_back(*response);
+      result.push_back(std::move(*response));
       delete response;
     }
   };
@@ -1486,6 +1486,10 @@ Future<Nothing> send(network::Socket socket, Encoder* encoder)
             const char* data = static_cast<DataEncoder*>(encoder)->next(size);
             return socket.send(data, *size);
           }
+          case Encoder::IOVEC: {
+            return socket.send(
+                static_cast<IOVecEncoder*>(encoder)->next(size));
+          }
           case Encoder::FILE: {
             off_t offset = 0;
             int_fd fd = static_cast<FileEncoder*>(encoder)->next(&offset, size);
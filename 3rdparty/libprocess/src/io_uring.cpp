@@ -0,0 +1,520 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <ev.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <linux/io_uring.h>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <process/future.hpp>
+#include <process/io.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/strerror.hpp>
+
+#include "io_uring.hpp"
+#include "libev.hpp"
+
+// Older C libraries don't define the system call numbers (the
+// numbers are the same on all architectures).
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+
+namespace process {
+namespace uring {
+
+// Number of submission queue entries. Note that this does not limit
+// the number of polls in flight, only the number of polls that can
+// be queued during one iteration of the event loop before we have to
+// submit them early.
+constexpr unsigned ENTRIES = 4096;
+
+
+// The shared memory rings of an io_uring instance, see
+// `io_uring_setup(2)`. Only ever accessed from the event loop.
+struct Ring
+{
+  int fd;
+
+  // The mappings of the rings, which are the same mapping if the
+  // kernel supports `IORING_FEAT_SINGLE_MMAP`.
+  void* sqRing;
+  size_t sqRingSize;
+  void* cqRing;
+  size_t cqRingSize;
+  size_t sqesSize;
+
+  struct
+  {
+    unsigned* head;
+    unsigned* tail;
+    unsigned* mask;
+    unsigned* entries;
+    unsigned* array;
+    io_uring_sqe* sqes;
+  } sq;
+
+  struct
+  {
+    unsigned* head;
+    unsigned* tail;
+    unsigned* mask;
+    io_uring_cqe* cqes;
+  } cq;
+};
+
+
+// An in-flight poll, keyed by the ID used as its `user_data`. We
+// don't use the address of the poll as the `user_data` because a
+// discard could otherwise remove a different poll that happens to
+// have been allocated at the same address.
+struct Poll
+{
+  short events;
+  Promise<short> promise;
+};
+
+
+// The io_uring instance of an event loop, stored as the libev loop's
+// user data (see `ev_set_userdata`).
+struct Instance
+{
+  Ring* ring;
+
+  hashmap<uint64_t, Poll*> polls;
+
+  // IDs of polls start at 1 since 0 is used for the entries (e.g.,
+  // poll removals) whose completions we ignore.
+  uint64_t next = 1;
+
+  // Submits the queued entries before the event loop blocks.
+  ev_prepare prepare_watcher;
+
+  // Reaps completions, since the ring's file descriptor becomes
+  // readable whenever the completion queue is non-empty.
+  ev_io completion_watcher;
+};
+
+
+static Instance* instance(Loop* loop)
+{
+  return (Instance*) ev_userdata(loop->loop);
+}
+
+
+static Try<Ring*> setup()
+{
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  int fd = syscall(__NR_io_uring_setup, ENTRIES, &params);
+  if (fd < 0) {
+    return ErrnoError("Failed to set up io_uring");
+  }
+
+  // We rely on the kernel buffering completions rather than dropping
+  // them if the completion queue overflows since there is no limit on
+  // the number of polls in flight.
+  if ((params.features & IORING_FEAT_NODROP) == 0) {
+    ::close(fd);
+    return Error("io_uring does not support IORING_FEAT_NODROP");
+  }
+
+  size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  size_t cqSize =
+    params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+  if (single) {
+    sqSize = cqSize = std::max(sqSize, cqSize);
+  }
+
+  char* sq = (char*) mmap(
+      nullptr,
+      sqSize,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      IORING_OFF_SQ_RING);
+
+  if (sq == MAP_FAILED) {
+    ErrnoError error("Failed to map io_uring submission queue");
+    ::close(fd);
+    return error;
+  }
+
+  char* cq = sq;
+
+  if (!single) {
+    cq = (char*) mmap(
+        nullptr,
+        cqSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_CQ_RING);
+
+    if (cq == MAP_FAILED) {
+      ErrnoError error("Failed to map io_uring completion queue");
+      munmap(sq, sqSize);
+      ::close(fd);
+      return error;
+    }
+  }
+
+  const size_t sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+  void* sqes = mmap(
+      nullptr,
+      sqesSize,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      IORING_OFF_SQES);
+
+  if (sqes == MAP_FAILED) {
+    ErrnoError error("Failed to map io_uring submission queue entries");
+    if (!single) {
+      munmap(cq, cqSize);
+    }
+    munmap(sq, sqSize);
+    ::close(fd);
+    return error;
+  }
+
+  Ring* result = new Ring();
+  result->fd = fd;
+
+  result->sqRing = sq;
+  result->sqRingSize = sqSize;
+  result->cqRing = cq;
+  result->cqRingSize = cqSize;
+  result->sqesSize = sqesSize;
+
+  result->sq.head = (unsigned*) (sq + params.sq_off.head);
+  result->sq.tail = (unsigned*) (sq + params.sq_off.tail);
+  result->sq.mask = (unsigned*) (sq + params.sq_off.ring_mask);
+  result->sq.entries = (unsigned*) (sq + params.sq_off.ring_entries);
+  result->sq.array = (unsigned*) (sq + params.sq_off.array);
+  result->sq.sqes = (io_uring_sqe*) sqes;
+
+  result->cq.head = (unsigned*) (cq + params.cq_off.head);
+  result->cq.tail = (unsigned*) (cq + params.cq_off.tail);
+  result->cq.mask = (unsigned*) (cq + params.cq_off.ring_mask);
+  result->cq.cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+
+  return result;
+}
+
+
+// Returns the number of entries queued but not yet consumed by the
+// kernel.
+static unsigned pending(Ring* ring)
+{
+  return *ring->sq.tail - __atomic_load_n(ring->sq.head, __ATOMIC_ACQUIRE);
+}
+
+
+static void reap(Instance* instance);
+
+
+// Hands the queued entries to the kernel.
+static void submit(Instance* instance)
+{
+  Ring* ring = instance->ring;
+
+  while (pending(ring) > 0) {
+    int result = syscall(
+        __NR_io_uring_enter, ring->fd, pending(ring), 0, 0, nullptr, 0);
+
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      } else if (errno == EAGAIN || errno == EBUSY) {
+        // The kernel is short on resources or has completions that it
+        // couldn't post yet, in which case reaping them lets us make
+        // progress. We'll retry before the event loop blocks again.
+        reap(instance);
+        return;
+      }
+
+      LOG(FATAL) << "Failed to submit to io_uring: " << os::strerror(errno);
+    }
+  }
+}
+
+
+// Returns a zeroed submission queue entry, submitting the queued
+// entries first if the submission queue is full.
+static io_uring_sqe* acquire(Instance* instance)
+{
+  Ring* ring = instance->ring;
+
+  while (pending(ring) == *ring->sq.entries) {
+    submit(instance);
+  }
+
+  const unsigned tail = *ring->sq.tail;
+  const unsigned index = tail & *ring->sq.mask;
+
+  io_uring_sqe* sqe = &ring->sq.sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+
+  ring->sq.array[index] = index;
+
+  return sqe;
+}
+
+
+// Makes the entry returned by the last call to `acquire` visible to
+// the kernel; it gets submitted with the next batch.
+static void enqueue(Ring* ring)
+{
+  __atomic_store_n(ring->sq.tail, *ring->sq.tail + 1, __ATOMIC_RELEASE);
+}
+
+
+static void complete(Instance* instance, uint64_t id, int result)
+{
+  Option<Poll*> poll = instance->polls.get(id);
+  CHECK_SOME(poll);
+
+  instance->polls.erase(id);
+
+  if (result == -ECANCELED) {
+    poll.get()->promise.discard();
+  } else if (result < 0) {
+    poll.get()->promise.fail(os::strerror(-result));
+  } else {
+    // Like with libev, errors and hang ups are reported as the file
+    // descriptor being ready for the requested events so that the
+    // subsequent I/O operation surfaces them.
+    short events = 0;
+
+    if ((result & (POLLIN | POLLERR | POLLHUP)) != 0) {
+      events |= poll.get()->events & io::READ;
+    }
+
+    if ((result & (POLLOUT | POLLERR | POLLHUP)) != 0) {
+      events |= poll.get()->events & io::WRITE;
+    }
+
+    poll.get()->promise.set(events);
+  }
+
+  delete poll.get();
+}
+
+
+static void reap(Instance* instance)
+{
+  Ring* ring = instance->ring;
+
+  // Copy out the completions before handling them since satisfying a
+  // promise can run arbitrary callbacks which may queue new polls.
+  std::vector<io_uring_cqe> cqes;
+
+  unsigned head = *ring->cq.head;
+  const unsigned tail = __atomic_load_n(ring->cq.tail, __ATOMIC_ACQUIRE);
+
+  for (; head != tail; head++) {
+    cqes.push_back(ring->cq.cqes[head & *ring->cq.mask]);
+  }
+
+  __atomic_store_n(ring->cq.head, head, __ATOMIC_RELEASE);
+
+  foreach (const io_uring_cqe& cqe, cqes) {
+    if (cqe.user_data != 0) {
+      complete(instance, cqe.user_data, cqe.res);
+    }
+  }
+}
+
+
+static void prepared(struct ev_loop* loop, ev_prepare* watcher, int revents)
+{
+  submit((Instance*) watcher->data);
+}
+
+
+static void completed(struct ev_loop* loop, ev_io* watcher, int revents)
+{
+  reap((Instance*) watcher->data);
+}
+
+
+void initialize(Loop* loop)
+{
+  CHECK(instance(loop) == nullptr);
+
+  Try<Ring*> create = setup();
+  if (create.isError()) {
+    LOG(WARNING) << create.error() << ", falling back to libev for polling";
+    return;
+  }
+
+  Instance* instance = new Instance();
+  instance->ring = create.get();
+
+  ev_prepare_init(&instance->prepare_watcher, prepared);
+  instance->prepare_watcher.data = instance;
+  ev_prepare_start(loop->loop, &instance->prepare_watcher);
+
+  ev_io_init(
+      &instance->completion_watcher,
+      completed,
+      instance->ring->fd,
+      EV_READ);
+
+  instance->completion_watcher.data = instance;
+  ev_io_start(loop->loop, &instance->completion_watcher);
+
+  ev_set_userdata(loop->loop, instance);
+
+  VLOG(1) << "Using io_uring for polling";
+}
+
+
+void finalize(Loop* loop)
+{
+  Instance* instance = uring::instance(loop);
+
+  if (instance == nullptr) {
+    return;
+  }
+
+  ev_prepare_stop(loop->loop, &instance->prepare_watcher);
+  ev_io_stop(loop->loop, &instance->completion_watcher);
+
+  ev_set_userdata(loop->loop, nullptr);
+
+  // The polls still in flight get abandoned, since the event loop has
+  // been stopped we can't complete or discard them anymore.
+  foreachvalue (Poll* poll, instance->polls) {
+    delete poll;
+  }
+
+  Ring* ring = instance->ring;
+
+  munmap(ring->sq.sqes, ring->sqesSize);
+
+  if (ring->cqRing != ring->sqRing) {
+    munmap(ring->cqRing, ring->cqRingSize);
+  }
+
+  munmap(ring->sqRing, ring->sqRingSize);
+
+  ::close(ring->fd);
+
+  delete ring;
+  delete instance;
+}
+
+
+bool enabled(Loop* loop)
+{
+  return instance(loop) != nullptr;
+}
+
+
+namespace internal {
+
+// Removes the poll if it is still in flight, in which case the poll
+// completes with `ECANCELED` and its future gets discarded.
+static Future<Nothing> discard(Instance* instance, uint64_t id)
+{
+  if (instance->polls.contains(id)) {
+    io_uring_sqe* sqe = acquire(instance);
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = id;
+    sqe->user_data = 0;
+    enqueue(instance->ring);
+  }
+
+  return Nothing();
+}
+
+} // namespace internal {
+
+
+Future<short> poll(Loop* loop, int_fd fd, short events)
+{
+  CHECK(enabled(loop));
+  CHECK_EQ(_event_loop_, loop);
+
+  Instance* instance = uring::instance(loop);
+
+  const uint64_t id = instance->next++;
+
+  Poll* poll = new Poll();
+  poll->events = events;
+
+  Future<short> future = poll->promise.future();
+
+  instance->polls.put(id, poll);
+
+  short mask = 0;
+
+  if ((events & io::READ) != 0) {
+    mask |= POLLIN;
+  }
+
+  if ((events & io::WRITE) != 0) {
+    mask |= POLLOUT;
+  }
+
+  io_uring_sqe* sqe = acquire(instance);
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll_events = mask;
+  sqe->user_data = id;
+  enqueue(instance->ring);
+
+  // Make sure we stop polling if a discard occurs on our future. Note
+  // that it's possible the discard happens after the poll completed,
+  // in which case `internal::discard` won't find the poll.
+  future.onDiscard([loop, instance, id]() {
+    run_in_event_loop<Nothing>(
+        loop,
+        lambda::bind(&internal::discard, instance, id));
+  });
+
+  return future;
+}
+
+} // namespace uring {
+} // namespace process {
@@ -0,0 +1,55 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __IO_URING_HPP__
+#define __IO_URING_HPP__
+
+#include <process/future.hpp>
+
+#include <stout/os/int_fd.hpp>
+
+#include "libev.hpp"
+
+namespace process {
+namespace uring {
+
+// Sets up an io_uring instance and hooks it into the specified event
+// loop. Readiness polls (see `io::poll`) are then queued on the ring
+// and submitted to the kernel in one batch per loop iteration, rather
+// than costing an `epoll_ctl` per poll as with libev watchers.
+//
+// If the kernel doesn't support io_uring (or it is disabled, e.g., by
+// a seccomp profile) this logs a warning and `enabled` returns false,
+// in which case polling falls back to using libev watchers.
+void initialize(Loop* loop);
+
+
+// Unhooks the io_uring instance (if any) from the specified event
+// loop, which must no longer be running, and releases its ring.
+void finalize(Loop* loop);
+
+
+// Returns true if `initialize` successfully set up io_uring for the
+// specified event loop.
+bool enabled(Loop* loop);
+
+
+// Polls the file descriptor for the specified events (a combination
+// of `io::READ` and `io::WRITE`) using the io_uring instance of the
+// specified event loop. Must be called from within that event loop
+// and only if `enabled` returns true for it.
+Future<short> poll(Loop* loop, int_fd fd, short events);
+
+} // namespace uring {
+} // namespace process {
+
+#endif // __IO_URING_HPP__
@@ -14,58 +14,57 @@
 
 #include <mutex>
 #include <queue>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
 
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
 
 #include "event_loop.hpp"
+#ifdef ENABLE_IO_URING
+#include "io_uring.hpp"
+#endif // ENABLE_IO_URING
 #include "libev.hpp"
 
 namespace process {
 
-ev_async async_watcher;
-// We need an asynchronous watcher to receive the request to shutdown.
-ev_async shutdown_watcher;
-
 // Define the initial values for all of the declarations made in
 // libev.hpp (since these need to live in the static data space).
-struct ev_loop* loop = nullptr;
-
-std::queue<ev_io*>* watchers = new std::queue<ev_io*>();
-
-std::mutex* watchers_mutex = new std::mutex();
-
-std::queue<lambda::function<void()>>* functions =
-  new std::queue<lambda::function<void()>>();
+std::vector<Loop*>* loops = new std::vector<Loop*>();
 
-thread_local bool* _in_event_loop_ = nullptr;
+thread_local Loop* _event_loop_ = nullptr;
 
 
-void handle_async(struct ev_loop* loop, ev_async* _, int revents)
+void handle_async(struct ev_loop* loop, ev_async* watcher, int revents)
 {
+  Loop* _loop = (Loop*) watcher->data;
+
   std::queue<lambda::function<void()>> run_functions;
-  synchronized (watchers_mutex) {
+  synchronized (_loop->mutex) {
     // Start all the new I/O watchers.
-    while (!watchers->empty()) {
-      ev_io* watcher = watchers->front();
-      watchers->pop();
+    while (!_loop->watchers.empty()) {
+      ev_io* watcher = _loop->watchers.front();
+      _loop->watchers.pop();
       ev_io_start(loop, watcher);
     }
 
     // Swap the functions into a temporary queue so that we can invoke
     // them outside of the mutex.
-    std::swap(run_functions, *functions);
+    std::swap(run_functions, _loop->functions);
   }
 
   // Running the functions outside of the mutex reduces locking
   // contention as these are arbitrary functions that can take a long
   // time to execute. Doing this also avoids a deadlock scenario where
   // (A) mutexes are acquired before calling `run_in_event_loop`,
-  // followed by locking (B) `watchers_mutex`. If we executed the
+  // followed by locking (B) the loop's mutex. If we executed the
   // functions inside the mutex, then the locking order violation
-  // would be this function acquiring the (B) `watchers_mutex`
-  // followed by the arbitrary function acquiring the (A) mutexes.
+  // would be this function acquiring the (B) loop's mutex followed
+  // by the arbitrary function acquiring the (A) mutexes.
   while (!run_functions.empty()) {
     (run_functions.front())();
     run_functions.pop();
@@ -79,15 +78,38 @@ void handle_shutdown(struct ev_loop* loop, ev_async* _, int revents)
 }
 
 
-void EventLoop::initialize()
+void EventLoop::initialize(size_t threads, bool io_uring)
 {
-  loop = ev_default_loop(EVFLAG_AUTO);
+  CHECK(loops->empty());
+  CHECK_GT(threads, 0u);
+
+  for (size_t i = 0; i < threads; i++) {
+    Loop* loop = new Loop();
 
-  ev_async_init(&async_watcher, handle_async);
-  ev_async_init(&shutdown_watcher, handle_shutdown);
+    loop->loop = i == 0
+      ? ev_default_loop(EVFLAG_AUTO)
+      : ev_loop_new(EVFLAG_AUTO);
+
+    if (loop->loop == nullptr) {
+      LOG(FATAL) << "Failed to initialize event loop " << i;
+    }
 
-  ev_async_start(loop, &async_watcher);
-  ev_async_start(loop, &shutdown_watcher);
+    loop->async_watcher.data = loop;
+
+    ev_async_init(&loop->async_watcher, handle_async);
+    ev_async_init(&loop->shutdown_watcher, handle_shutdown);
+
+    ev_async_start(loop->loop, &loop->async_watcher);
+    ev_async_start(loop->loop, &loop->shutdown_watcher);
+
+#ifdef ENABLE_IO_URING
+    if (io_uring) {
+      uring::initialize(loop);
+    }
+#endif // ENABLE_IO_URING
+
+    loops->push_back(loop);
+  }
 }
 
 
@@ -124,7 +146,7 @@ Future<Nothing> delay(
   const double repeat = 0.0;
 
   ev_timer_init(timer, handle_delay, after, repeat);
-  ev_timer_start(loop, timer);
+  ev_timer_start(loops->front()->loop, timer);
 
   return Nothing();
 }
@@ -148,19 +170,62 @@ double EventLoop::time()
 }
 
 
+static void run(Loop* loop)
+{
+  _event_loop_ = loop;
+
+  ev_loop(loop->loop, 0);
+
+  _event_loop_ = nullptr;
+}
+
+
 void EventLoop::run()
 {
-  __in_event_loop__ = true;
+  // Run all but the first event loop in threads of their own.
+  std::vector<std::thread> threads;
+  threads.reserve(loops->size() - 1);
 
-  ev_loop(loop, 0);
+  for (size_t i = 1; i < loops->size(); i++) {
+    threads.emplace_back(&process::run, loops->at(i));
+  }
+
+  process::run(loops->front());
 
-  __in_event_loop__ = false;
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
 }
 
 
 void EventLoop::stop()
 {
-  ev_async_send(loop, &shutdown_watcher);
+  foreach (Loop* loop, *loops) {
+    ev_async_send(loop->loop, &loop->shutdown_watcher);
+  }
+}
+
+
+void EventLoop::finalize()
+{
+  foreach (Loop* loop, *loops) {
+#ifdef ENABLE_IO_URING
+    uring::finalize(loop);
+#endif // ENABLE_IO_URING
+
+    ev_async_stop(loop->loop, &loop->async_watcher);
+    ev_async_stop(loop->loop, &loop->shutdown_watcher);
+
+    // NOTE: The default loop is not destroyed, `ev_default_loop` returns
+    // it again when the event loop gets reinitialized.
+    if (loop != loops->front()) {
+      ev_loop_destroy(loop->loop);
+    }
+
+    delete loop;
+  }
+
+  loops->clear();
 }
 
 } // namespace process {
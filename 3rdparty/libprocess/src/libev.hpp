@@ -17,6 +17,7 @@
 
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include <process/future.hpp>
 #include <process/owned.hpp>
@@ -24,32 +25,59 @@
 #include <stout/lambda.hpp>
 #include <stout/synchronized.hpp>
 
+#include <stout/os/int_fd.hpp>
+
 namespace process {
 
-// Event loop.
-extern struct ev_loop* loop;
+// An event loop and the state necessary for interacting with it from
+// other threads. The first event loop also runs all timers (see
+// `EventLoop::delay`), while I/O on file descriptors is sharded across
+// all of the event loops (see `loop_for`), each of which is run by its
+// own thread.
+struct Loop
+{
+  struct ev_loop* loop;
+
+  // Asynchronous watcher for interrupting loop to specifically deal
+  // with IO watchers and functions (via run_in_event_loop).
+  ev_async async_watcher;
+
+  // We need an asynchronous watcher to receive the request to shutdown.
+  ev_async shutdown_watcher;
+
+  // Queue of I/O watchers to be asynchronously added to the event loop
+  // (protected by 'mutex' below).
+  // TODO(benh): Replace this queue with functions that we put in
+  // 'functions' below that perform the ev_io_start themselves.
+  std::queue<ev_io*> watchers;
+
+  // Queue of functions to be invoked asynchronously within the event
+  // loop (protected by 'mutex' below).
+  std::queue<lambda::function<void()>> functions;
+
+  std::mutex mutex;
+};
+
+
+// Event loops, the first of which is the default libev loop.
+extern std::vector<Loop*>* loops;
 
-// Asynchronous watcher for interrupting loop to specifically deal
-// with IO watchers and functions (via run_in_event_loop).
-extern ev_async async_watcher;
 
-// Queue of I/O watchers to be asynchronously added to the event loop
-// (protected by 'watchers' below).
-// TODO(benh): Replace this queue with functions that we put in
-// 'functions' below that perform the ev_io_start themselves.
-extern std::queue<ev_io*>* watchers;
-extern std::mutex* watchers_mutex;
+// Returns the event loop responsible for the I/O on the specified file
+// descriptor. Since all I/O on a file descriptor is done through the
+// same event loop, so is the decoding of the data read from a socket
+// and the completion of its sends.
+inline Loop* loop_for(int_fd fd)
+{
+  return loops->at(fd % loops->size());
+}
 
-// Queue of functions to be invoked asynchronously within the vent
-// loop (protected by 'watchers' above).
-extern std::queue<lambda::function<void()>>* functions;
 
-// Per thread bool pointer. We use a pointer to lazily construct the
-// actual bool.
-extern thread_local bool* _in_event_loop_;
+// Per thread pointer to the event loop being run by this thread, or
+// nullptr if this thread is not running an event loop.
+extern thread_local Loop* _event_loop_;
 
-#define __in_event_loop__ *(_in_event_loop_ == nullptr ?                \
-  _in_event_loop_ = new bool(false) : _in_event_loop_)
+#define __in_event_loop__ (_event_loop_ != nullptr)
 
 
 // Wrapper around function we want to run in the event loop.
@@ -67,12 +95,14 @@ void _run_in_event_loop(
 }
 
 
-// Helper for running a function in the event loop.
+// Helper for running a function in the specified event loop.
 template <typename T>
-Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
+Future<T> run_in_event_loop(
+    Loop* loop,
+    const lambda::function<Future<T>()>& f)
 {
   // If this is already the event loop then just run the function.
-  if (__in_event_loop__) {
+  if (_event_loop_ == loop) {
     return f();
   }
 
@@ -81,16 +111,24 @@ Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
   Future<T> future = promise->future();
 
   // Enqueue the function.
-  synchronized (watchers_mutex) {
-    functions->push(lambda::bind(&_run_in_event_loop<T>, f, promise));
+  synchronized (loop->mutex) {
+    loop->functions.push(lambda::bind(&_run_in_event_loop<T>, f, promise));
   }
 
   // Interrupt the loop.
-  ev_async_send(loop, &async_watcher);
+  ev_async_send(loop->loop, &loop->async_watcher);
 
   return future;
 }
 
+
+// Helper for running a function in the first event loop.
+template <typename T>
+Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
+{
+  return run_in_event_loop<T>(loops->front(), f);
+}
+
 } // namespace process {
 
 #endif // __LIBEV_HPP__
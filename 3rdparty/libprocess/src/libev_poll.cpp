@@ -19,6 +19,9 @@
 
 #include <stout/lambda.hpp>
 
+#ifdef ENABLE_IO_URING
+#include "io_uring.hpp"
+#endif // ENABLE_IO_URING
 #include "libev.hpp"
 
 namespace process {
@@ -90,14 +93,20 @@ namespace io {
 namespace internal {
 
 // Helper/continuation of 'poll' on future discard.
-void _poll(const std::shared_ptr<ev_async>& async)
+void _poll(Loop* loop, const std::shared_ptr<ev_async>& async)
 {
-  ev_async_send(loop, async.get());
+  ev_async_send(loop->loop, async.get());
 }
 
 
-Future<short> poll(int_fd fd, short events)
+Future<short> poll(Loop* loop, int_fd fd, short events)
 {
+#ifdef ENABLE_IO_URING
+  if (uring::enabled(loop)) {
+    return uring::poll(loop, fd, events);
+  }
+#endif // ENABLE_IO_URING
+
   Poll* poll = new Poll();
 
   // Have the watchers data point back to the struct.
@@ -109,7 +118,7 @@ Future<short> poll(int_fd fd, short events)
 
   // Initialize and start the async watcher.
   ev_async_init(poll->watcher.async.get(), discard_poll);
-  ev_async_start(loop, poll->watcher.async.get());
+  ev_async_start(loop->loop, poll->watcher.async.get());
 
   // Make sure we stop polling if a discard occurs on our future.
   // Note that it's possible that we'll invoke '_poll' when someone
@@ -117,11 +126,11 @@ Future<short> poll(int_fd fd, short events)
   // in this case while we will interrupt the event loop since the
   // async watcher has already been stopped we won't cause
   // 'discard_poll' to get invoked.
-  future.onDiscard(lambda::bind(&_poll, poll->watcher.async));
+  future.onDiscard(lambda::bind(&_poll, loop, poll->watcher.async));
 
   // Initialize and start the I/O watcher.
   ev_io_init(poll->watcher.io.get(), polled, fd, events);
-  ev_io_start(loop, poll->watcher.io.get());
+  ev_io_start(loop->loop, poll->watcher.io.get());
 
   return future;
 }
@@ -135,7 +144,11 @@ Future<short> poll(int_fd fd, short events)
 
   // TODO(benh): Check if the file descriptor is non-blocking?
 
-  return run_in_event_loop<short>(lambda::bind(&internal::poll, fd, events));
+  Loop* loop = loop_for(fd);
+
+  return run_in_event_loop<short>(
+      loop,
+      lambda::bind(&internal::poll, loop, fd, events));
 }
 
 } // namespace io {
@@ -121,6 +121,13 @@ void EventLoop::stop()
 }
 
 
+void EventLoop::finalize()
+{
+  // The event base is only initialized once (see `initialize`) and
+  // reused after reinitialization, so there is nothing to release.
+}
+
+
 namespace internal {
 
 struct Delay
@@ -177,7 +184,7 @@ double EventLoop::time()
 }
 
 
-void EventLoop::initialize()
+void EventLoop::initialize(size_t threads, bool io_uring)
 {
   static Once* initialized = new Once();
 
@@ -185,6 +192,13 @@ void EventLoop::initialize()
     return;
   }
 
+  // NOTE: Unlike libev, the I/O is not sharded across multiple event
+  // bases, all of it is done on the single event base.
+  if (threads > 1) {
+    LOG(WARNING) << "Ignoring request for " << threads << " I/O threads,"
+                 << " libevent currently only supports a single event loop";
+  }
+
   // We need to initialize Libevent differently depending on the
   // operating system threading support.
 #if defined(EVTHREAD_USE_PTHREADS_IMPLEMENTED)
@@ -14,14 +14,23 @@
 #ifdef __WINDOWS__
 #include <stout/windows.hpp>
 #else
+#include <limits.h>
+
 #include <netinet/tcp.h>
+
+#include <sys/uio.h>
 #endif // __WINDOWS__
 
+#include <algorithm>
+#include <vector>
+
 #include <process/io.hpp>
 #include <process/loop.hpp>
 #include <process/network.hpp>
 #include <process/socket.hpp>
 
+#include <stout/foreach.hpp>
+
 #include <stout/os/sendfile.hpp>
 #include <stout/os/strerror.hpp>
 #include <stout/os.hpp>
@@ -226,6 +235,71 @@ Future<size_t> PollSocketImpl::send(const char* data, size_t size)
 }
 
 
+#ifndef __WINDOWS__
+Future<size_t> PollSocketImpl::send(const std::vector<Buffer>& buffers)
+{
+  // Build the `iovec` array once up front, skipping empty buffers and
+  // capping the count at `IOV_MAX`; any remainder is picked up by the
+  // caller on the next send since partial sends are allowed.
+  std::vector<struct iovec> iov;
+  iov.reserve(std::min<size_t>(buffers.size(), IOV_MAX));
+
+  foreach (const Buffer& buffer, buffers) {
+    if (iov.size() == IOV_MAX) {
+      break;
+    } else if (buffer.size > 0) {
+      iov.push_back({const_cast<char*>(buffer.data), buffer.size});
+    }
+  }
+
+  CHECK(!iov.empty());
+
+  // Need to hold a copy of `this` so that the underlying socket
+  // doesn't end up getting reused before we return.
+  auto self = shared(this);
+
+  return loop(
+      None(),
+      [self, iov]() -> Future<Option<size_t>> {
+        struct msghdr message = {};
+        message.msg_iov = const_cast<struct iovec*>(iov.data());
+        message.msg_iovlen = iov.size();
+
+        while (true) {
+          ssize_t length = ::sendmsg(self->get(), &message, MSG_NOSIGNAL);
+
+          if (length < 0) {
+            int error = errno;
+
+            if (net::is_restartable_error(error)) {
+              // Interrupted, try again now.
+              continue;
+            } else if (!net::is_retryable_error(error)) {
+              VLOG(1) << "Socket error while sending: " << os::strerror(error);
+              return Failure(os::strerror(error));
+            }
+
+            return None();
+          }
+
+          return length;
+        }
+      },
+      [self](const Option<size_t>& length) -> Future<ControlFlow<size_t>> {
+        // Retry after we've polled if we don't yet have a result.
+        if (length.isNone()) {
+          return io::poll(self->get(), io::WRITE)
+            .then([](short event) -> ControlFlow<size_t> {
+              CHECK_EQ(io::WRITE, event);
+              return Continue();
+            });
+        }
+        return Break(length.get());
+      });
+}
+#endif // __WINDOWS__
+
+
 Future<size_t> PollSocketImpl::sendfile(int_fd fd, off_t offset, size_t size)
 {
   CHECK(size > 0); // TODO(benh): Just return 0 if `size` is 0?
@@ -36,6 +36,9 @@ public:
   virtual Future<size_t> recv(char* data, size_t size);
   virtual Future<size_t> send(const char* data, size_t size);
   virtual Future<size_t> sendfile(int_fd fd, off_t offset, size_t size);
+#ifndef __WINDOWS__
+  virtual Future<size_t> send(const std::vector<Buffer>& buffers);
+#endif // __WINDOWS__
   virtual Kind kind() const { return SocketImpl::Kind::POLL; }
 };
 
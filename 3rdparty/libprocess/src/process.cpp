@@ -111,6 +111,7 @@
 #include "authenticator_manager.hpp"
 #include "config.hpp"
 #include "decoder.hpp"
+#include "dedicated_worker.hpp"
 #include "encoder.hpp"
 #include "event_loop.hpp"
 #include "event_queue.hpp"
@@ -247,6 +248,93 @@ struct Flags : public virtual flags::FlagsBase
         "libprocess is listening may not match the address from\n"
         "which libprocess connects to other actors.\n",
         false);
+
+    add(&Flags::dedicated_workers,
+        "dedicated_workers",
+        "Comma-separated list of processes that each get their own\n"
+        "dedicated worker thread rather than sharing the generic worker\n"
+        "threads, e.g., 'master,hierarchical-allocator,registrar'.\n"
+        "A process matches an entry if its ID is equal to the entry or\n"
+        "is the entry followed by a generated suffix, e.g., 'registrar(1)'.\n"
+        "All processes matching the same entry share its thread. An entry\n"
+        "may be followed by ':<cpu>' to also pin the thread to that CPU\n"
+        "(only supported on Linux), e.g., 'master:2'.",
+        [](const Option<string>& value) -> Option<Error> {
+          if (value.isSome()) {
+            Try<vector<DedicatedWorker>> workers =
+              DedicatedWorker::parse(value.get());
+
+            if (workers.isError()) {
+              return Error(
+                  "LIBPROCESS_DEDICATED_WORKERS=" + value.get() +
+                  " is invalid: " + workers.error());
+            }
+          }
+
+          return None();
+        });
+
+    add(&Flags::event_batch_size,
+        "event_batch_size",
+        "The maximum number of events a worker thread moves out of a\n"
+        "process' event queue at once (i.e., per lock acquisition or\n"
+        "bulk dequeue) while running that process.",
+        32,
+        [](const size_t& value) -> Option<Error> {
+          if (value == 0) {
+            return Error("LIBPROCESS_EVENT_BATCH_SIZE must be positive");
+          }
+
+          return None();
+        });
+
+    add(&Flags::max_events_per_resume,
+        "max_events_per_resume",
+        "If set, the maximum number of events a worker thread serves for\n"
+        "a process before putting the process back on the run queue so\n"
+        "that other runnable processes get a chance to run. If not set a\n"
+        "worker thread serves a process until its event queue is empty.",
+        [](const Option<size_t>& value) -> Option<Error> {
+          if (value.isSome() && value.get() == 0) {
+            return Error("LIBPROCESS_MAX_EVENTS_PER_RESUME must be positive");
+          }
+
+          return None();
+        });
+
+    add(&Flags::binary_framing,
+        "binary_framing",
+        "If set, messages to other libprocess instances that have\n"
+        "advertised support for it are sent using a length-prefixed binary\n"
+        "framing rather than as HTTP requests, which saves generating and\n"
+        "parsing the HTTP headers. Existing connections switch to the\n"
+        "framing as soon as the peer advertises it. Receiving binary frames\n"
+        "is always supported.",
+        false);
+
+    add(&Flags::num_io_threads,
+        "num_io_threads",
+        "The number of threads that perform socket I/O. Connections are\n"
+        "sharded across these threads (by file descriptor), each of which\n"
+        "runs its own event loop and also decodes the incoming messages\n"
+        "and completes the sends of its connections. Only supported with\n"
+        "libev, libevent always uses a single thread.",
+        1,
+        [](const size_t& value) -> Option<Error> {
+          if (value == 0) {
+            return Error("LIBPROCESS_NUM_IO_THREADS must be positive");
+          }
+
+          return None();
+        });
+
+    add(&Flags::enable_io_uring,
+        "enable_io_uring",
+        "If set, the event loops poll using io_uring (if supported by the\n"
+        "kernel) rather than libev watchers. Reads and writes still go\n"
+        "through system calls, only readiness polling uses the ring.\n"
+        "Only has an effect if libprocess was built with io_uring support.",
+        false);
   }
 
   Option<net::IP> ip;
@@ -255,6 +343,12 @@ struct Flags : public virtual flags::FlagsBase
   Option<int> port;
   Option<int> advertise_port;
   bool require_peer_address_ip_match;
+  Option<string> dedicated_workers;
+  size_t event_batch_size;
+  Option<size_t> max_events_per_resume;
+  bool binary_framing;
+  size_t num_io_threads;
+  bool enable_io_uring;
 };
 
 } // namespace internal {
@@ -354,9 +448,13 @@ public:
 
   ProcessReference use(const UPID& pid);
 
+  // Handles a request decoded from the socket. Requests for
+  // libprocess messages are handed back to `pool` once the message
+  // has been delivered.
   void handle(
       const Socket& socket,
-      Request* request);
+      Request* request,
+      const std::shared_ptr<RequestPool>& pool);
 
   bool deliver(
       ProcessBase* receiver,
@@ -408,8 +506,8 @@ public:
 
   long workers() const
   {
-    // Less 1 for event loop thread.
-    return static_cast<long>(threads.size() - 1);
+    // Less 1 for event loop thread and the dedicated worker threads.
+    return static_cast<long>(threads.size() - 1 - dedicated.size());
   }
 
 private:
@@ -426,6 +524,16 @@ private:
   // implementation.
   RunQueue runq;
 
+  // Processes that get their own worker thread, see the
+  // `--dedicated_workers` flag. Set in `init_threads` and never
+  // changed afterwards.
+  vector<internal::DedicatedWorker> dedicated;
+
+  // See the `--event_batch_size` and `--max_events_per_resume`
+  // flags. Set in `init_threads` and never changed afterwards.
+  size_t event_batch_size = 1;
+  Option<size_t> max_events_per_resume;
+
   // Number of running processes, to support Clock::settle operation.
   std::atomic_long running;
 
@@ -779,6 +887,75 @@ static Future<MessageEvent*> parse(const Request& request)
 
 namespace internal {
 
+void decode_frames(
+    const Future<size_t>& length,
+    char* data,
+    size_t size,
+    Socket socket,
+    FrameDecoder* decoder)
+{
+  if (length.isDiscarded() || length.isFailed()) {
+    if (length.isFailed()) {
+      VLOG(1) << "Decode failure: " << length.failure();
+    }
+
+    socket_manager->close(socket);
+    delete[] data;
+    delete decoder;
+    return;
+  }
+
+  if (length.get() == 0) {
+    socket_manager->close(socket);
+    delete[] data;
+    delete decoder;
+    return;
+  }
+
+  // Decode as many complete frames from the data as possible.
+  const deque<Message*> messages = decoder->decode(data, length.get());
+
+  if (!messages.empty()) {
+    // Verify that the UPID each peer is claiming is on the same IP
+    // address the peer is sending from, see `ProcessManager::handle`.
+    Option<net::IP> ip = None();
+
+    if (libprocess_flags->require_peer_address_ip_match) {
+      Try<Address> address = socket.peer();
+
+      if (address.isSome()) {
+        ip = address->ip;
+      }
+    }
+
+    foreach (Message* message, messages) {
+      if (libprocess_flags->require_peer_address_ip_match &&
+          (ip.isNone() || message->from.address.ip != ip.get())) {
+        VLOG(1) << "Dropping message '" << message->name << "' from "
+                << message->from << ": UPID IP address validation failed";
+      } else {
+        const UPID to = message->to;
+        process_manager->deliver(to, new MessageEvent(std::move(*message)));
+      }
+
+      delete message;
+    }
+  }
+
+  if (decoder->failed()) {
+    VLOG(1) << "Decoder error while receiving frames";
+    socket_manager->close(socket);
+    delete[] data;
+    delete decoder;
+    return;
+  }
+
+  socket.recv(data, size)
+    .onAny(lambda::bind(
+        &decode_frames, lambda::_1, data, size, socket, decoder));
+}
+
+
 void decode_recv(
     const Future<size_t>& length,
     char* data,
@@ -804,6 +981,18 @@ void decode_recv(
     return;
   }
 
+  // The decoder gets created once the first data on the connection
+  // has been received, since that tells us whether the peer is
+  // sending binary frames (see `FrameEncoder`) or HTTP requests.
+  if (decoder == nullptr) {
+    if (data[0] == FRAME_MARKER) {
+      decode_frames(length, data, size, socket, new FrameDecoder(__address__));
+      return;
+    }
+
+    decoder = new StreamingRequestDecoder();
+  }
+
   // Decode as much of the data as possible into HTTP requests.
   const deque<Request*> requests = decoder->decode(data, length.get());
 
@@ -830,10 +1019,27 @@ void decode_recv(
 
     foreach (Request* request, requests) {
       request->client = address.get();
-      process_manager->handle(socket, request);
+      process_manager->handle(socket, request, decoder->requestPool());
     }
   }
 
+  // A peer switches a connection to binary frames once it learns
+  // that we can decode them, see `SocketManager::framing`.
+  if (decoder->framed().isSome()) {
+    const size_t offset = decoder->framed().get();
+    delete decoder;
+
+    memmove(data, data + offset, length.get() - offset);
+
+    decode_frames(
+        length.get() - offset,
+        data,
+        size,
+        socket,
+        new FrameDecoder(__address__));
+    return;
+  }
+
   socket.recv(data, size)
     .onAny(lambda::bind(&decode_recv, lambda::_1, data, size, socket, decoder));
 }
@@ -901,7 +1107,9 @@ void on_accept(const Future<Socket>& socket)
     const size_t size = 80 * 1024;
     char* data = new char[size];
 
-    StreamingRequestDecoder* decoder = new StreamingRequestDecoder();
+    // The decoder is created by `decode_recv` after looking at the
+    // first data received on the connection.
+    StreamingRequestDecoder* decoder = nullptr;
 
     socket.get().recv(data, size)
       .onAny(lambda::bind(
@@ -1051,12 +1259,29 @@ bool initialize(
   }
 #endif
 
+  // Fetch and parse the libprocess environment variables.
+  //
+  // NOTE: this must be done before setting up the processing threads
+  // as they depend on `--dedicated_workers`.
+  Try<flags::Warnings> load = libprocess_flags->load("LIBPROCESS_");
+
+  if (load.isError()) {
+    EXIT(EXIT_FAILURE) << libprocess_flags->usage(load.error());
+  }
+
+  // Log any flag warnings.
+  foreach (const flags::Warning& warning, load->warnings) {
+    LOG(WARNING) << warning.message;
+  }
+
   // Create a new ProcessManager and SocketManager.
   process_manager = new ProcessManager(delegate);
   socket_manager = new SocketManager();
 
   // Initialize the event loop.
-  EventLoop::initialize();
+  EventLoop::initialize(
+      libprocess_flags->num_io_threads,
+      libprocess_flags->enable_io_uring);
 
   // Setup processing threads.
   long num_worker_threads = process_manager->init_threads();
@@ -1066,18 +1291,6 @@ bool initialize(
   // Fill in the local IP and port for inter-libprocess communication.
   __address__ = inet4::Address::ANY_ANY();
 
-  // Fetch and parse the libprocess environment variables.
-  Try<flags::Warnings> load = libprocess_flags->load("LIBPROCESS_");
-
-  if (load.isError()) {
-    EXIT(EXIT_FAILURE) << libprocess_flags->usage(load.error());
-  }
-
-  // Log any flag warnings.
-  foreach (const flags::Warning& warning, load->warnings) {
-    LOG(WARNING) << warning.message;
-  }
-
   uint16_t port = 0;
 
   if (libprocess_flags->port.isSome()) {
@@ -1308,6 +1521,10 @@ void finalize(bool finalize_wsa)
   delete process_manager;
   process_manager = nullptr;
 
+  // The event loop was stopped by the `ProcessManager` and there are no
+  // more sockets, so the event loop can be released as well.
+  EventLoop::finalize();
+
   // Clear the public address of the server socket.
   // NOTE: This variable is necessary for process communication, so it
   // cannot be cleared until after the `ProcessManager` is deleted.
@@ -1597,6 +1814,11 @@ void SocketManager::link(
 
         persists.emplace(to.address, s);
 
+        if (libprocess_flags->binary_framing &&
+            framers.contains(to.address)) {
+          framed.insert(s);
+        }
+
         // Initialize 'outgoing' to prevent a race with
         // SocketManager::send() while the socket is not yet connected.
         // Initializing the 'outgoing' queue prevents
@@ -1759,6 +1981,19 @@ void send(Encoder* encoder, Socket socket)
             size));
       break;
     }
+    case Encoder::IOVEC: {
+      size_t size;
+      const vector<IOVecEncoder::Buffer> buffers =
+        static_cast<IOVecEncoder*>(encoder)->next(&size);
+      socket.send(buffers)
+        .onAny(lambda::bind(
+            &internal::_send,
+            lambda::_1,
+            socket,
+            encoder,
+            size));
+      break;
+    }
     case Encoder::FILE: {
       off_t offset;
       size_t size;
@@ -1924,7 +2159,7 @@ void SocketManager::send_connect(
     return;
   }
 
-  Encoder* encoder = new MessageEncoder(message);
+  Encoder* encoder = encode(socket, std::move(message));
 
   // Receive and ignore data from this socket. Note that we don't
   // expect to receive anything other than HTTP '202 Accepted'
@@ -1967,7 +2202,7 @@ void SocketManager::send(Message&& message, const SocketImpl::Kind& kind)
       }
 
       if (outgoing.count(socket.get()) > 0) {
-        outgoing[socket.get()].push(new MessageEncoder(message));
+        outgoing[socket.get()].push(encode(socket.get(), std::move(message)));
         return;
       } else {
         // Initialize the outgoing queue.
@@ -1996,6 +2231,10 @@ void SocketManager::send(Message&& message, const SocketImpl::Kind& kind)
       addresses.emplace(s, address);
       temps.emplace(address, s);
 
+      if (libprocess_flags->binary_framing && framers.contains(address)) {
+        framed.insert(s);
+      }
+
       dispose.insert(s);
 
       // Initialize the outgoing queue.
@@ -2017,7 +2256,44 @@ void SocketManager::send(Message&& message, const SocketImpl::Kind& kind)
   } else {
     // If we're not connecting and we haven't added the encoder to
     // the 'outgoing' queue then schedule it to be sent.
-    internal::send(new MessageEncoder(message), socket.get());
+    internal::send(encode(socket.get(), std::move(message)), socket.get());
+  }
+}
+
+
+Encoder* SocketManager::encode(int_fd s, Message&& message)
+{
+  synchronized (mutex) {
+    if (framed.count(s) > 0) {
+      return new FrameEncoder(std::move(message));
+    }
+  }
+
+  return new MessageEncoder(std::move(message));
+}
+
+
+void SocketManager::framing(const Address& address)
+{
+  synchronized (mutex) {
+    if (framers.contains(address)) {
+      return;
+    }
+
+    framers.insert(address);
+
+    // Links are usually created before the peer has sent us anything,
+    // so switch the existing connections to the peer to frames too.
+    // Messages that were already encoded stay ahead of the frames and
+    // the peer switches decoders after the last of them (see
+    // `StreamingRequestDecoder::framed`).
+    if (persists.count(address) > 0) {
+      framed.insert(persists.at(address));
+    }
+
+    if (temps.count(address) > 0) {
+      framed.insert(temps.at(address));
+    }
   }
 }
 
@@ -2145,6 +2421,11 @@ void SocketManager::close(int_fd s)
           temps.erase(address.get());
         }
 
+        // The peer might have been restarted as a libprocess instance
+        // which can't decode frames, it has to advertise framing again
+        // before the next connection to it sends frames.
+        framers.erase(address.get());
+
         addresses.erase(s);
       }
 
@@ -2155,6 +2436,7 @@ void SocketManager::close(int_fd s)
       }
 
       dispose.erase(s);
+      framed.erase(s);
       auto iterator = sockets.find(s);
 
       // We need to stop any 'ignore_data' receivers as they may have
@@ -2227,6 +2509,10 @@ void SocketManager::exited(const Address& address)
   // ourselves that the accesses to each Process object will always be
   // valid.
   synchronized (mutex) {
+    // The peer might come back as a libprocess instance which can't
+    // decode frames, it has to advertise framing again.
+    framers.erase(address);
+
     if (!links.remotes.contains(address)) {
       return; // No linkees for this socket address!
     }
@@ -2359,6 +2645,12 @@ void SocketManager::swap_implementing_socket(
       // No need to erase as we're changing the value, not the key.
     }
 
+    // Keep the framing of the encoders queued against this link.
+    if (framed.count(from_fd) > 0) {
+      framed.insert(to_fd);
+      framed.erase(from_fd);
+    }
+
     // Move any encoders queued against this link to the new socket.
     outgoing[to_fd] = std::move(outgoing[from_fd]);
     outgoing.erase(from_fd);
@@ -2474,13 +2766,29 @@ long ProcessManager::init_threads()
                        << runq.capacity() << " at this time";
   }
 
-  threads.reserve(num_worker_threads + 1);
+  if (libprocess_flags->dedicated_workers.isSome()) {
+    // NOTE: the flag has already been validated when it was loaded.
+    Try<vector<internal::DedicatedWorker>> parse =
+      internal::DedicatedWorker::parse(
+          libprocess_flags->dedicated_workers.get());
+
+    CHECK_SOME(parse);
+    dedicated = parse.get();
+  }
+
+  event_batch_size = libprocess_flags->event_batch_size;
+  max_events_per_resume = libprocess_flags->max_events_per_resume;
+
+  runq.initialize(num_worker_threads, dedicated.size());
+
+  threads.reserve(num_worker_threads + dedicated.size() + 1);
 
   // Create processing threads.
   for (long i = 0; i < num_worker_threads; i++) {
     // Retain the thread handles so that we can join when shutting down.
     threads.emplace_back(new std::thread(
-        [this]() {
+        [this, i]() {
+          runq.bind(i);
           running.fetch_add(1);
           do {
             ProcessBase* process = dequeue();
@@ -2501,7 +2809,59 @@ long ProcessManager::init_threads()
         }));
   }
 
-  // Create a thread for the event loop.
+  // Create dedicated processing threads. These run the same loop as
+  // the processing threads above but only ever dequeue the processes
+  // pinned to them (see `ProcessManager::spawn`).
+  for (size_t i = 0; i < dedicated.size(); i++) {
+    threads.emplace_back(new std::thread(
+        [this, i]() {
+          runq.dedicate(i);
+          running.fetch_add(1);
+          do {
+            ProcessBase* process = dequeue();
+            if (process == nullptr) {
+              if (joining_threads.load()) {
+                break;
+              }
+            } else {
+              resume(process);
+            }
+          } while (true);
+          running.fetch_sub(1);
+
+          delete _executor_;
+          _executor_ = nullptr;
+        }));
+
+    if (dedicated[i].cpu.isSome()) {
+#ifdef __linux__
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(dedicated[i].cpu.get(), &cpus);
+
+      int result = pthread_setaffinity_np(
+          threads.back()->native_handle(), sizeof(cpus), &cpus);
+
+      if (result != 0) {
+        LOG(WARNING) << "Failed to pin dedicated worker thread for '"
+                     << dedicated[i].id << "' to CPU "
+                     << dedicated[i].cpu.get() << ": "
+                     << os::strerror(result);
+      }
+#else
+      LOG(WARNING) << "Ignoring CPU " << dedicated[i].cpu.get()
+                   << " for dedicated worker thread for '"
+                   << dedicated[i].id << "' as pinning threads to CPUs"
+                   << " is only supported on Linux";
+#endif // __linux__
+    }
+
+    VLOG(1) << "Created dedicated worker thread for '"
+            << dedicated[i].id << "'";
+  }
+
+  // Create a thread for the event loop (which in turn runs any
+  // additional event loops for I/O in threads of its own).
   threads.emplace_back(new std::thread(&EventLoop::run));
 
   return num_worker_threads;
@@ -2531,7 +2891,8 @@ ProcessReference ProcessManager::use(const UPID& pid)
 
 void ProcessManager::handle(
     const Socket& socket,
-    Request* request)
+    Request* request,
+    const std::shared_ptr<RequestPool>& pool)
 {
   CHECK(request != nullptr);
 
@@ -2564,7 +2925,7 @@ void ProcessManager::handle(
     // from `SocketManager::finalize()` due to it closing all active sockets
     // during libprocess finalization.
     parse(*request)
-      .onAny([socket, request](const Future<MessageEvent*>& future) {
+      .onAny([socket, request, pool](const Future<MessageEvent*>& future) {
         // Get the HttpProxy pid for this socket.
         PID<HttpProxy> proxy = socket_manager->proxy(socket);
 
@@ -2577,7 +2938,7 @@ void ProcessManager::handle(
           VLOG(1) << "Returning '" << response.status << "' for '"
                   << request->url.path << "': " << response.body;
 
-          delete request;
+          pool->release(request);
           return;
         }
 
@@ -2606,12 +2967,20 @@ void ProcessManager::handle(
                     << " for '" << request->url.path << "'"
                     << ": " << response.body;
 
-            delete request;
+            pool->release(request);
             delete event;
             return;
           }
         }
 
+        // Remember whether the sender can decode binary frames so
+        // that new connections to it can use them.
+        if (libprocess_flags->binary_framing &&
+            request->headers.contains("Libprocess-Framing") &&
+            request->headers.at("Libprocess-Framing") == "binary") {
+          socket_manager->framing(event->message.from.address);
+        }
+
         // TODO(benh): Use the sender PID when delivering in order to
         // capture happens-before timing relationships for testing.
         bool accepted = process_manager->deliver(event->message.to, event);
@@ -2629,7 +2998,7 @@ void ProcessManager::handle(
           dispatch(proxy, &HttpProxy::enqueue, NotFound(), *request);
         }
 
-        delete request;
+        pool->release(request);
         return;
       });
 
@@ -2834,6 +3203,17 @@ UPID ProcessManager::spawn(ProcessBase* process, bool manage)
     process->manage = true;
   }
 
+  // Pin the process to a dedicated worker thread if configured.
+  for (size_t i = 0; i < dedicated.size(); i++) {
+    if (dedicated[i].matches(process->pid.id)) {
+      VLOG(2) << "Pinning " << process->pid << " to the dedicated worker"
+              << " thread for '" << dedicated[i].id << "'";
+
+      process->dedicated = i;
+      break;
+    }
+  }
+
   // We save the PID before enqueueing the process to avoid the race
   // condition that occurs when a user has a very short process and
   // the process gets run and cleaned up before we return from enqueue
@@ -2858,6 +3238,10 @@ void ProcessManager::resume(ProcessBase* process)
   bool manage = process->manage;
   bool terminate = false;
   bool blocked = false;
+  bool yielded = false;
+
+  // Number of events served, see `--max_events_per_resume`.
+  size_t served = 0;
 
   ProcessBase::State state = process->state.load();
 
@@ -2891,11 +3275,24 @@ void ProcessManager::resume(ProcessBase* process)
   while (!terminate && !blocked) {
     Event* event = nullptr;
 
+    // Give other processes a chance to run if we've served this
+    // process for long enough. The process is still READY, so rather
+    // than blocking we put it back on the run queue below.
+    if (max_events_per_resume.isSome() &&
+        served >= max_events_per_resume.get()) {
+      yielded = true;
+      break;
+    }
+
     // NOTE: the event queue requires only a _single_ consumer at a
     // time ... this is where we act as that single consumer (and down
     // in `ProcessManager::cleanup` which we call from here).
+    //
+    // We drain up to `event_batch_size` events at a time from the
+    // event queue so that we don't need to synchronize with the
+    // producers for every single event.
 
-    if (!process->events->consumer.empty()) {
+    if (!process->events->consumer.empty(event_batch_size)) {
       event = process->events->consumer.dequeue();
     } else {
       // We now transition the process to BLOCKED. It's possible that
@@ -2990,6 +3387,8 @@ void ProcessManager::resume(ProcessBase* process)
       }
 
       delete event;
+
+      served++;
     }
   }
 
@@ -3008,6 +3407,13 @@ void ProcessManager::resume(ProcessBase* process)
   if (terminate && manage) {
     delete process;
   }
+
+  // Put a process that yielded back on the run queue, this must be
+  // done last as another worker thread may resume (and even delete)
+  // the process as soon as it has been enqueued.
+  if (yielded) {
+    enqueue(process);
+  }
 }
 
 
@@ -3159,6 +3565,13 @@ bool ProcessManager::wait(const UPID& pid)
     switch (process->state.load()) {
       case ProcessBase::State::BOTTOM:
       case ProcessBase::State::READY:
+        // A process pinned to a dedicated worker thread must only
+        // ever run on that thread so we can't donate to it.
+        if (process->dedicated.isSome()) {
+          process = nullptr;
+          break;
+        }
+
         // Assume that we'll be able to successfully extract the
         // process from the run queue and optimistically increment
         // `running` so that `Clock::settle` properly waits. In the
@@ -3266,20 +3679,19 @@ void ProcessManager::enqueue(ProcessBase* process)
     return;
   }
 
-  // TODO(benh): Check and see if this process has its own thread. If
-  // it does, push it on that threads runq, and wake up that thread if
-  // it's not running. Otherwise, check and see which thread this
-  // process was last running on, and put it on that threads runq.
+  // NOTE: unless the process is pinned to a dedicated worker thread
+  // the run queue puts the process on the local queue of the current
+  // worker thread (if any) so that it's likely to get resumed on this
+  // thread (see run_queue.hpp).
 
-  runq.enqueue(process);
+  runq.enqueue(process, process->dedicated);
 }
 
 
 ProcessBase* ProcessManager::dequeue()
 {
-  // TODO(benh): Remove a process from this thread's runq. If there
-  // are no processes to run, and this is not a dedicated thread, then
-  // steal one from another threads runq.
+  // NOTE: the run queue first looks at this thread's local queue and
+  // then steals from the other worker threads (see run_queue.hpp).
 
   running.fetch_sub(1);
 
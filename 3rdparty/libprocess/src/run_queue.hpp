@@ -25,8 +25,10 @@
 //      enables an optimized semaphore implementation (see semaphore.hpp
 //      for more details).
 //
-// By default we use the `LockingRunQueue` and
-// `DecomissionableKernelSemaphore`.
+// By default we use a locking `LocalRunQueue` and the
+// `DecomissionableKernelSemaphore`. Either way the run queue is made
+// up of one local queue per worker thread (see `RunQueue` below), the
+// configuration only affects how each local queue is implemented.
 //
 // We choose to make these _compile-time_ decisions rather than
 // _runtime_ decisions because we wanted the run queue implementation
@@ -37,24 +39,41 @@
 #endif // LOCK_FREE_RUN_QUEUE
 
 #include <algorithm>
-#include <list>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <process/process.hpp>
 
+#include <stout/check.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
 #include <stout/synchronized.hpp>
 
 #include "semaphore.hpp"
 
 namespace process {
 
+// Per-thread index of the local queue owned by the current worker
+// thread, or -1 if the current thread is not a worker thread (e.g.,
+// the event loop thread or a thread not controlled by libprocess).
+thread_local long __worker__ = -1;
+
+// Per-thread index of the dedicated local queue owned by the current
+// dedicated worker thread, or -1 if the current thread is not a
+// dedicated worker thread.
+thread_local long __dedicated__ = -1;
+
 #ifndef LOCK_FREE_RUN_QUEUE
-class RunQueue
+class LocalRunQueue
 {
 public:
   bool extract(ProcessBase* process)
   {
     synchronized (mutex) {
-      std::list<ProcessBase*>::iterator it = std::find(
+      std::deque<ProcessBase*>::iterator it = std::find(
           processes.begin(),
           processes.end(),
           process);
@@ -68,21 +87,13 @@ public:
     return false;
   }
 
-  void wait()
-  {
-    semaphore.wait();
-  }
-
   void enqueue(ProcessBase* process)
   {
     synchronized (mutex) {
       processes.push_back(process);
     }
-    epoch.fetch_add(1);
-    semaphore.signal();
   }
 
-  // Precondition: `wait` must get called before `dequeue`!
   ProcessBase* dequeue()
   {
     synchronized (mutex) {
@@ -105,51 +116,160 @@ public:
     }
   }
 
-  void decomission()
+private:
+  std::deque<ProcessBase*> processes;
+  std::mutex mutex;
+};
+
+#else // LOCK_FREE_RUN_QUEUE
+
+class LocalRunQueue
+{
+public:
+  bool extract(ProcessBase*)
   {
-    semaphore.decomission();
+    // NOTE: moodycamel::ConcurrentQueue does not provide a way to
+    // implement extract so we simply return false here.
+    return false;
   }
 
-  size_t capacity() const
+  void enqueue(ProcessBase* process)
   {
-    return semaphore.capacity();
+    queue.enqueue(process);
   }
 
-  // Epoch used to capture changes to the run queue when settling.
-  std::atomic_long epoch = ATOMIC_VAR_INIT(0L);
+  ProcessBase* dequeue()
+  {
+    ProcessBase* process = nullptr;
+    if (queue.try_dequeue(process)) {
+      return process;
+    }
+    return nullptr;
+  }
 
-private:
-  std::list<ProcessBase*> processes;
-  std::mutex mutex;
+  bool empty() const
+  {
+    return queue.size_approx() == 0;
+  }
 
-  // Semaphore used for threads to wait.
-#ifndef LAST_IN_FIRST_OUT_FIXED_SIZE_SEMAPHORE
-  DecomissionableKernelSemaphore semaphore;
-#else
-  DecomissionableLastInFirstOutFixedSizeSemaphore semaphore;
-#endif // LAST_IN_FIRST_OUT_FIXED_SIZE_SEMAPHORE
+private:
+  moodycamel::ConcurrentQueue<ProcessBase*> queue;
 };
 
-#else // LOCK_FREE_RUN_QUEUE
+#endif // LOCK_FREE_RUN_QUEUE
 
+
+// The run queue keeps a `LocalRunQueue` per worker thread rather
+// than a single queue shared by all of the worker threads. A process
+// that gets enqueued by a worker thread (e.g., because the process
+// that worker is running did a `dispatch` or `send`) is put on that
+// worker's local queue and is thus likely to get resumed on the same
+// thread with a warm cache. Processes enqueued by other threads
+// (e.g., the event loop thread) are spread across the local queues
+// in a round-robin fashion.
+//
+// When a worker thread's local queue is empty it steals a process
+// from the other local queues, starting with its neighbor. This keeps
+// all workers busy while avoiding having every worker contend on a
+// single queue.
+//
+// A single semaphore is still used to put idle worker threads to
+// sleep, as any worker may need to wake up in order to steal.
+//
+// In addition the run queue can have _dedicated_ local queues, each
+// of which is owned by a dedicated worker thread that only runs the
+// processes pinned to it (see `ProcessManager::spawn`). Dedicated
+// local queues have their own semaphore, are never stolen from, and
+// their owners never steal from the other local queues.
 class RunQueue
 {
 public:
-  bool extract(ProcessBase*)
+  // Creates a local queue for each of the `workers` worker threads
+  // and each of the `dedicated` dedicated worker threads. Must be
+  // called once before any process gets enqueued.
+  void initialize(size_t workers, size_t dedicated = 0)
   {
-    // NOTE: moodycamel::ConcurrentQueue does not provide a way to
-    // implement extract so we simply return false here.
+    CHECK(queues.empty());
+    CHECK_GT(workers, 0u);
+
+    queues.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+      queues.emplace_back(new LocalRunQueue());
+    }
+
+    dedicateds.reserve(dedicated);
+    for (size_t i = 0; i < dedicated; i++) {
+      dedicateds.emplace_back(new Dedicated());
+    }
+  }
+
+  // Makes the calling thread the owner of the local queue at `index`.
+  // Must be called by each worker thread before it calls `dequeue`.
+  void bind(size_t index)
+  {
+    CHECK_LT(index, queues.size());
+    __worker__ = static_cast<long>(index);
+  }
+
+  // Makes the calling thread the owner of the dedicated local queue
+  // at `index`. Must be called by each dedicated worker thread before
+  // it calls `dequeue`.
+  void dedicate(size_t index)
+  {
+    CHECK_LT(index, dedicateds.size());
+    __dedicated__ = static_cast<long>(index);
+  }
+
+  bool extract(ProcessBase* process)
+  {
+    for (size_t i = 0; i < queues.size(); i++) {
+      if (queues[i]->extract(process)) {
+        size.fetch_sub(1);
+        return true;
+      }
+    }
+
+    for (size_t i = 0; i < dedicateds.size(); i++) {
+      if (dedicateds[i]->queue.extract(process)) {
+        dedicateds[i]->size.fetch_sub(1);
+        return true;
+      }
+    }
+
     return false;
   }
 
   void wait()
   {
-    semaphore.wait();
+    if (__dedicated__ >= 0) {
+      dedicateds[__dedicated__]->semaphore.wait();
+    } else {
+      semaphore.wait();
+    }
   }
 
-  void enqueue(ProcessBase* process)
+  void enqueue(ProcessBase* process, const Option<size_t>& dedicated = None())
   {
-    queue.enqueue(process);
+    if (dedicated.isSome()) {
+      CHECK_LT(dedicated.get(), dedicateds.size());
+
+      Dedicated* owner = dedicateds[dedicated.get()].get();
+      owner->size.fetch_add(1);
+      owner->queue.enqueue(process);
+      epoch.fetch_add(1);
+      owner->semaphore.signal();
+      return;
+    }
+
+    size_t index = __worker__ >= 0
+      ? static_cast<size_t>(__worker__)
+      : next.fetch_add(1) % queues.size();
+
+    // NOTE: we increment `size` _before_ we enqueue so that `size` is
+    // never less than the number of processes in the local queues,
+    // see `dequeue` for why this matters.
+    size.fetch_add(1);
+    queues[index]->enqueue(process);
     epoch.fetch_add(1);
     semaphore.signal();
   }
@@ -157,28 +277,71 @@ public:
   // Precondition: `wait` must get called before `dequeue`!
   ProcessBase* dequeue()
   {
-    // NOTE: we loop _forever_ until we actually dequeue a process
+    if (__dedicated__ >= 0) {
+      Dedicated* owner = dedicateds[__dedicated__].get();
+
+      // See the comment below for why we loop here.
+      do {
+        ProcessBase* process = owner->queue.dequeue();
+        if (process != nullptr) {
+          owner->size.fetch_sub(1);
+          return process;
+        }
+      } while (owner->size.load() > 0 && !owner->semaphore.decomissioned());
+
+      return nullptr;
+    }
+
+    const size_t start = __worker__ >= 0
+      ? static_cast<size_t>(__worker__)
+      : 0;
+
+    // NOTE: we keep looking until we actually dequeue a process
     // because the contract for using the run queue is that `wait`
     // must be called first so we know that there is something to be
-    // dequeued or the run queue has been decommissioned and we should
-    // just return `nullptr`.
-    ProcessBase* process = nullptr;
-    while (!queue.try_dequeue(process)) {
-      if (semaphore.decomissioned()) {
-        break;
+    // dequeued _somewhere_. A process might not be found on a single
+    // pass over the local queues because other workers are stealing
+    // (and enqueueing) concurrently, so we only give up when `size`
+    // says there is nothing left (which is possible when a process
+    // got removed via `extract`) or the run queue has been
+    // decommissioned.
+    do {
+      for (size_t i = 0; i < queues.size(); i++) {
+        ProcessBase* process =
+          queues[(start + i) % queues.size()]->dequeue();
+
+        if (process != nullptr) {
+          size.fetch_sub(1);
+          return process;
+        }
       }
-    }
-    return process;
+    } while (size.load() > 0 && !semaphore.decomissioned());
+
+    return nullptr;
   }
 
   bool empty() const
   {
-    return queue.size_approx() == 0;
+    if (size.load() != 0) {
+      return false;
+    }
+
+    for (size_t i = 0; i < dedicateds.size(); i++) {
+      if (dedicateds[i]->size.load() != 0) {
+        return false;
+      }
+    }
+
+    return true;
   }
 
   void decomission()
   {
     semaphore.decomission();
+
+    for (size_t i = 0; i < dedicateds.size(); i++) {
+      dedicateds[i]->semaphore.decomission();
+    }
   }
 
   size_t capacity() const
@@ -190,8 +353,30 @@ public:
   std::atomic_long epoch = ATOMIC_VAR_INIT(0L);
 
 private:
-  moodycamel::ConcurrentQueue<ProcessBase*> queue;
+  // A dedicated local queue. Since only a single thread ever waits on
+  // the semaphore we always use a `DecomissionableKernelSemaphore`.
+  struct Dedicated
+  {
+    LocalRunQueue queue;
+    std::atomic_long size = ATOMIC_VAR_INIT(0L);
+    DecomissionableKernelSemaphore semaphore;
+  };
 
+  // NOTE: the local queues are only created in `initialize` and are
+  // never added or removed afterwards, so they can be accessed
+  // without any synchronization.
+  std::vector<std::unique_ptr<LocalRunQueue>> queues;
+  std::vector<std::unique_ptr<Dedicated>> dedicateds;
+
+  // Number of processes across all of the (non-dedicated) local
+  // queues.
+  std::atomic_long size = ATOMIC_VAR_INIT(0L);
+
+  // Used to pick a local queue when enqueueing from a thread that is
+  // not a worker thread.
+  std::atomic_size_t next = ATOMIC_VAR_INIT(0);
+
+  // Semaphore used for threads to wait.
 #ifndef LAST_IN_FIRST_OUT_FIXED_SIZE_SEMAPHORE
   DecomissionableKernelSemaphore semaphore;
 #else
@@ -199,8 +384,6 @@ private:
 #endif // LAST_IN_FIRST_OUT_FIXED_SIZE_SEMAPHORE
 };
 
-#endif // LOCK_FREE_RUN_QUEUE
-
 } // namespace process {
 
 #endif // __PROCESS_RUN_QUEUE_HPP__
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/shared_array.hpp>
 
@@ -22,6 +23,7 @@
 
 #include <process/ssl/flags.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/os.hpp>
 #include <stout/unreachable.hpp>
 
@@ -192,6 +194,34 @@ Future<string> SocketImpl::recv(const Option<ssize_t>& size)
 }
 
 
+Future<size_t> SocketImpl::send(const std::vector<Buffer>& buffers)
+{
+  // Sending each buffer separately would cost a send (and for SSL a
+  // record) per buffer, so we send a copy of all of them instead.
+  size_t size = 0;
+  foreach (const Buffer& buffer, buffers) {
+    size += buffer.size;
+  }
+
+  if (size == 0) {
+    return 0;
+  }
+
+  std::shared_ptr<string> data(new string());
+  data->reserve(size);
+
+  foreach (const Buffer& buffer, buffers) {
+    data->append(buffer.data, buffer.size);
+  }
+
+  // Keep the copy alive until the send completes.
+  return send(data->data(), data->size())
+    .then([data](size_t length) {
+      return length;
+    });
+}
+
+
 Future<Nothing> SocketImpl::send(const string& data)
 {
   // Extend lifetime by holding onto a reference to ourself!
@@ -81,6 +81,11 @@ public:
 
   Encoder* next(int_fd s);
 
+  // Records that the libprocess instance at the specified address
+  // can decode binary frames (see `FrameEncoder`), so that messages
+  // sent to it from now on use them, including on existing links.
+  void framing(const network::inet::Address& address);
+
   void close(int_fd s);
 
   void exited(const network::inet::Address& address);
@@ -115,6 +120,10 @@ private:
       network::inet::Socket socket,
       const UPID& to);
 
+  // Returns an encoder for sending the message on the specified
+  // outbound socket, using binary framing if the socket does.
+  Encoder* encode(int_fd s, Message&& message);
+
   // Helper function for send().
   void send_connect(
       const Future<Nothing>& future,
@@ -143,6 +152,16 @@ private:
   // (and thus generate ExitedEvents).
   hashmap<network::inet::Address, int_fd> persists;
 
+  // Socket addresses of libprocess instances that have advertised
+  // they can decode binary frames.
+  hashset<network::inet::Address> framers;
+
+  // Outbound sockets on which messages are sent as binary frames
+  // rather than as HTTP requests. A peer only switches its decoder
+  // from HTTP to frames (never back), so a socket stays in here
+  // until it is closed.
+  hashset<int_fd> framed;
+
   // Map from outbound socket to outgoing queue.
   hashmap<int_fd, std::queue<Encoder*>> outgoing;
 
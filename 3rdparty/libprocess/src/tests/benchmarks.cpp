@@ -39,16 +39,24 @@
 #include <stout/stopwatch.hpp>
 
 #include "benchmarks.pb.h"
+#include "decoder.hpp"
+#include "encoder.hpp"
 
 namespace http = process::http;
 
 using process::CountDownLatch;
+using process::DataDecoder;
+using process::FrameDecoder;
+using process::FrameEncoder;
 using process::Future;
+using process::Message;
+using process::MessageEncoder;
 using process::MessageEvent;
 using process::Owned;
 using process::Process;
 using process::ProcessBase;
 using process::Promise;
+using process::StreamingRequestDecoder;
 using process::UPID;
 
 using std::cout;
@@ -495,6 +503,73 @@ TEST(ProcessTest, Process_BENCHMARK_ThroughputPerformance)
 }
 
 
+// Measures how message throughput scales with the number of worker
+// threads kept busy, by running an increasing number of independent
+// client/destination pairs (from 1 up to the number of workers).
+TEST(ProcessTest, Process_BENCHMARK_ThroughputScaling)
+{
+  const long repeatsPerClient = 1000000L;
+
+  vector<long> numberOfClients;
+  for (long n = 1; n < process::workers(); n *= 2) {
+    numberOfClients.push_back(n);
+  }
+  numberOfClients.push_back(process::workers());
+
+  foreach (long clientCount, numberOfClients) {
+    CountDownLatch latch(clientCount);
+
+    vector<Owned<Destination>> destinations;
+    vector<Owned<Client>> clients;
+
+    for (long _ = 0; _ < clientCount; _++) {
+      Owned<Destination> destination(new Destination());
+
+      spawn(*destination);
+
+      Owned<Client> client(new Client(
+          destination->self(),
+          &latch,
+          repeatsPerClient));
+
+      spawn(*client);
+
+      destinations.push_back(destination);
+      clients.push_back(client);
+    }
+
+    Stopwatch watch;
+    watch.start();
+
+    foreach (const Owned<Client>& client, clients) {
+      post(client->self(), "run");
+    }
+
+    AWAIT_READY(latch.triggered());
+
+    Duration elapsed = watch.elapsed();
+
+    double throughput =
+      (double) (repeatsPerClient * clientCount) / elapsed.secs();
+
+    cout << "Workers: " << std::setw(4) << clientCount
+         << " of " << process::workers()
+         << ", throughput: " << std::setw(12) << std::setprecision(0)
+         << std::fixed << throughput << " messages/s" << endl;
+
+    foreach (const Owned<Client>& client, clients) {
+      terminate(client->self());
+      wait(client->self());
+    }
+
+    foreach (const Owned<Destination>& destination, destinations) {
+      terminate(destination->self());
+      wait(destination->self());
+    }
+  }
+}
+
+
 class DispatchProcess : public Process<DispatchProcess>
 {
 public:
@@ -681,3 +756,95 @@ TEST(ProcessTest, Process_BENCHMARK_ProtobufInstallHandler)
     process.run(num_submessages);
   }
 }
+
+
+// Returns the time it takes to decode `data` with `decode`, which is
+// handed the data in chunks of the size that libprocess uses when
+// receiving from a socket.
+template <typename F>
+static Duration decodeAll(const string& data, F decode)
+{
+  const size_t chunk = 80 * 1024;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t offset = 0; offset < data.size(); offset += chunk) {
+    decode(data.data() + offset, std::min(chunk, data.size() - offset));
+  }
+
+  return watch.elapsed();
+}
+
+
+// Measures the decoding throughput of inbound libprocess messages for
+// each of the available decoders.
+TEST(DecoderTest, Process_BENCHMARK_MessageDecoding)
+{
+  const size_t numMessages = 100000;
+  const size_t bodySizes[] = {0, 100, 1000, 10000};
+
+  foreach (size_t bodySize, bodySizes) {
+    Message message;
+    message.name = "mesos.internal.StatusUpdateMessage";
+    message.from = UPID("slave(1)", process::address());
+    message.to = UPID("master", process::address());
+    message.body = string(bodySize, 'x');
+
+    string http;
+    string frames;
+
+    for (size_t i = 0; i < numMessages; i++) {
+      http += MessageEncoder::encode(message);
+
+      FrameEncoder encoder(message);
+      size_t length;
+      foreach (const FrameEncoder::Buffer& buffer, encoder.next(&length)) {
+        frames.append(buffer.data, buffer.size);
+      }
+    }
+
+    size_t decoded = 0;
+
+    StreamingRequestDecoder streaming;
+    Duration streamingElapsed = decodeAll(
+        http,
+        [&](const char* data, size_t length) {
+          // Hand the requests back like `ProcessManager::handle` does.
+          foreach (http::Request* request, streaming.decode(data, length)) {
+            streaming.requestPool()->release(request);
+            decoded++;
+          }
+        });
+
+    DataDecoder allocating;
+    Duration allocatingElapsed = decodeAll(
+        http,
+        [&](const char* data, size_t length) {
+          foreach (http::Request* request, allocating.decode(data, length)) {
+            delete request;
+            decoded++;
+          }
+        });
+
+    FrameDecoder framed(process::address());
+    Duration framedElapsed = decodeAll(
+        frames,
+        [&](const char* data, size_t length) {
+          foreach (Message* message, framed.decode(data, length)) {
+            delete message;
+            decoded++;
+          }
+        });
+
+    EXPECT_EQ(3 * numMessages, decoded);
+
+    cout << "Body size: " << bodySize << " bytes" << endl
+         << "  StreamingRequestDecoder: "
+         << numMessages / streamingElapsed.secs() << " messages/s" << endl
+         << "  DataDecoder: "
+         << numMessages / allocatingElapsed.secs() << " messages/s" << endl
+         << "  FrameDecoder: "
+         << numMessages / framedElapsed.secs() << " messages/s" << endl;
+  }
+}
@@ -14,25 +14,35 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 #include <process/gtest.hpp>
+#include <process/message.hpp>
 #include <process/owned.hpp>
 
 #include <stout/gtest.hpp>
+#include <stout/stringify.hpp>
 
 #include "decoder.hpp"
+#include "encoder.hpp"
 
 namespace http = process::http;
 
 using process::DataDecoder;
+using process::FrameDecoder;
+using process::FrameEncoder;
 using process::Future;
+using process::Message;
+using process::MessageEncoder;
 using process::Owned;
 using process::ResponseDecoder;
 using process::StreamingRequestDecoder;
 using process::StreamingResponseDecoder;
+using process::UPID;
 
 using std::deque;
 using std::string;
+using std::vector;
 
 // TODO(anand): Parameterize the response decoder tests.
 
@@ -325,3 +335,246 @@ TEST(DecoderTest, StreamingResponseInvalidHeader)
 
   EXPECT_TRUE(decoder.failed());
 }
+
+
+TEST(DecoderTest, Frame)
+{
+  const process::network::inet::Address address =
+    process::network::inet4::Address::LOOPBACK_ANY();
+
+  Message message1;
+  message1.name = "name1";
+  message1.from = UPID("from@1.2.3.4:5");
+  message1.to = UPID("to", address);
+  message1.body = "body";
+
+  Message message2;
+  message2.name = "name2";
+  message2.from = UPID("from@1.2.3.4:5");
+  message2.to = UPID("to", address);
+
+  string data;
+  foreach (const Message& message, vector<Message>({message1, message2})) {
+    FrameEncoder encoder(message);
+
+    size_t length;
+    foreach (const FrameEncoder::Buffer& buffer, encoder.next(&length)) {
+      data.append(buffer.data, buffer.size);
+    }
+  }
+
+  // Feed the frames one byte at a time to make sure partial frames
+  // are buffered until they are complete.
+  FrameDecoder decoder(address);
+  deque<Message*> messages;
+
+  foreach (char c, data) {
+    foreach (Message* message, decoder.decode(&c, 1)) {
+      messages.push_back(message);
+    }
+  }
+
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(2u, messages.size());
+
+  Owned<Message> decoded1(messages[0]);
+  EXPECT_EQ(message1.name, decoded1->name);
+  EXPECT_EQ(message1.from, decoded1->from);
+  EXPECT_EQ(message1.to, decoded1->to);
+  EXPECT_EQ(message1.body, decoded1->body);
+
+  Owned<Message> decoded2(messages[1]);
+  EXPECT_EQ(message2.name, decoded2->name);
+  EXPECT_EQ(message2.from, decoded2->from);
+  EXPECT_EQ(message2.to, decoded2->to);
+  EXPECT_TRUE(decoded2->body.empty());
+
+  // An HTTP request is not a valid frame.
+  const string request = "POST /to/name HTTP/1.1\r\n\r\n";
+  decoder.decode(request.data(), request.size());
+  EXPECT_TRUE(decoder.failed());
+}
+
+
+// Verifies that the decoder fails on frames announcing more data than
+// the maximum frame size instead of buffering them.
+TEST(DecoderTest, FrameTooLarge)
+{
+  const process::network::inet::Address address =
+    process::network::inet4::Address::LOOPBACK_ANY();
+
+  // A frame header announcing a 4 GB body, followed by the first few
+  // bytes of the name.
+  string header(1, process::FRAME_MARKER);
+  header += string("\0\0\0\4", 4);
+  header += string("\0\0\0\0", 4);
+  header += string("\0\0\0\0", 4);
+  header += string("\xff\xff\xff\xff", 4);
+  header += "name";
+
+  FrameDecoder decoder(address);
+
+  EXPECT_TRUE(decoder.decode(header.data(), header.size()).empty());
+  EXPECT_TRUE(decoder.failed());
+
+  // As does a frame with an overly long name.
+  string name(1, process::FRAME_MARKER);
+  name += string("\x7f\xff\xff\xff", 4);
+  name += string(12, '\0');
+
+  FrameDecoder decoder2(address);
+
+  EXPECT_TRUE(decoder2.decode(name.data(), name.size()).empty());
+  EXPECT_TRUE(decoder2.failed());
+}
+
+
+
+// Verifies that the streaming request decoder reuses the requests
+// handed back to its pool without leaking the previous request's
+// headers or URL into the next one.
+TEST(DecoderTest, StreamingRequestReuse)
+{
+  StreamingRequestDecoder decoder;
+
+  const string data1 =
+    "GET /path1?key=value#fragment HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Accept-Encoding: gzip\r\n"
+    "\r\n";
+
+  deque<http::Request*> requests =
+    decoder.decode(data1.data(), data1.length());
+
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, requests.size());
+
+  http::Request* request1 = requests[0];
+  EXPECT_EQ("/path1", request1->url.path);
+
+  decoder.requestPool()->release(request1);
+
+  const string data2 =
+    "POST /path2 HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "\r\n";
+
+  requests = decoder.decode(data2.data(), data2.length());
+
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, requests.size());
+
+  // The released request got reused, with only the new request's
+  // method, URL and headers.
+  Owned<http::Request> request2(requests[0]);
+  EXPECT_EQ(request1, request2.get());
+
+  EXPECT_EQ("POST", request2->method);
+  EXPECT_EQ("/path2", request2->url.path);
+  EXPECT_TRUE(request2->url.query.empty());
+  EXPECT_NONE(request2->url.fragment);
+
+  EXPECT_EQ(1u, request2->headers.size());
+  EXPECT_SOME_EQ("localhost", request2->headers.get("Host"));
+
+  ASSERT_EQ(http::Request::PIPE, request2->type);
+  ASSERT_SOME(request2->reader);
+  AWAIT_EXPECT_EQ(string(""), request2->reader->readAll());
+}
+
+// Verifies that a frame whose sender is not a valid UPID is rejected,
+// along with everything that follows it on the connection.
+TEST(DecoderTest, FrameInvalidSender)
+{
+  const process::network::inet::Address address =
+    process::network::inet4::Address::LOOPBACK_ANY();
+
+  Message message;
+  message.name = "name";
+  message.from = UPID("from@1.2.3.4:5");
+  message.to = UPID("to", address);
+
+  string data;
+  foreach (const string& from, vector<string>({"from", "from@1.2.3.4:5"})) {
+    // Encode the frame using a valid sender and replace it afterwards
+    // since `FrameEncoder` only takes a UPID.
+    FrameEncoder encoder(message);
+
+    size_t length;
+    string frame;
+    foreach (const FrameEncoder::Buffer& buffer, encoder.next(&length)) {
+      frame.append(buffer.data, buffer.size);
+    }
+
+    const string sender = stringify(message.from);
+    const size_t offset = process::FRAME_HEADER_SIZE + message.name.size();
+
+    frame.replace(offset, sender.size(), from);
+    frame[1 + sizeof(uint32_t) + 3] = static_cast<char>(from.size());
+
+    data += frame;
+  }
+
+  FrameDecoder decoder(address);
+
+  EXPECT_TRUE(decoder.decode(data.data(), data.size()).empty());
+  EXPECT_TRUE(decoder.failed());
+}
+
+
+// Verifies that the request decoder stops at the start of a binary
+// frame that follows a complete request, so that the caller can decode
+// the rest of the connection as frames.
+TEST(DecoderTest, RequestThenFrame)
+{
+  const process::network::inet::Address address =
+    process::network::inet4::Address::LOOPBACK_ANY();
+
+  Message message;
+  message.name = "name";
+  message.from = UPID("from@1.2.3.4:5");
+  message.to = UPID("to", address);
+  message.body = "body";
+
+  string frame;
+  FrameEncoder encoder(message);
+
+  size_t length;
+  foreach (const FrameEncoder::Buffer& buffer, encoder.next(&length)) {
+    frame.append(buffer.data, buffer.size);
+  }
+
+  const string request = MessageEncoder::encode(message);
+  const string data = request + frame;
+
+  StreamingRequestDecoder decoder;
+
+  deque<http::Request*> requests = decoder.decode(data.data(), data.size());
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, requests.size());
+  EXPECT_SOME_EQ(request.size(), decoder.framed());
+
+  Owned<http::Request> decoded(requests[0]);
+  EXPECT_EQ("/to/name", decoded->url.path);
+  AWAIT_EXPECT_EQ(message.body, decoded->reader->readAll());
+
+  FrameDecoder frames(address);
+  deque<Message*> messages = frames.decode(
+      data.data() + request.size(),
+      data.size() - request.size());
+
+  ASSERT_FALSE(frames.failed());
+  ASSERT_EQ(1u, messages.size());
+
+  Owned<Message> decoded2(messages[0]);
+  EXPECT_EQ(message.name, decoded2->name);
+  EXPECT_EQ(message.body, decoded2->body);
+
+  // A frame marker in the middle of a request is still an error.
+  StreamingRequestDecoder decoder2;
+
+  const string partial = "POST /to/name HTTP/1.1\r\n" + frame;
+  EXPECT_TRUE(decoder2.decode(partial.data(), partial.size()).empty());
+  EXPECT_TRUE(decoder2.failed());
+  EXPECT_NONE(decoder2.framed());
+}
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include <process/http.hpp>
+#include <process/message.hpp>
 #include <process/owned.hpp>
 #include <process/socket.hpp>
 
@@ -28,7 +29,10 @@
 namespace http = process::http;
 
 using process::HttpResponseEncoder;
+using process::Message;
+using process::MessageEncoder;
 using process::Owned;
+using process::UPID;
 using process::ResponseDecoder;
 
 using std::deque;
@@ -115,3 +119,47 @@ TEST(EncoderTest, AcceptableEncodings)
       << gzipRequest.headers.get("Accept-Encoding").get() << "'";
   }
 }
+
+
+// Verifies that encoding a message as separate segments produces
+// the same bytes as the contiguous encoding, including after a
+// partial send that ends in the middle of the body.
+TEST(EncoderTest, Message)
+{
+  Message message;
+  message.name = "name";
+  message.from = UPID("from@1.2.3.4:5");
+  message.to = UPID("to@1.2.3.4:5");
+  message.body = string(1024, 'x');
+
+  const string expected = MessageEncoder::encode(message);
+
+  MessageEncoder encoder(std::move(message));
+  EXPECT_EQ(expected.size(), encoder.remaining());
+
+  string sent;
+
+  // Pretend the first gather write only sent everything up to the
+  // middle of the body, and the second one sent the rest.
+  size_t length;
+  vector<MessageEncoder::Buffer> buffers = encoder.next(&length);
+  ASSERT_EQ(3u, buffers.size());
+  ASSERT_EQ(expected.size(), length);
+
+  const size_t partial = buffers[0].size + 512;
+  sent.append(buffers[0].data, buffers[0].size);
+  sent.append(buffers[1].data, 512);
+  encoder.backup(length - partial);
+  EXPECT_EQ(expected.size() - partial, encoder.remaining());
+
+  buffers = encoder.next(&length);
+  ASSERT_EQ(2u, buffers.size());
+  EXPECT_EQ(expected.size() - partial, length);
+
+  foreach (const MessageEncoder::Buffer& buffer, buffers) {
+    sent.append(buffer.data, buffer.size);
+  }
+
+  EXPECT_EQ(0u, encoder.remaining());
+  EXPECT_EQ(expected, sent);
+}
@@ -0,0 +1,163 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <process/event.hpp>
+#include <process/pid.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+#include <stout/numify.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "event_queue.hpp"
+
+using process::Event;
+using process::EventQueue;
+using process::MessageEvent;
+using process::UPID;
+
+using std::string;
+using std::vector;
+
+
+static Event* createEvent(const string& name)
+{
+  return new MessageEvent(UPID(), UPID(), name, nullptr, 0);
+}
+
+
+// Dequeues the next event, which must be a `MessageEvent`, and
+// returns its name.
+static string dequeue(EventQueue* queue)
+{
+  Event* event = queue->consumer.dequeue();
+  CHECK(event->is<MessageEvent>());
+
+  const string name = static_cast<MessageEvent*>(event)->message.name;
+  delete event;
+
+  return name;
+}
+
+
+// Dequeues all of the events, draining up to `batch` events at a
+// time, and returns their names.
+static vector<string> dequeue(EventQueue* queue, size_t batch)
+{
+  vector<string> names;
+
+  while (!queue->consumer.empty(batch)) {
+    names.push_back(dequeue(queue));
+  }
+
+  return names;
+}
+
+
+// This test verifies that draining events in batches preserves the
+// order of the events, also for events that get enqueued while some
+// events have been drained but not yet dequeued.
+TEST(EventQueueTest, Batch)
+{
+  EventQueue queue;
+
+  for (int i = 0; i < 10; i++) {
+    queue.producer.enqueue(createEvent(stringify(i)));
+  }
+
+  // Dequeue only part of the first batch.
+  ASSERT_FALSE(queue.consumer.empty(4));
+  EXPECT_EQ("0", dequeue(&queue));
+
+  ASSERT_FALSE(queue.consumer.empty(4));
+  EXPECT_EQ("1", dequeue(&queue));
+
+  // The events that were drained but not dequeued are still counted.
+  EXPECT_EQ(8u, queue.consumer.count<MessageEvent>());
+
+  for (int i = 10; i < 15; i++) {
+    queue.producer.enqueue(createEvent(stringify(i)));
+  }
+
+  vector<string> expected;
+  for (int i = 2; i < 15; i++) {
+    expected.push_back(stringify(i));
+  }
+
+  EXPECT_EQ(expected, dequeue(&queue, 4));
+
+  EXPECT_TRUE(queue.consumer.empty());
+  EXPECT_EQ(0u, queue.consumer.count<MessageEvent>());
+
+  queue.consumer.decomission();
+}
+
+
+// This test verifies that draining events in batches preserves the
+// order of the events enqueued by each producer while the producers
+// are concurrently enqueueing.
+TEST(EventQueueTest, BatchMultipleProducers)
+{
+  EventQueue queue;
+
+  const int producers = 4;
+  const int events = 10000;
+
+  vector<std::thread> threads;
+
+  for (int producer = 0; producer < producers; producer++) {
+    threads.emplace_back([&queue, producer, events]() {
+      for (int i = 0; i < events; i++) {
+        queue.producer.enqueue(
+            createEvent(stringify(producer) + " " + stringify(i)));
+      }
+    });
+  }
+
+  // The next event we expect from each producer.
+  vector<int> next(producers, 0);
+
+  for (int dequeued = 0; dequeued < producers * events;) {
+    if (queue.consumer.empty(16)) {
+      continue;
+    }
+
+    vector<string> tokens = strings::tokenize(dequeue(&queue), " ");
+    ASSERT_EQ(2u, tokens.size());
+
+    Try<int> producer = numify<int>(tokens[0]);
+    Try<int> i = numify<int>(tokens[1]);
+
+    ASSERT_SOME(producer);
+    ASSERT_SOME(i);
+
+    EXPECT_EQ(next[producer.get()], i.get());
+    next[producer.get()] = i.get() + 1;
+
+    dequeued++;
+  }
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+
+  EXPECT_TRUE(queue.consumer.empty(16));
+
+  queue.consumer.decomission();
+}
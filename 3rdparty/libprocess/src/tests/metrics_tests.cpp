@@ -531,6 +531,27 @@ TEST_F(MetricsTest, Timer)
 }
 
 
+TEST_F(MetricsTest, TimerRecord)
+{
+  metrics::Timer<Milliseconds> timer("test/timer", Seconds(60));
+  EXPECT_EQ("test/timer_ms", timer.name());
+
+  AWAIT_READY(metrics::add(timer));
+
+  EXPECT_EQ(Milliseconds(3), timer.record(Microseconds(3000)));
+
+  Future<double> value = timer.value();
+  AWAIT_READY(value);
+  EXPECT_DOUBLE_EQ(3.0, value.get());
+
+  Option<Statistics<double>> statistics = timer.statistics();
+  ASSERT_SOME(statistics);
+  EXPECT_EQ(1u, statistics->count);
+
+  AWAIT_READY(metrics::remove(timer));
+}
+
+
 static Future<int> advanceAndReturn()
 {
   Clock::advance(Seconds(1));
@@ -13,6 +13,11 @@
 #include <errno.h>
 #include <time.h>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+
 #ifndef __WINDOWS__
 #include <arpa/inet.h>
 #endif // __WINDOWS__
@@ -25,8 +30,14 @@
 #endif // __WINDOWS__
 
 #include <atomic>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <process/async.hpp>
@@ -50,6 +61,7 @@
 #include <process/time.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -58,11 +70,14 @@
 #include <stout/os.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
 #include <stout/os/killtree.hpp>
 #include <stout/os/write.hpp>
 
+#include "decoder.hpp"
+#include "dedicated_worker.hpp"
 #include "encoder.hpp"
 
 namespace http = process::http;
@@ -71,12 +86,15 @@ namespace inet4 = process::network::inet4;
 
 using process::async;
 using process::Clock;
+using process::Coalescer;
 using process::CountDownLatch;
 using process::defer;
 using process::Deferred;
 using process::Event;
 using process::Executor;
 using process::ExitedEvent;
+using process::FrameDecoder;
+using process::FrameEncoder;
 using process::Future;
 using process::Message;
 using process::MessageEncoder;
@@ -85,6 +103,7 @@ using process::Owned;
 using process::PID;
 using process::Process;
 using process::ProcessBase;
+using process::Promise;
 using process::run;
 using process::Subprocess;
 using process::TerminateEvent;
@@ -94,10 +113,18 @@ using process::UPID;
 using process::firewall::DisabledEndpointsFirewallRule;
 using process::firewall::FirewallRule;
 
+using process::READONLY_HTTP_AUTHENTICATION_REALM;
+using process::READWRITE_HTTP_AUTHENTICATION_REALM;
+
+using process::internal::DedicatedWorker;
+
 using process::network::inet::Address;
 using process::network::inet::Socket;
 
+using std::deque;
+using std::map;
 using std::move;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -108,6 +135,17 @@ using testing::InvokeWithoutArgs;
 using testing::Return;
 using testing::ReturnArg;
 
+namespace process {
+
+// We need to reinitialize libprocess in order to test against different
+// configurations, such as when libprocess has dedicated worker threads.
+void reinitialize(
+    const Option<string>& delegate,
+    const Option<string>& readonlyAuthenticationRealm,
+    const Option<string>& readwriteAuthenticationRealm);
+
+} // namespace process {
+
 // TODO(bmahler): Move tests into their own files as appropriate.
 
 TEST(ProcessTest, Event)
@@ -211,6 +249,49 @@ TEST(ProcessTest, Dispatch)
 }
 
 
+class CoalesceProcess : public Process<CoalesceProcess>
+{
+public:
+  void block(const Future<Nothing>& future) { future.await(); }
+
+  int increment() { return ++invocations; }
+
+private:
+  int invocations = 0;
+};
+
+
+TEST(ProcessTest, CoalescingDispatch)
+{
+  CoalesceProcess process;
+  PID<CoalesceProcess> pid = spawn(&process);
+
+  // Keep the process busy so the dispatches below stay pending.
+  Promise<Nothing> promise;
+  dispatch(pid, &CoalesceProcess::block, promise.future());
+
+  Coalescer<int> coalescer;
+
+  Future<int> future1 = dispatch(coalescer, pid, &CoalesceProcess::increment);
+  Future<int> future2 = dispatch(coalescer, pid, &CoalesceProcess::increment);
+
+  EXPECT_TRUE(coalescer.pending());
+  EXPECT_EQ(future1, future2);
+
+  promise.set(Nothing());
+
+  AWAIT_EXPECT_EQ(1, future1);
+  EXPECT_FALSE(coalescer.pending());
+
+  // Once the coalesced dispatch has started running any further
+  // dispatch results in another invocation.
+  AWAIT_EXPECT_EQ(2, dispatch(coalescer, pid, &CoalesceProcess::increment));
+
+  terminate(pid);
+  wait(pid);
+}
+
+
 TEST(ProcessTest, Defer1)
 {
   DispatchProcess process;
@@ -2024,3 +2105,471 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, FirewallUninstall)
   terminate(process);
   wait(process);
 }
+
+
+// Reinitializes libprocess with the specified `LIBPROCESS_` environment
+// variables, which are unset again (and libprocess reinitialized with
+// the default configuration) when the test is torn down.
+class ProcessFlagsTest : public ::testing::Test
+{
+protected:
+  void reinitialize(const map<string, string>& environment)
+  {
+    foreachpair (const string& name, const string& value, environment) {
+      os::setenv(name, value);
+      names.insert(name);
+    }
+
+    process::reinitialize(
+        None(),
+        READWRITE_HTTP_AUTHENTICATION_REALM,
+        READONLY_HTTP_AUTHENTICATION_REALM);
+  }
+
+  virtual void TearDown()
+  {
+    if (names.empty()) {
+      return;
+    }
+
+    foreach (const string& name, names) {
+      os::unsetenv(name);
+    }
+
+    process::reinitialize(
+        None(),
+        READWRITE_HTTP_AUTHENTICATION_REALM,
+        READONLY_HTTP_AUTHENTICATION_REALM);
+  }
+
+private:
+  set<string> names;
+};
+
+
+TEST(DedicatedWorkerTest, Parse)
+{
+  Try<vector<DedicatedWorker>> workers =
+    DedicatedWorker::parse("master, hierarchical-allocator:3,registrar");
+
+  ASSERT_SOME(workers);
+  ASSERT_EQ(3u, workers->size());
+
+  EXPECT_EQ("master", workers->at(0).id);
+  EXPECT_NONE(workers->at(0).cpu);
+
+  EXPECT_EQ("hierarchical-allocator", workers->at(1).id);
+  EXPECT_SOME_EQ(3, workers->at(1).cpu);
+
+  EXPECT_EQ("registrar", workers->at(2).id);
+  EXPECT_NONE(workers->at(2).cpu);
+
+  EXPECT_ERROR(DedicatedWorker::parse(":1"));
+  EXPECT_ERROR(DedicatedWorker::parse("master:"));
+  EXPECT_ERROR(DedicatedWorker::parse("master:first"));
+  EXPECT_ERROR(DedicatedWorker::parse("master:-1"));
+  EXPECT_ERROR(DedicatedWorker::parse("master:1:2"));
+  EXPECT_ERROR(DedicatedWorker::parse("master,:1"));
+}
+
+
+TEST(DedicatedWorkerTest, Matches)
+{
+  DedicatedWorker worker;
+  worker.id = "registrar";
+
+  EXPECT_TRUE(worker.matches("registrar"));
+  EXPECT_TRUE(worker.matches("registrar(1)"));
+
+  EXPECT_FALSE(worker.matches("registrar-1"));
+  EXPECT_FALSE(worker.matches("registrar2(1)"));
+  EXPECT_FALSE(worker.matches("master"));
+}
+
+
+class ThreadProcess : public Process<ThreadProcess>
+{
+public:
+  explicit ThreadProcess(const string& id) : ProcessBase(id) {}
+
+  std::thread::id thread()
+  {
+    return std::this_thread::get_id();
+  }
+
+#ifdef __linux__
+  // Returns the CPUs the current thread may run on.
+  set<int> cpus()
+  {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    CHECK_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus));
+
+    set<int> result;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &cpus)) {
+        result.insert(cpu);
+      }
+    }
+
+    return result;
+  }
+#endif // __linux__
+};
+
+
+// This test verifies that a process matching an entry of
+// `LIBPROCESS_DEDICATED_WORKERS` only ever runs on the dedicated
+// worker thread of that entry, and that no other process runs on it.
+TEST_F(ProcessFlagsTest, DedicatedWorkers)
+{
+  // No process matches the 'unknown' entry, which still gets a thread.
+  reinitialize({{"LIBPROCESS_DEDICATED_WORKERS", "pinned,unknown"}});
+
+  ThreadProcess pinned(process::ID::generate("pinned"));
+  ThreadProcess unpinned(process::ID::generate("unpinned"));
+
+  spawn(pinned);
+  spawn(unpinned);
+
+  set<std::thread::id> pinnedThreads;
+  set<std::thread::id> unpinnedThreads;
+
+  for (int i = 0; i < 100; i++) {
+    Future<std::thread::id> thread1 = dispatch(pinned, &ThreadProcess::thread);
+    Future<std::thread::id> thread2 =
+      dispatch(unpinned, &ThreadProcess::thread);
+
+    AWAIT_READY(thread1);
+    AWAIT_READY(thread2);
+
+    pinnedThreads.insert(thread1.get());
+    unpinnedThreads.insert(thread2.get());
+  }
+
+  ASSERT_EQ(1u, pinnedThreads.size());
+
+  const std::thread::id thread = *pinnedThreads.begin();
+
+  EXPECT_NE(std::this_thread::get_id(), thread);
+  EXPECT_EQ(0u, unpinnedThreads.count(thread));
+
+  terminate(pinned);
+  wait(pinned);
+
+  terminate(unpinned);
+  wait(unpinned);
+}
+
+
+#ifdef __linux__
+// This test verifies that the dedicated worker thread of an entry of
+// `LIBPROCESS_DEDICATED_WORKERS` with a CPU is pinned to that CPU.
+TEST_F(ProcessFlagsTest, DedicatedWorkerCPU)
+{
+  // Use the last CPU this (test) thread may run on, since the other
+  // CPUs might not be available to us, e.g., in a container.
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(cpus), &cpus));
+
+  int cpu = -1;
+  for (int i = 0; i < CPU_SETSIZE; i++) {
+    if (CPU_ISSET(i, &cpus)) {
+      cpu = i;
+    }
+  }
+
+  ASSERT_LE(0, cpu);
+
+  reinitialize(
+      {{"LIBPROCESS_DEDICATED_WORKERS", "pinned:" + stringify(cpu)}});
+
+  ThreadProcess pinned("pinned");
+  spawn(pinned);
+
+  Future<set<int>> pinnedCpus = dispatch(pinned, &ThreadProcess::cpus);
+  AWAIT_EXPECT_EQ(set<int>({cpu}), pinnedCpus);
+
+  terminate(pinned);
+  wait(pinned);
+}
+#endif // __linux__
+
+
+// Records the order in which the processes sharing `records` serve
+// their `record` calls.
+class RecordingProcess : public Process<RecordingProcess>
+{
+public:
+  struct Records
+  {
+    std::mutex mutex;
+    vector<string> records;
+  };
+
+  explicit RecordingProcess(Records* records) : records(records) {}
+
+  // Blocks the worker thread serving this process until `unblocked`
+  // becomes ready, after setting `blocked`.
+  void block(std::promise<void>* blocked, std::future<void>* unblocked)
+  {
+    blocked->set_value();
+    unblocked->wait();
+  }
+
+  Nothing record(const string& record)
+  {
+    synchronized (records->mutex) {
+      records->records.push_back(record);
+    }
+
+    return Nothing();
+  }
+
+private:
+  Records* records;
+};
+
+
+// Blocks the only worker thread in `busy`, then enqueues `count` calls
+// of `record` in `busy` and a single one in `other`, and returns the
+// order in which they were served once the worker thread is unblocked.
+static vector<string> recordWhileBlocked(size_t count)
+{
+  RecordingProcess::Records records;
+
+  RecordingProcess busy(&records);
+  RecordingProcess other(&records);
+
+  spawn(busy);
+  spawn(other);
+
+  std::promise<void> blocked;
+  std::promise<void> unblock;
+  std::future<void> unblocked = unblock.get_future();
+
+  dispatch(busy, &RecordingProcess::block, &blocked, &unblocked);
+
+  blocked.get_future().wait();
+
+  vector<Future<Nothing>> futures;
+
+  for (size_t i = 0; i < count; i++) {
+    futures.push_back(
+        dispatch(busy, &RecordingProcess::record, "busy " + stringify(i)));
+  }
+
+  futures.push_back(dispatch(other, &RecordingProcess::record, "other"));
+
+  unblock.set_value();
+
+  foreach (const Future<Nothing>& future, futures) {
+    AWAIT_EXPECT_READY(future);
+  }
+
+  terminate(busy);
+  wait(busy);
+
+  terminate(other);
+  wait(other);
+
+  synchronized (records.mutex) {
+    return records.records;
+  }
+}
+
+
+// This test verifies that a process serves all of its events, in
+// order, before yielding the worker thread when the events are
+// drained in batches and the number of events per resume is not
+// bounded.
+TEST_F(ProcessFlagsTest, EventBatchOrder)
+{
+  reinitialize({
+      {"LIBPROCESS_NUM_WORKER_THREADS", "1"},
+      {"LIBPROCESS_EVENT_BATCH_SIZE", "4"}});
+
+  vector<string> expected;
+  for (int i = 0; i < 10; i++) {
+    expected.push_back("busy " + stringify(i));
+  }
+
+  expected.push_back("other");
+
+  EXPECT_EQ(expected, recordWhileBlocked(10));
+}
+
+
+// This test verifies that a process that exceeds
+// `LIBPROCESS_MAX_EVENTS_PER_RESUME` is put back on the run queue so
+// that other processes get to run, and that it later serves its
+// remaining events (including the ones it had already drained) in
+// order.
+TEST_F(ProcessFlagsTest, MaxEventsPerResume)
+{
+  reinitialize({
+      {"LIBPROCESS_NUM_WORKER_THREADS", "1"},
+      {"LIBPROCESS_EVENT_BATCH_SIZE", "4"},
+      {"LIBPROCESS_MAX_EVENTS_PER_RESUME", "2"}});
+
+  vector<string> records = recordWhileBlocked(10);
+
+  ASSERT_EQ(11u, records.size());
+
+  vector<string> busy;
+  foreach (const string& record, records) {
+    if (record != "other") {
+      busy.push_back(record);
+    }
+  }
+
+  vector<string> expected;
+  for (int i = 0; i < 10; i++) {
+    expected.push_back("busy " + stringify(i));
+  }
+
+  EXPECT_EQ(expected, busy);
+
+  // The blocked call and 'busy 0' use up the events of the first
+  // resume of `busy`, after which `other` runs since it was enqueued
+  // before `busy` got put back on the run queue.
+  //
+  // NOTE: The lock-free run queue does not order the processes that
+  // get enqueued by different threads, in which case `other` may run
+  // after any of the resumes of `busy`.
+#ifndef LOCK_FREE_RUN_QUEUE
+  EXPECT_EQ("other", records[1]);
+#endif // LOCK_FREE_RUN_QUEUE
+}
+
+
+class FramingProcess : public Process<FramingProcess>
+{
+public:
+  FramingProcess() : ProcessBase(process::ID::generate("framing"))
+  {
+    install("handler", &FramingProcess::handler);
+  }
+
+  void link(const UPID& to)
+  {
+    ProcessBase::link(to);
+  }
+
+  void send(const UPID& to, const string& name)
+  {
+    ProcessBase::send(to, name);
+  }
+
+  MOCK_METHOD2(handler, void(const UPID&, const string&));
+};
+
+
+// This test verifies that binary framing gets negotiated with a peer
+// that advertises it: the link that existed before the peer sent us
+// anything switches to frames and we accept frames on a connection
+// that started out with HTTP. The test plays the part of the peer
+// using plain sockets so that it can look at what is on the wire.
+TEST_F(ProcessFlagsTest, BinaryFraming)
+{
+  reinitialize({{"LIBPROCESS_BINARY_FRAMING", "true"}});
+
+  FramingProcess process;
+  spawn(process);
+
+  Future<Nothing> handler1;
+  Future<Nothing> handler2;
+  EXPECT_CALL(process, handler(_, _))
+    .WillOnce(FutureSatisfy(&handler1))
+    .WillOnce(FutureSatisfy(&handler2));
+
+  Try<Socket> server = Socket::create();
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(inet4::Address::ANY_ANY()));
+  ASSERT_SOME(server->listen(1));
+
+  Try<Address> address = server->address();
+  ASSERT_SOME(address);
+
+  const UPID peer("peer", process.self().address.ip, address->port);
+
+  // Link to the peer before it has advertised binary framing.
+  Future<Socket> accept = server->accept();
+
+  dispatch(process, &FramingProcess::link, peer);
+
+  AWAIT_READY(accept);
+
+  Socket link = accept.get();
+
+  dispatch(process, &FramingProcess::send, peer, "http");
+
+  string data;
+  while (data.find("\r\n\r\n") == string::npos) {
+    Future<string> recv = link.recv();
+    AWAIT_READY(recv);
+    ASSERT_FALSE(recv->empty());
+
+    data += recv.get();
+  }
+
+  EXPECT_EQ(0u, data.find("POST /peer/http HTTP/1.1\r\n"));
+
+  // Advertise binary framing with an HTTP message from the peer.
+  Try<Socket> client = Socket::create();
+  ASSERT_SOME(client);
+
+  AWAIT_READY(client->connect(process.self().address));
+
+  Message message;
+  message.name = "handler";
+  message.from = peer;
+  message.to = process.self();
+
+  AWAIT_READY(client->send(MessageEncoder::encode(message)));
+  AWAIT_READY(handler1);
+
+  // The next message on the existing link is sent as a frame.
+  dispatch(process, &FramingProcess::send, peer, "frame");
+
+  FrameDecoder decoder(address.get());
+  deque<Message*> messages;
+
+  data.clear();
+  while (messages.empty()) {
+    Future<string> recv = link.recv();
+    AWAIT_READY(recv);
+    ASSERT_FALSE(recv->empty());
+
+    data += recv.get();
+    messages = decoder.decode(recv->data(), recv->size());
+    ASSERT_FALSE(decoder.failed());
+  }
+
+  EXPECT_EQ(process::FRAME_MARKER, data[0]);
+  ASSERT_EQ(1u, messages.size());
+
+  Owned<Message> received(messages[0]);
+  EXPECT_EQ("frame", received->name);
+  EXPECT_EQ(process.self(), received->from);
+
+  // A frame following the HTTP message on the peer's connection is
+  // delivered too.
+  FrameEncoder encoder(message);
+
+  string frame;
+  size_t length;
+  foreach (const FrameEncoder::Buffer& buffer, encoder.next(&length)) {
+    frame.append(buffer.data, buffer.size);
+  }
+
+  AWAIT_READY(client->send(frame));
+  AWAIT_READY(handler2);
+
+  terminate(process);
+  wait(process);
+}
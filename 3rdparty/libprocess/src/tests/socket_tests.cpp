@@ -10,7 +10,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -23,6 +26,8 @@
 #include <process/ssl/gtest.hpp>
 
 #include <stout/gtest.hpp>
+#include <stout/os.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 #include <stout/tests/utils.hpp>
@@ -39,7 +44,11 @@ using process::READWRITE_HTTP_AUTHENTICATION_REALM;
 using process::network::inet::Address;
 using process::network::inet::Socket;
 
+using process::network::internal::SocketImpl;
+
+using std::set;
 using std::string;
+using std::vector;
 
 using testing::WithParamInterface;
 
@@ -91,12 +100,13 @@ TEST_F(SocketTest, Unix)
 }
 
 
-// Parameterize the tests with the type of encryption used.
-class NetSocketTest : public SSLTemporaryDirectoryTest,
-                      public WithParamInterface<string>
+// Parameterize the tests with the type of encryption used and with the
+// poller, i.e., whether the event loops poll using libev watchers or
+// using io_uring (see `LIBPROCESS_ENABLE_IO_URING`).
+class NetSocketTest
+  : public SSLTemporaryDirectoryTest,
+    public WithParamInterface<std::tuple<string, string>>
 {
-// These are only needed if libprocess is compiled with SSL support.
-#ifdef USE_SSL_SOCKET
 protected:
   virtual void SetUp()
   {
@@ -104,7 +114,9 @@ protected:
     // directory before SSL helpers like `key_path()` are called.
     SSLTemporaryDirectoryTest::SetUp();
 
-    if (GetParam() == "SSL") {
+// These are only needed if libprocess is compiled with SSL support.
+#ifdef USE_SSL_SOCKET
+    if (std::get<0>(GetParam()) == "SSL") {
       generate_keys_and_certs();
       set_environment_variables({
           {"LIBPROCESS_SSL_ENABLED", "true"},
@@ -113,6 +125,11 @@ protected:
     } else {
       set_environment_variables({});
     }
+#endif // USE_SSL_SOCKET
+
+    os::setenv(
+        "LIBPROCESS_ENABLE_IO_URING",
+        std::get<1>(GetParam()) == "io_uring" ? "true" : "false");
 
     process::reinitialize(
         None(),
@@ -123,7 +140,12 @@ protected:
 public:
   static void TearDownTestCase()
   {
+#ifdef USE_SSL_SOCKET
     set_environment_variables({});
+#endif // USE_SSL_SOCKET
+
+    os::unsetenv("LIBPROCESS_ENABLE_IO_URING");
+
     process::reinitialize(
         None(),
         READWRITE_HTTP_AUTHENTICATION_REALM,
@@ -131,26 +153,31 @@ public:
 
     SSLTemporaryDirectoryTest::TearDownTestCase();
   }
-#endif // USE_SSL_SOCKET
 };
 
-// NOTE: `#ifdef`'ing out the argument `string("SSL")` argument causes a
+// NOTE: `#ifdef`'ing out arguments of `INSTANTIATE_TEST_CASE_P` causes a
 // build break on Windows, because the preprocessor is not required to to
-// process the text it expands.
+// process the text it expands. Hence the parameters are collected here.
+static const vector<string> ENCRYPTIONS = {
 #ifdef USE_SSL_SOCKET
+  "SSL",
+#endif // USE_SSL_SOCKET
+  "Non-SSL"
+};
+
+static const vector<string> POLLERS = {
+  "libev",
+#ifdef ENABLE_IO_URING
+  "io_uring"
+#endif // ENABLE_IO_URING
+};
+
 INSTANTIATE_TEST_CASE_P(
-    Encryption,
-    NetSocketTest,
-    ::testing::Values(
-        string("SSL"),
-        string("Non-SSL")));
-#else
-INSTANTIATE_TEST_CASE_P(
-    Encryption,
+    EncryptionAndPoller,
     NetSocketTest,
-    ::testing::Values(
-        string("Non-SSL")));
-#endif // USE_SSL_SOCKET
+    ::testing::Combine(
+        ::testing::ValuesIn(ENCRYPTIONS),
+        ::testing::ValuesIn(POLLERS)));
 
 
 // This test verifies that if an EOF arrives on a socket when there is no
@@ -243,4 +270,143 @@ TEST_P(NetSocketTest, EOFAfterRecv)
 
   AWAIT_EXPECT_EQ(string(), receive);
 }
+
+
+// This test verifies that sending several buffers at once sends them
+// as though they were one contiguous buffer. With SSL this covers the
+// default implementation, which copies the buffers, and otherwise the
+// gather write of the poll socket.
+TEST_P(NetSocketTest, SendBuffers)
+{
+  Try<Socket> client = Socket::create();
+  ASSERT_SOME(client);
+
+  Try<Socket> server = Socket::create();
+  ASSERT_SOME(server);
+
+  Try<Address> server_address = server->bind(inet4::Address::ANY_ANY());
+  ASSERT_SOME(server_address);
+
+  ASSERT_SOME(server->listen(1));
+  Future<Socket> server_accept = server->accept();
+
+  AWAIT_READY(
+      client->connect(Address(process::address().ip, server_address->port)));
+
+  AWAIT_READY(server_accept);
+
+  Socket server_socket = server_accept.get();
+
+  const string header = "Lorem ipsum ";
+  const string body = "dolor sit amet";
+
+  const vector<SocketImpl::Buffer> buffers = {
+    {header.data(), header.size()},
+    {nullptr, 0},
+    {body.data(), body.size()}
+  };
+
+  const string data = header + body;
+
+  // The buffers might not all be sent at once, so keep sending the
+  // remaining data until all of it has been sent.
+  Future<size_t> sent = client->send(buffers);
+  AWAIT_READY(sent);
+  ASSERT_LT(0u, sent.get());
+
+  if (sent.get() < data.size()) {
+    AWAIT_READY(client->send(data.substr(sent.get())));
+  }
+
+  AWAIT_EXPECT_EQ(data, server_socket.recv(data.size()));
+}
+
+
+static const size_t IO_THREADS = 4;
+
+
+// Runs libprocess with multiple I/O threads, restoring the default
+// (including when a test fails) once the test is done.
+class IOThreadsSocketTest : public TemporaryDirectoryTest
+{
+protected:
+  virtual void SetUp()
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    os::setenv("LIBPROCESS_NUM_IO_THREADS", stringify(IO_THREADS));
+
+    process::reinitialize(
+        None(),
+        READWRITE_HTTP_AUTHENTICATION_REALM,
+        READONLY_HTTP_AUTHENTICATION_REALM);
+  }
+
+  virtual void TearDown()
+  {
+    os::unsetenv("LIBPROCESS_NUM_IO_THREADS");
+
+    process::reinitialize(
+        None(),
+        READWRITE_HTTP_AUTHENTICATION_REALM,
+        READONLY_HTTP_AUTHENTICATION_REALM);
+
+    TemporaryDirectoryTest::TearDown();
+  }
+};
+
+
+// This test verifies that sockets work when libprocess shards the
+// socket I/O across multiple I/O threads, and that libprocess can be
+// reinitialized with a different number of I/O threads.
+TEST_F(IOThreadsSocketTest, MultipleIOThreads)
+{
+  Try<Socket> server = Socket::create();
+  ASSERT_SOME(server);
+
+  Try<Address> server_address = server->bind(inet4::Address::ANY_ANY());
+  ASSERT_SOME(server_address);
+
+  ASSERT_SOME(server->listen(8));
+
+  // The event loop of each socket, which is picked based on its file
+  // descriptor (see `loop_for` in libev.hpp).
+  set<int> loops;
+
+  // Keep the sockets open so that their file descriptors don't get
+  // reused by the next connection.
+  vector<Socket> sockets;
+
+  // Use enough connections for the file descriptors of the sockets to
+  // be spread over all of the I/O threads.
+  for (int i = 0; i < 8; i++) {
+    Try<Socket> client = Socket::create();
+    ASSERT_SOME(client);
+
+    Future<Socket> server_accept = server->accept();
+
+    AWAIT_READY(
+        client->connect(Address(process::address().ip, server_address->port)));
+
+    AWAIT_READY(server_accept);
+
+    Socket server_socket = server_accept.get();
+
+    const string data = "Hello World " + stringify(i);
+
+    AWAIT_READY(client->send(data));
+    AWAIT_EXPECT_EQ(data, server_socket.recv(data.size()));
+
+    AWAIT_READY(server_socket.send(data));
+    AWAIT_EXPECT_EQ(data, client->recv(data.size()));
+
+    loops.insert(client->get() % IO_THREADS);
+    loops.insert(server_socket.get() % IO_THREADS);
+
+    sockets.push_back(client.get());
+    sockets.push_back(server_socket);
+  }
+
+  EXPECT_EQ(IO_THREADS, loops.size());
+}
 #endif // __WINDOWS__
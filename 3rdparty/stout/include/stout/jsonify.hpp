@@ -465,6 +465,24 @@ private:
 };
 
 
+// A value that has already been serialized to JSON, e.g., a cached
+// rendering of an object. It is written out verbatim, hence it must hold
+// exactly one valid JSON value.
+//
+// NOTE: Like `Proxy`, this captures the string by reference, so it has to
+// be used before the end of the full expression.
+class RawValue
+{
+public:
+  explicit RawValue(const std::string& value) : value_(value) {}
+
+  const std::string& value() const { return value_; }
+
+private:
+  const std::string& value_;
+};
+
+
 // `json` function for boolean.
 inline void json(BooleanWriter* writer, bool value) { writer->set(value); }
 
@@ -772,6 +790,13 @@ std::function<void(std::ostream*)> jsonify(const T& value, LessPrefer)
   };
 }
 
+// Given a `RawValue`, the "write" function inserts it as is.
+inline std::function<void(std::ostream*)> jsonify(
+    const RawValue& value, Prefer)
+{
+  return [&value](std::ostream* stream) { *stream << value.value(); };
+}
+
 } // namespace internal {
 } // namespace JSON {
 
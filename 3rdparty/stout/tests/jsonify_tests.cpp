@@ -338,3 +338,20 @@ TEST(JsonifyTest, JSONNull)
   JSON::Array numbers = JSON::Array{1, JSON::Null(), 3};
   EXPECT_EQ("[1,null,3]", string(jsonify(numbers)));
 }
+
+
+// Tests that `JSON::RawValue`s are inserted verbatim.
+TEST(JsonifyTest, RawValue)
+{
+  const string cached = "{\"first_name\":\"michael\"}";
+  EXPECT_EQ(cached, string(jsonify(JSON::RawValue(cached))));
+
+  vector<string> names = {cached, "null"};
+  EXPECT_EQ(
+      "[{\"first_name\":\"michael\"},null]",
+      string(jsonify([&names](JSON::ArrayWriter* writer) {
+        foreach (const string& name, names) {
+          writer->element(JSON::RawValue(name));
+        }
+      })));
+}
@@ -79,6 +79,11 @@ option(
   "Use libevent instead of libev as the core event loop implementation."
   FALSE)
 
+option(
+  ENABLE_IO_URING
+  "Use io_uring (if supported by the kernel) for polling in libprocess."
+  FALSE)
+
 option(
   ENABLE_SSL
   "Build libprocess with SSL support."
@@ -161,6 +166,41 @@ if (ENABLE_SSL AND (NOT ENABLE_LIBEVENT))
     "'ENABLE_SSL' currently requires 'ENABLE_LIBEVENT'.")
 endif ()
 
+if (ENABLE_IO_URING AND (ENABLE_LIBEVENT OR (NOT LINUX)))
+  message(
+    FATAL_ERROR
+    "'ENABLE_IO_URING' is only supported on Linux with libev.")
+endif ()
+
+if (ENABLE_IO_URING)
+  # The io_uring poller relies on features and opcodes that were only
+  # added to the headers in Linux 5.5.
+  include(CheckCSourceCompiles)
+  include(CheckSymbolExists)
+
+  check_symbol_exists(
+    IORING_FEAT_NODROP linux/io_uring.h HAVE_IORING_FEAT_NODROP)
+
+  check_symbol_exists(
+    IORING_FEAT_SINGLE_MMAP linux/io_uring.h HAVE_IORING_FEAT_SINGLE_MMAP)
+
+  # NOTE: The opcodes are enumerators in recent headers, which
+  # `check_symbol_exists` can't detect.
+  check_c_source_compiles("
+    #include <linux/io_uring.h>
+    int main() { return IORING_OP_POLL_ADD + IORING_OP_POLL_REMOVE; }"
+    HAVE_IORING_OP_POLL)
+
+  if (NOT (HAVE_IORING_FEAT_NODROP AND
+           HAVE_IORING_FEAT_SINGLE_MMAP AND
+           HAVE_IORING_OP_POLL))
+    message(
+      FATAL_ERROR
+      "'ENABLE_IO_URING' requires the io_uring headers of Linux 5.5 or "
+      "later.")
+  endif ()
+endif ()
+
 
 # SYSTEM CHECKS.
 ################
@@ -0,0 +1,122 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __INTERNED_HPP__
+#define __INTERNED_HPP__
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace mesos {
+
+/**
+ * A handle to a string in a process-wide table of interned strings.
+ *
+ * Each distinct value is stored exactly once in the table, hence two
+ * handles are equal iff their values are equal, and comparing or
+ * hashing handles doesn't need to look at the values. This is meant
+ * for the small set of strings that are compared over and over again,
+ * e.g., resource names and roles.
+ *
+ * Interning a value takes a lookup in the table, and values are never
+ * removed from the table, so this should NOT be used for arbitrary or
+ * unbounded sets of strings (e.g., IDs).
+ *
+ * Interning is thread-safe, and handles can be copied and compared
+ * from any thread.
+ */
+class InternedString
+{
+public:
+  /**
+   * Orders handles by their identity rather than their values. This is
+   * cheaper than comparing the values for sorted containers that only
+   * need some consistent order, but the order is arbitrary and differs
+   * between processes, i.e., it should not be exposed.
+   */
+  struct HandleLess
+  {
+    bool operator()(
+        const InternedString& left,
+        const InternedString& right) const
+    {
+      return std::less<const std::string*>()(
+          left.interned, right.interned);
+    }
+  };
+
+  /**
+   * Returns a handle for the empty string.
+   */
+  InternedString();
+
+  /**
+   * Interns the value, i.e., adds it to the table if it is not
+   * already in there, and returns a handle for it.
+   */
+  explicit InternedString(const std::string& value);
+  explicit InternedString(const char* value);
+
+  const std::string& value() const { return *interned; }
+
+  bool empty() const { return interned->empty(); }
+
+  bool operator==(const InternedString& that) const
+  {
+    return interned == that.interned;
+  }
+
+  bool operator!=(const InternedString& that) const
+  {
+    return interned != that.interned;
+  }
+
+  size_t hash() const { return std::hash<const std::string*>()(interned); }
+
+private:
+  // The value in the table, which lives for the rest of the process.
+  const std::string* interned;
+};
+
+
+inline std::ostream& operator<<(
+    std::ostream& stream,
+    const InternedString& value)
+{
+  return stream << value.value();
+}
+
+} // namespace mesos {
+
+namespace std {
+
+template <>
+struct hash<mesos::InternedString>
+{
+  typedef size_t result_type;
+
+  typedef mesos::InternedString argument_type;
+
+  result_type operator()(const argument_type& value) const
+  {
+    return value.hash();
+  }
+};
+
+} // namespace std {
+
+#endif // __INTERNED_HPP__
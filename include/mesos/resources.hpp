@@ -19,12 +19,14 @@
 
 #include <map>
 #include <iosfwd>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include <google/protobuf/repeated_field.h>
 
+#include <mesos/interned.hpp>
 #include <mesos/mesos.hpp>
 #include <mesos/type_utils.hpp>
 #include <mesos/values.hpp>
@@ -91,18 +93,20 @@ private:
   {
   public:
     /*implicit*/ Resource_(const Resource& _resource)
-      : resource(_resource),
+      : resource(std::make_shared<Resource>(_resource)),
         sharedCount(None())
     {
       // Setting the counter to 1 to denote "one copy" of the shared resource.
-      if (resource.has_shared()) {
+      if (resource->has_shared()) {
         sharedCount = 1;
       }
+
+      internKeys();
     }
 
     // By implicitly converting to Resource we are able to keep Resource_
     // logic internal and expose only the protobuf object.
-    operator const Resource&() const { return resource; }
+    operator const Resource&() const { return *resource; }
 
     // Check whether this Resource_ object corresponds to a shared resource.
     bool isShared() const { return sharedCount.isSome(); }
@@ -134,19 +138,49 @@ private:
     bool operator==(const Resource_& that) const;
     bool operator!=(const Resource_& that) const;
 
+    // Returns false if the resources differ in their names, reservation
+    // roles or allocation roles, i.e., if they are neither addable nor
+    // subtractable. This only compares the interned keys, so it is much
+    // cheaper than the full `addable()` and `subtractable()` checks.
+    bool hasSameKeys(const Resource_& that) const
+    {
+      return name == that.name &&
+             reservationRole == that.reservationRole &&
+             allocationRole == that.allocationRole;
+    }
+
     // Friend classes and functions for access to private members.
     friend class Resources;
     friend std::ostream& operator<<(
         std::ostream& stream, const Resource_& resource_);
 
   private:
-    // The protobuf Resource that is being managed.
-    Resource resource;
+    // Returns the wrapped `resource` for modification, after copying
+    // it if it is shared with other `Resource_` objects.
+    Resource* mutableResource();
+
+    // The protobuf Resource that is being managed. This is immutable
+    // and shared between copies of this `Resource_`, so that copying
+    // `Resources` doesn't copy the protobufs. A `Resource_` copies the
+    // protobuf on its first modification, see `mutableResource()`.
+    std::shared_ptr<const Resource> resource;
 
     // The counter for grouping shared 'resource' objects, None if the
     // 'resource' is non-shared. This is an int so as to support arithmetic
     // operations involving subtraction.
     Option<int> sharedCount;
+
+    // Interns the keys below, this needs to be called whenever the
+    // name, the reservations or the allocation info of the wrapped
+    // `resource` are changed.
+    void internKeys();
+
+    // The interned name of the `resource`, the role of its most refined
+    // reservation and the role it is allocated to. The roles are empty
+    // if the `resource` is unreserved or unallocated, respectively.
+    InternedString name;
+    InternedString reservationRole;
+    InternedString allocationRole;
   };
 
 public:
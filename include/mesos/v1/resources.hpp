@@ -25,6 +25,8 @@
 
 #include <google/protobuf/repeated_field.h>
 
+#include <mesos/interned.hpp>
+
 #include <mesos/v1/mesos.hpp>
 #include <mesos/v1/values.hpp>
 
@@ -98,6 +100,8 @@ private:
       if (resource.has_shared()) {
         sharedCount = 1;
       }
+
+      internKeys();
     }
 
     // By implicitly converting to Resource we are able to keep Resource_
@@ -134,6 +138,17 @@ private:
     bool operator==(const Resource_& that) const;
     bool operator!=(const Resource_& that) const;
 
+    // Returns false if the resources differ in their names, reservation
+    // roles or allocation roles, i.e., if they are neither addable nor
+    // subtractable. This only compares the interned keys, so it is much
+    // cheaper than the full `addable()` and `subtractable()` checks.
+    bool hasSameKeys(const Resource_& that) const
+    {
+      return name == that.name &&
+             reservationRole == that.reservationRole &&
+             allocationRole == that.allocationRole;
+    }
+
     // Friend classes and functions for access to private members.
     friend class Resources;
     friend std::ostream& operator<<(
@@ -147,6 +162,18 @@ private:
     // 'resource' is non-shared. This is an int so as to support arithmetic
     // operations involving subtraction.
     Option<int> sharedCount;
+
+    // Interns the keys below, this needs to be called whenever the
+    // name, the reservations or the allocation info of the wrapped
+    // `resource` are changed.
+    void internKeys();
+
+    // The interned name of the `resource`, the role of its most refined
+    // reservation and the role it is allocated to. The roles are empty
+    // if the `resource` is unreserved or unallocated, respectively.
+    InternedString name;
+    InternedString reservationRole;
+    InternedString allocationRole;
   };
 
 public:
@@ -0,0 +1,74 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <mesos/interned.hpp>
+
+#include <stout/synchronized.hpp>
+
+using std::string;
+
+namespace mesos {
+
+static const string* intern(const string& value)
+{
+  // NOTE: These are intentionally leaked so that handles stay valid
+  // during static destruction. Elements of an `unordered_set` are
+  // never moved, hence we can hand out pointers to them.
+  static std::mutex* mutex = new std::mutex();
+  static std::unordered_set<string>* table = new std::unordered_set<string>();
+
+  // Since the set of interned values is small and mostly the same
+  // values are interned over and over again, each thread caches its
+  // lookups so that threads don't contend on the table's lock.
+  static thread_local std::unordered_map<string, const string*> cache;
+
+  auto it = cache.find(value);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  const string* result;
+
+  synchronized (mutex) {
+    result = &*table->insert(value).first;
+  }
+
+  cache.emplace(value, result);
+
+  return result;
+}
+
+
+InternedString::InternedString()
+{
+  static const string* empty = intern("");
+  interned = empty;
+}
+
+
+InternedString::InternedString(const std::string& value)
+  : interned(intern(value)) {}
+
+
+InternedString::InternedString(const char* value)
+  : interned(intern(value)) {}
+
+} // namespace mesos {
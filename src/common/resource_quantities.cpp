@@ -0,0 +1,280 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <mesos/values.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+
+#include "common/resource_quantities.hpp"
+
+using std::ostream;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+
+// NOTE: These mirror the conversions in `common/values.cpp`, so that
+// the quantities behave exactly like `Value::Scalar` arithmetic.
+static int64_t convertToFixed(double floatValue)
+{
+  return std::llround(floatValue * 1000);
+}
+
+
+static double convertToFloating(int64_t fixedValue)
+{
+  double quotient = static_cast<double>(fixedValue / 1000);
+  double remainder = static_cast<double>(fixedValue % 1000) / 1000.0;
+
+  return quotient + remainder;
+}
+
+
+// Used to find a quantity by its name with `std::lower_bound`.
+static bool lessName(
+    const ResourceQuantities::Quantity& quantity,
+    const InternedString& name)
+{
+  return InternedString::HandleLess()(quantity.first, name);
+}
+
+
+ResourceQuantities ResourceQuantities::fromScalarResources(
+    const Resources& resources)
+{
+  ResourceQuantities result;
+
+  foreach (const Resource& resource, resources) {
+    if (resource.type() != Value::SCALAR) {
+      continue;
+    }
+
+    const int64_t value = convertToFixed(resource.scalar().value());
+
+    if (value <= 0) {
+      continue;
+    }
+
+    const InternedString name(resource.name());
+
+    auto it = std::lower_bound(
+        result.quantities.begin(),
+        result.quantities.end(),
+        name,
+        lessName);
+
+    if (it != result.quantities.end() && it->first == name) {
+      it->second += value;
+    } else {
+      result.quantities.insert(it, Quantity(name, value));
+    }
+  }
+
+  return result;
+}
+
+
+Try<ResourceQuantities> ResourceQuantities::fromString(const string& text)
+{
+  Try<Resources> resources = Resources::parse(text);
+  if (resources.isError()) {
+    return Error(resources.error());
+  }
+
+  foreach (const Resource& resource, resources.get()) {
+    if (resource.type() != Value::SCALAR) {
+      return Error(
+          "Expected only scalar resources but found '" +
+          resource.name() + "'");
+    }
+  }
+
+  return fromScalarResources(resources.get());
+}
+
+
+Value::Scalar ResourceQuantities::get(const string& _name) const
+{
+  Value::Scalar scalar;
+  scalar.set_value(0);
+
+  const InternedString name(_name);
+
+  auto it = std::lower_bound(
+      quantities.begin(), quantities.end(), name, lessName);
+
+  if (it != quantities.end() && it->first == name) {
+    scalar.set_value(convertToFloating(it->second));
+  }
+
+  return scalar;
+}
+
+
+bool ResourceQuantities::contains(const ResourceQuantities& that) const
+{
+  // Both collections are sorted by name, so we walk them in lockstep.
+  InternedString::HandleLess less;
+  const_iterator it = quantities.begin();
+
+  foreach (const Quantity& quantity, that.quantities) {
+    while (it != quantities.end() && less(it->first, quantity.first)) {
+      ++it;
+    }
+
+    if (it == quantities.end() ||
+        it->first != quantity.first ||
+        it->second < quantity.second) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+bool ResourceQuantities::operator==(const ResourceQuantities& that) const
+{
+  return quantities == that.quantities;
+}
+
+
+bool ResourceQuantities::operator!=(const ResourceQuantities& that) const
+{
+  return !(*this == that);
+}
+
+
+ResourceQuantities ResourceQuantities::operator+(
+    const ResourceQuantities& that) const
+{
+  ResourceQuantities result = *this;
+  result += that;
+  return result;
+}
+
+
+ResourceQuantities ResourceQuantities::operator-(
+    const ResourceQuantities& that) const
+{
+  ResourceQuantities result = *this;
+  result -= that;
+  return result;
+}
+
+
+ResourceQuantities& ResourceQuantities::operator+=(
+    const ResourceQuantities& that)
+{
+  InternedString::HandleLess less;
+
+  vector<Quantity> result;
+  result.reserve(quantities.size() + that.quantities.size());
+
+  const_iterator left = quantities.begin();
+  const_iterator right = that.quantities.begin();
+
+  while (left != quantities.end() || right != that.quantities.end()) {
+    if (right == that.quantities.end() ||
+        (left != quantities.end() && less(left->first, right->first))) {
+      result.push_back(*left++);
+    } else if (left == quantities.end() || less(right->first, left->first)) {
+      result.push_back(*right++);
+    } else {
+      result.push_back(Quantity(left->first, left->second + right->second));
+      ++left;
+      ++right;
+    }
+  }
+
+  quantities = std::move(result);
+
+  return *this;
+}
+
+
+ResourceQuantities& ResourceQuantities::operator-=(
+    const ResourceQuantities& that)
+{
+  InternedString::HandleLess less;
+  auto it = quantities.begin();
+
+  foreach (const Quantity& quantity, that.quantities) {
+    while (it != quantities.end() && less(it->first, quantity.first)) {
+      ++it;
+    }
+
+    if (it == quantities.end()) {
+      break;
+    }
+
+    if (it->first == quantity.first) {
+      it->second -= quantity.second;
+
+      // Quantities are never negative, see `Resources::subtract()`.
+      if (it->second <= 0) {
+        it = quantities.erase(it);
+      }
+    }
+  }
+
+  return *this;
+}
+
+
+ostream& operator<<(ostream& stream, const ResourceQuantities& quantities)
+{
+  // The quantities are not sorted by the values of their names, but
+  // we want a stable output.
+  vector<ResourceQuantities::Quantity> sorted(
+      quantities.begin(), quantities.end());
+
+  std::sort(
+      sorted.begin(),
+      sorted.end(),
+      [](const ResourceQuantities::Quantity& left,
+         const ResourceQuantities::Quantity& right) {
+        return left.first.value() < right.first.value();
+      });
+
+  bool first = true;
+
+  foreach (const ResourceQuantities::Quantity& quantity, sorted) {
+    if (!first) {
+      stream << "; ";
+    }
+
+    first = false;
+
+    Value::Scalar scalar;
+    scalar.set_value(convertToFloating(quantity.second));
+
+    stream << quantity.first << ":" << scalar;
+  }
+
+  return stream;
+}
+
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __COMMON_RESOURCE_QUANTITIES_HPP__
+#define __COMMON_RESOURCE_QUANTITIES_HPP__
+
+#include <stdint.h>
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mesos/interned.hpp>
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+
+// An efficient collection of scalar resource quantities, e.g., the
+// total or allocated scalar resources of a role. This is meant for the
+// scalar arithmetic in the allocator, where `Resources` is expensive
+// since every operation compares the full `Resource` protobufs.
+//
+// Only the name and the value of each resource are kept, i.e., all
+// metadata (reservations, disk infos, sharedness, allocation info, ...)
+// is dropped and "cpus(role):4" has the same quantity as "cpus:4".
+//
+// The quantities are kept in a vector sorted by their interned names
+// (in the arbitrary order of `InternedString::HandleLess`, NOT by the
+// values of the names), and the values are kept in the fixed point
+// representation that is also used for `Value::Scalar` arithmetic (see
+// `common/values.cpp`), i.e., as an integer number of thousandths.
+// Hence none of the operations involve protobufs or comparing strings,
+// and the results are the same as with `Value::Scalar`.
+//
+// NOTE: Like with `Resources`, quantities are never negative: when
+// subtracting more than is available the result is zero, and zero
+// quantities are not kept.
+class ResourceQuantities
+{
+public:
+  // Name and value (in thousandths) of a quantity.
+  typedef std::pair<InternedString, int64_t> Quantity;
+
+  typedef std::vector<Quantity>::const_iterator const_iterator;
+
+  // Returns the quantities of the scalar resources in `resources`.
+  static ResourceQuantities fromScalarResources(const Resources& resources);
+
+  // Parses a string like "cpus:4;mem:1024", see `Resources::parse()`.
+  // Returns an error if any of the resources is not a scalar.
+  static Try<ResourceQuantities> fromString(const std::string& text);
+
+  ResourceQuantities() {}
+
+  bool empty() const { return quantities.empty(); }
+
+  size_t size() const { return quantities.size(); }
+
+  // Returns the quantity of the resource with the given name, which
+  // is zero if there is none.
+  Value::Scalar get(const std::string& name) const;
+
+  // Returns true if each quantity in `that` is less than or equal to
+  // the quantity of the same resource in this collection.
+  bool contains(const ResourceQuantities& that) const;
+
+  bool operator==(const ResourceQuantities& that) const;
+  bool operator!=(const ResourceQuantities& that) const;
+
+  ResourceQuantities operator+(const ResourceQuantities& that) const;
+  ResourceQuantities operator-(const ResourceQuantities& that) const;
+
+  ResourceQuantities& operator+=(const ResourceQuantities& that);
+  ResourceQuantities& operator-=(const ResourceQuantities& that);
+
+  // Iterates over the quantities in the order of their interned names,
+  // see `InternedString::HandleLess`.
+  const_iterator begin() const { return quantities.begin(); }
+  const_iterator end() const { return quantities.end(); }
+
+private:
+  std::vector<Quantity> quantities;
+};
+
+
+std::ostream& operator<<(
+    std::ostream& stream,
+    const ResourceQuantities& quantities);
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __COMMON_RESOURCE_QUANTITIES_HPP__
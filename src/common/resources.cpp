@@ -16,6 +16,8 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
 #include <ostream>
 #include <set>
 #include <string>
@@ -1289,7 +1291,7 @@ Option<Error> Resources::Resource_::validate() const
     return Error("Invalid shared resource: count < 0");
   }
 
-  return Resources::validate(resource);
+  return Resources::validate(*resource);
 }
 
 
@@ -1299,7 +1301,7 @@ bool Resources::Resource_::isEmpty() const
     return true;
   }
 
-  return Resources::isEmpty(resource);
+  return Resources::isEmpty(*resource);
 }
 
 
@@ -1310,16 +1312,20 @@ bool Resources::Resource_::contains(const Resource_& that) const
     return false;
   }
 
+  if (!hasSameKeys(that)) {
+    return false;
+  }
+
   // Assuming the wrapped Resource objects are equal, the 'contains'
   // relationship is determined by the relationship of the counters
   // for shared resources.
   if (isShared()) {
     return sharedCount.get() >= that.sharedCount.get() &&
-           resource == that.resource;
+           *resource == *that.resource;
   }
 
   // For non-shared resources just compare the protobufs.
-  return internal::contains(resource, that.resource);
+  return internal::contains(*resource, *that.resource);
 }
 
 
@@ -1328,7 +1334,7 @@ Resources::Resource_& Resources::Resource_::operator+=(const Resource_& that)
   // This function assumes that the 'resource' fields are addable.
 
   if (!isShared()) {
-    resource += that.resource;
+    *mutableResource() += *that.resource;
   } else {
     // 'addable' makes sure both 'resource' fields are shared and
     // equal, so we just need to sum up the counters here.
@@ -1347,7 +1353,7 @@ Resources::Resource_& Resources::Resource_::operator-=(const Resource_& that)
   // This function assumes that the 'resource' fields are subtractable.
 
   if (!isShared()) {
-    resource -= that.resource;
+    *mutableResource() -= *that.resource;
   } else {
     // 'subtractable' makes sure both 'resource' fields are shared and
     // equal, so we just need to subtract the counters here.
@@ -1373,7 +1379,7 @@ bool Resources::Resource_::operator==(const Resource_& that) const
     return false;
   }
 
-  return resource == that.resource;
+  return *resource == *that.resource;
 }
 
 
@@ -1383,6 +1389,39 @@ bool Resources::Resource_::operator!=(const Resource_& that) const
 }
 
 
+Resource* Resources::Resource_::mutableResource()
+{
+  // NOTE: Since the protobuf can only be shared via copies of this
+  // `Resource_`, nobody else can take a new reference concurrently
+  // once the use count is 1, i.e., it is safe to modify it in place.
+  // The fence ensures that we don't race with reads of the protobuf
+  // by other threads that have just dropped their references.
+  if (resource.use_count() > 1) {
+    resource = std::make_shared<Resource>(*resource);
+  } else {
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+
+  // The protobuf is only `const` to prevent accidental modification
+  // while it is shared, it was never created as a `const` object.
+  return const_cast<Resource*>(resource.get());
+}
+
+
+void Resources::Resource_::internKeys()
+{
+  name = InternedString(resource->name());
+
+  reservationRole = resource->reservations_size() > 0
+    ? InternedString(resource->reservations().rbegin()->role())
+    : InternedString();
+
+  allocationRole = resource->has_allocation_info()
+    ? InternedString(resource->allocation_info().role())
+    : InternedString();
+}
+
+
 Resources::Resources(const Resource& resource)
 {
   // NOTE: Invalid and zero Resource object will be ignored.
@@ -1422,7 +1461,7 @@ bool Resources::contains(const Resources& that) const
       return false;
     }
 
-    if (isPersistentVolume(resource_.resource)) {
+    if (isPersistentVolume(*resource_.resource)) {
       remaining.subtract(resource_);
     }
   }
@@ -1443,7 +1482,7 @@ bool Resources::contains(const Resource& that) const
 size_t Resources::count(const Resource& that) const
 {
   foreach (const Resource_& resource_, resources) {
-    if (resource_.resource == that) {
+    if (*resource_.resource == that) {
       // Return 1 for non-shared resources because non-shared
       // Resource objects in Resources are unique.
       return resource_.isShared() ? resource_.sharedCount.get() : 1;
@@ -1456,8 +1495,11 @@ size_t Resources::count(const Resource& that) const
 
 void Resources::allocate(const string& role)
 {
+  const InternedString allocationRole(role);
+
   foreach (Resource_& resource_, resources) {
-    resource_.resource.mutable_allocation_info()->set_role(role);
+    resource_.mutableResource()->mutable_allocation_info()->set_role(role);
+    resource_.allocationRole = allocationRole;
   }
 }
 
@@ -1465,8 +1507,9 @@ void Resources::allocate(const string& role)
 void Resources::unallocate()
 {
   foreach (Resource_& resource_, resources) {
-    if (resource_.resource.has_allocation_info()) {
-      resource_.resource.clear_allocation_info();
+    if (resource_.resource->has_allocation_info()) {
+      resource_.mutableResource()->clear_allocation_info();
+      resource_.allocationRole = InternedString();
     }
   }
 }
@@ -1477,7 +1520,7 @@ Resources Resources::filter(
 {
   Resources result;
   foreach (const Resource_& resource_, resources) {
-    if (predicate(resource_.resource)) {
+    if (predicate(*resource_.resource)) {
       result.add(resource_);
     }
   }
@@ -1490,8 +1533,8 @@ hashmap<string, Resources> Resources::reservations() const
   hashmap<string, Resources> result;
 
   foreach (const Resource_& resource_, resources) {
-    if (isReserved(resource_.resource)) {
-      result[reservationRole(resource_.resource)].add(resource_);
+    if (isReserved(*resource_.resource)) {
+      result[reservationRole(*resource_.resource)].add(resource_);
     }
   }
 
@@ -1556,9 +1599,9 @@ hashmap<string, Resources> Resources::allocations() const
   foreach (const Resource_& resource_, resources) {
     // We require that this is called only when
     // the resources are allocated.
-    CHECK(resource_.resource.has_allocation_info());
-    CHECK(resource_.resource.allocation_info().has_role());
-    result[resource_.resource.allocation_info().role()].add(resource_);
+    CHECK(resource_.resource->has_allocation_info());
+    CHECK(resource_.resource->allocation_info().has_role());
+    result[resource_.resource->allocation_info().role()].add(resource_);
   }
 
   return result;
@@ -1571,8 +1614,9 @@ Resources Resources::pushReservation(
   Resources result;
 
   foreach (Resource_ resource_, *this) {
-    resource_.resource.add_reservations()->CopyFrom(reservation);
-    CHECK_NONE(Resources::validate(resource_.resource));
+    resource_.mutableResource()->add_reservations()->CopyFrom(reservation);
+    CHECK_NONE(Resources::validate(*resource_.resource));
+    resource_.internKeys();
     result.add(resource_);
   }
 
@@ -1585,8 +1629,9 @@ Resources Resources::popReservation() const
   Resources result;
 
   foreach (Resource_ resource_, resources) {
-    CHECK_GT(resource_.resource.reservations_size(), 0);
-    resource_.resource.mutable_reservations()->RemoveLast();
+    CHECK_GT(resource_.resource->reservations_size(), 0);
+    resource_.mutableResource()->mutable_reservations()->RemoveLast();
+    resource_.internKeys();
     result.add(resource_);
   }
 
@@ -1599,7 +1644,8 @@ Resources Resources::toUnreserved() const
   Resources result;
 
   foreach (Resource_ resource_, *this) {
-    resource_.resource.clear_reservations();
+    resource_.mutableResource()->clear_reservations();
+    resource_.reservationRole = InternedString();
     result.add(resource_);
   }
 
@@ -1864,8 +1910,8 @@ Option<Value::Ranges> Resources::ephemeral_ports() const
 Option<Resource> Resources::match(const Resource& resource) const
 {
   foreach (const Resource_& resource_, resources) {
-    if (compareResourceMetadata(resource_.resource, resource)) {
-      return resource_.resource;
+    if (compareResourceMetadata(*resource_.resource, resource)) {
+      return *resource_.resource;
     }
   }
 
@@ -1908,14 +1954,15 @@ Option<Resources> Resources::find(const Resource& target) const
   foreach (const auto& predicate, predicates) {
     foreach (const Resource_& resource_, total.filter(predicate)) {
       // Need to `toUnreserved` to ignore the roles in contains().
-      Resources unreserved = Resources(resource_.resource).toUnreserved();
+      Resources unreserved = Resources(*resource_.resource).toUnreserved();
 
       if (unreserved.contains(remaining)) {
         // The target has been found, return the result.
         foreach (Resource_ r, remaining) {
-          r.resource.mutable_reservations()->CopyFrom(
-              resource_.resource.reservations());
+          r.mutableResource()->mutable_reservations()->CopyFrom(
+              resource_.resource->reservations());
 
+          r.internKeys();
           found.add(r);
         }
 
@@ -1992,7 +2039,10 @@ void Resources::add(const Resource_& that)
 
   bool found = false;
   foreach (Resource_& resource_, resources) {
-    if (internal::addable(resource_.resource, that)) {
+    // Comparing the interned keys first rules out most resources
+    // without having to compare the protobufs.
+    if (resource_.hasSameKeys(that) &&
+        internal::addable(*resource_.resource, that)) {
       resource_ += that;
       found = true;
       break;
@@ -2067,7 +2117,8 @@ void Resources::subtract(const Resource_& that)
   for (size_t i = 0; i < resources.size(); i++) {
     Resource_& resource_ = resources[i];
 
-    if (internal::subtractable(resource_.resource, that)) {
+    if (resource_.hasSameKeys(that) &&
+        internal::subtractable(*resource_.resource, that)) {
       resource_ -= that;
 
       // Remove the resource if it has become negative or empty.
@@ -2081,8 +2132,8 @@ void Resources::subtract(const Resource_& that)
       // a negative scalar value.
       bool negative =
         (resource_.isShared() && resource_.sharedCount.get() < 0) ||
-        (resource_.resource.type() == Value::SCALAR &&
-         resource_.resource.scalar().value() < 0);
+        (resource_.resource->type() == Value::SCALAR &&
+         resource_.resource->scalar().value() < 0);
 
       if (negative || resource_.isEmpty()) {
         // As `resources` is not ordered, and erasing an element
@@ -2299,7 +2350,7 @@ ostream& operator<<(ostream& stream, const Resource& resource)
 
 ostream& operator<<(ostream& stream, const Resources::Resource_& resource_)
 {
-  stream << resource_.resource;
+  stream << *resource_.resource;
   if (resource_.isShared()) {
     stream << "<" << resource_.sharedCount.get() << ">";
   }
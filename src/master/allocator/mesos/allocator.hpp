@@ -23,9 +23,13 @@
 #include <process/future.hpp>
 #include <process/process.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
+#include "master/allocator/recorder.hpp"
+
 namespace mesos {
 namespace internal {
 namespace master {
@@ -33,6 +37,26 @@ namespace allocator {
 
 class MesosAllocatorProcess;
 
+
+// Options of the built-in allocators that are given when creating the
+// allocator, rather than through `Allocator::initialize`, so that the
+// interface implemented by allocator modules stays the same.
+struct AllocatorOptions
+{
+  // The number of threads a batch allocation may use, see the
+  // `--allocation_threads` master flag.
+  size_t allocationThreads = 1;
+
+  // If set, batch allocations in between full sweeps of all agents
+  // only consider what changed, see the `--allocation_sweep_interval`
+  // master flag.
+  Option<Duration> allocationSweepInterval;
+
+  // If set, the calls to the allocator are recorded to this path as
+  // an allocator trace.
+  Option<std::string> tracePath;
+};
+
 // A wrapper for Process-based allocators. It redirects all function
 // invocations to the underlying AllocatorProcess and manages its
 // lifetime. We ensure the template parameter AllocatorProcess
@@ -42,7 +66,8 @@ class MesosAllocator : public mesos::allocator::Allocator
 {
 public:
   // Factory to allow for typed tests.
-  static Try<mesos::allocator::Allocator*> create();
+  static Try<mesos::allocator::Allocator*> create(
+      const AllocatorOptions& options = AllocatorOptions());
 
   ~MesosAllocator();
 
@@ -172,11 +197,16 @@ public:
       const std::vector<WeightInfo>& weightInfos);
 
 private:
-  MesosAllocator();
+  MesosAllocator(const AllocatorOptions& _options, Recorder* _recorder);
   MesosAllocator(const MesosAllocator&); // Not copyable.
   MesosAllocator& operator=(const MesosAllocator&); // Not assignable.
 
   MesosAllocatorProcess* process;
+
+  const AllocatorOptions options;
+
+  // Records the calls to the allocator, if requested (owned).
+  Recorder* recorder;
 };
 
 
@@ -205,7 +235,9 @@ public:
       const Option<std::set<std::string>>&
         fairnessExcludeResourceNames = None(),
       bool filterGpuResources = true,
-      const Option<DomainInfo>& domain = None()) = 0;
+      const Option<DomainInfo>& domain = None(),
+      size_t allocationThreads = 1,
+      const Option<Duration>& allocationSweepInterval = None()) = 0;
 
   virtual void recover(
       const int expectedAgentCount,
@@ -322,16 +354,31 @@ public:
 
 template <typename AllocatorProcess>
 Try<mesos::allocator::Allocator*>
-MesosAllocator<AllocatorProcess>::create()
+MesosAllocator<AllocatorProcess>::create(const AllocatorOptions& options)
 {
+  Recorder* recorder = nullptr;
+
+  if (options.tracePath.isSome()) {
+    Try<Recorder*> create = Recorder::create(options.tracePath.get());
+    if (create.isError()) {
+      return Error("Failed to record the allocator calls: " + create.error());
+    }
+
+    recorder = create.get();
+  }
+
   mesos::allocator::Allocator* allocator =
-    new MesosAllocator<AllocatorProcess>();
+    new MesosAllocator<AllocatorProcess>(options, recorder);
   return CHECK_NOTNULL(allocator);
 }
 
 
 template <typename AllocatorProcess>
-MesosAllocator<AllocatorProcess>::MesosAllocator()
+MesosAllocator<AllocatorProcess>::MesosAllocator(
+    const AllocatorOptions& _options,
+    Recorder* _recorder)
+  : options(_options),
+    recorder(_recorder)
 {
   process = new AllocatorProcess();
   process::spawn(process);
@@ -344,6 +391,8 @@ MesosAllocator<AllocatorProcess>::~MesosAllocator()
   process::terminate(process);
   process::wait(process);
   delete process;
+
+  delete recorder;
 }
 
 
@@ -362,6 +411,16 @@ inline void MesosAllocator<AllocatorProcess>::initialize(
     bool filterGpuResources,
     const Option<DomainInfo>& domain)
 {
+  if (recorder != nullptr) {
+    recorder->initialize(
+        allocationInterval,
+        fairnessExcludeResourceNames,
+        filterGpuResources,
+        domain,
+        options.allocationThreads,
+        options.allocationSweepInterval);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::initialize,
@@ -370,7 +429,9 @@ inline void MesosAllocator<AllocatorProcess>::initialize(
       inverseOfferCallback,
       fairnessExcludeResourceNames,
       filterGpuResources,
-      domain);
+      domain,
+      options.allocationThreads,
+      options.allocationSweepInterval);
 }
 
 
@@ -379,6 +440,10 @@ inline void MesosAllocator<AllocatorProcess>::recover(
     const int expectedAgentCount,
     const hashmap<std::string, Quota>& quotas)
 {
+  if (recorder != nullptr) {
+    recorder->recover(expectedAgentCount, quotas);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::recover,
@@ -395,6 +460,11 @@ inline void MesosAllocator<AllocatorProcess>::addFramework(
     bool active,
     const std::set<std::string>& suppressedRoles)
 {
+  if (recorder != nullptr) {
+    recorder->addFramework(
+        frameworkId, frameworkInfo, used, active, suppressedRoles);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::addFramework,
@@ -410,6 +480,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::removeFramework(
     const FrameworkID& frameworkId)
 {
+  if (recorder != nullptr) {
+    recorder->removeFramework(frameworkId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::removeFramework,
@@ -421,6 +495,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::activateFramework(
     const FrameworkID& frameworkId)
 {
+  if (recorder != nullptr) {
+    recorder->activateFramework(frameworkId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::activateFramework,
@@ -432,6 +510,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::deactivateFramework(
     const FrameworkID& frameworkId)
 {
+  if (recorder != nullptr) {
+    recorder->deactivateFramework(frameworkId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::deactivateFramework,
@@ -445,6 +527,10 @@ inline void MesosAllocator<AllocatorProcess>::updateFramework(
     const FrameworkInfo& frameworkInfo,
     const std::set<std::string>& suppressedRoles)
 {
+  if (recorder != nullptr) {
+    recorder->updateFramework(frameworkId, frameworkInfo, suppressedRoles);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::updateFramework,
@@ -463,6 +549,11 @@ inline void MesosAllocator<AllocatorProcess>::addSlave(
     const Resources& total,
     const hashmap<FrameworkID, Resources>& used)
 {
+  if (recorder != nullptr) {
+    recorder->addSlave(
+        slaveId, slaveInfo, capabilities, unavailability, total, used);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::addSlave,
@@ -479,6 +570,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::removeSlave(
     const SlaveID& slaveId)
 {
+  if (recorder != nullptr) {
+    recorder->removeSlave(slaveId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::removeSlave,
@@ -493,6 +588,10 @@ inline void MesosAllocator<AllocatorProcess>::updateSlave(
     const Option<Resources>& total,
     const Option<std::vector<SlaveInfo::Capability>>& capabilities)
 {
+  if (recorder != nullptr) {
+    recorder->updateSlave(slaveId, slaveInfo, total, capabilities);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::updateSlave,
@@ -508,6 +607,10 @@ void MesosAllocator<AllocatorProcess>::addResourceProvider(
     const Resources& total,
     const hashmap<FrameworkID, Resources>& used)
 {
+  if (recorder != nullptr) {
+    recorder->addResourceProvider(slave, total, used);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::addResourceProvider,
@@ -521,6 +624,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::activateSlave(
     const SlaveID& slaveId)
 {
+  if (recorder != nullptr) {
+    recorder->activateSlave(slaveId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::activateSlave,
@@ -532,6 +639,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::deactivateSlave(
     const SlaveID& slaveId)
 {
+  if (recorder != nullptr) {
+    recorder->deactivateSlave(slaveId);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::deactivateSlave,
@@ -543,6 +654,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::updateWhitelist(
     const Option<hashset<std::string>>& whitelist)
 {
+  if (recorder != nullptr) {
+    recorder->updateWhitelist(whitelist);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::updateWhitelist,
@@ -570,6 +685,11 @@ inline void MesosAllocator<AllocatorProcess>::updateAllocation(
     const Resources& offeredResources,
     const std::vector<ResourceConversion>& conversions)
 {
+  if (recorder != nullptr) {
+    recorder->updateAllocation(
+        frameworkId, slaveId, offeredResources, conversions);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::updateAllocation,
@@ -586,6 +706,10 @@ MesosAllocator<AllocatorProcess>::updateAvailable(
     const SlaveID& slaveId,
     const std::vector<Offer::Operation>& operations)
 {
+  if (recorder != nullptr) {
+    recorder->updateAvailable(slaveId, operations);
+  }
+
   return process::dispatch(
       process,
       &MesosAllocatorProcess::updateAvailable,
@@ -599,6 +723,10 @@ inline void MesosAllocator<AllocatorProcess>::updateUnavailability(
     const SlaveID& slaveId,
     const Option<Unavailability>& unavailability)
 {
+  if (recorder != nullptr) {
+    recorder->updateUnavailability(slaveId, unavailability);
+  }
+
   return process::dispatch(
       process,
       &MesosAllocatorProcess::updateUnavailability,
@@ -645,6 +773,10 @@ inline void MesosAllocator<AllocatorProcess>::recoverResources(
     const Resources& resources,
     const Option<Filters>& filters)
 {
+  if (recorder != nullptr) {
+    recorder->recoverResources(frameworkId, slaveId, resources, filters);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::recoverResources,
@@ -660,6 +792,10 @@ inline void MesosAllocator<AllocatorProcess>::suppressOffers(
     const FrameworkID& frameworkId,
     const std::set<std::string>& roles)
 {
+  if (recorder != nullptr) {
+    recorder->suppressOffers(frameworkId, roles);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::suppressOffers,
@@ -673,6 +809,10 @@ inline void MesosAllocator<AllocatorProcess>::reviveOffers(
     const FrameworkID& frameworkId,
     const std::set<std::string>& roles)
 {
+  if (recorder != nullptr) {
+    recorder->reviveOffers(frameworkId, roles);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::reviveOffers,
@@ -686,6 +826,10 @@ inline void MesosAllocator<AllocatorProcess>::setQuota(
     const std::string& role,
     const Quota& quota)
 {
+  if (recorder != nullptr) {
+    recorder->setQuota(role, quota);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::setQuota,
@@ -698,6 +842,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::removeQuota(
     const std::string& role)
 {
+  if (recorder != nullptr) {
+    recorder->removeQuota(role);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::removeQuota,
@@ -709,6 +857,10 @@ template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::updateWeights(
     const std::vector<WeightInfo>& weightInfos)
 {
+  if (recorder != nullptr) {
+    recorder->updateWeights(weightInfos);
+  }
+
   process::dispatch(
       process,
       &MesosAllocatorProcess::updateWeights,
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -39,6 +40,7 @@
 #include <stout/set.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
+#include <stout/utils.hpp>
 
 #include "common/protobuf_utils.hpp"
 
@@ -72,17 +74,39 @@ class OfferFilter
 public:
   virtual ~OfferFilter() {}
 
-  virtual bool filter(const Resources& resources) const = 0;
+  // Returns true if the resources should be filtered. The `quantities`
+  // must be the scalar quantities of `resources`, they are passed in so
+  // that they only need to be computed once for all the filters that
+  // are checked against the same resources, see `isFiltered()`.
+  virtual bool filter(
+      const Resources& resources,
+      const ResourceQuantities& quantities) const = 0;
+
+  // Returns true if this filter filters all the resources filtered by
+  // `that` filter, at least until `that` filter expires. In that case
+  // `that` filter is redundant and does not need to be checked.
+  virtual bool subsumes(const OfferFilter& that) const = 0;
 };
 
 
 class RefusedOfferFilter : public OfferFilter
 {
 public:
-  RefusedOfferFilter(const Resources& _resources) : resources(_resources) {}
-
-  virtual bool filter(const Resources& _resources) const
+  RefusedOfferFilter(const Resources& _resources, const Timeout& _timeout)
+    : resources(_resources),
+      quantities(ResourceQuantities::fromScalarResources(_resources)),
+      timeout(_timeout) {}
+
+  virtual bool filter(
+      const Resources& _resources,
+      const ResourceQuantities& _quantities) const
   {
+    // Refused resources can only be a superset if their quantities
+    // are, this rules out most resources without comparing protobufs.
+    if (!quantities.contains(_quantities)) {
+      return false;
+    }
+
     // TODO(jieyu): Consider separating the superset check for regular
     // and revocable resources. For example, frameworks might want
     // more revocable resources only or non-revocable resources only,
@@ -91,8 +115,24 @@ public:
     return resources.contains(_resources); // Refused resources are superset.
   }
 
+  virtual bool subsumes(const OfferFilter& that) const
+  {
+    const RefusedOfferFilter* refused =
+      dynamic_cast<const RefusedOfferFilter*>(&that);
+
+    return refused != nullptr &&
+           refused->timeout <= timeout &&
+           filter(refused->resources, refused->quantities);
+  }
+
 private:
   const Resources resources;
+
+  // Scalar quantities of the refused `resources`.
+  const ResourceQuantities quantities;
+
+  // When the filter expires, see `HierarchicalAllocatorProcess::expire()`.
+  const Timeout timeout;
 };
 
 
@@ -143,6 +183,86 @@ HierarchicalAllocatorProcess::Framework::Framework(
     active(_active) {}
 
 
+AllocationWorkers::AllocationWorkers(size_t count)
+  : pending(0),
+    stopping(false)
+{
+  threads.reserve(count);
+
+  for (size_t i = 0; i < count; i++) {
+    threads.emplace_back(&AllocationWorkers::loop, this);
+  }
+}
+
+
+AllocationWorkers::~AllocationWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  available.notify_all();
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+}
+
+
+void AllocationWorkers::run(vector<std::function<void()>>&& _functions)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  foreach (std::function<void()>& function, _functions) {
+    functions.push_back(std::move(function));
+  }
+
+  pending += _functions.size();
+
+  available.notify_all();
+
+  // Rather than just waiting, the calling thread runs functions too.
+  while (!functions.empty()) {
+    std::function<void()> function = std::move(functions.front());
+    functions.pop_front();
+
+    lock.unlock();
+    function();
+    lock.lock();
+
+    pending--;
+  }
+
+  done.wait(lock, [this]() { return pending == 0; });
+}
+
+
+void AllocationWorkers::loop()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    available.wait(lock, [this]() { return stopping || !functions.empty(); });
+
+    if (functions.empty()) {
+      return;
+    }
+
+    std::function<void()> function = std::move(functions.front());
+    functions.pop_front();
+
+    lock.unlock();
+    function();
+    lock.lock();
+
+    if (--pending == 0) {
+      done.notify_all();
+    }
+  }
+}
+
+
 void HierarchicalAllocatorProcess::initialize(
     const Duration& _allocationInterval,
     const lambda::function<
@@ -155,7 +275,9 @@ void HierarchicalAllocatorProcess::initialize(
       _inverseOfferCallback,
     const Option<set<string>>& _fairnessExcludeResourceNames,
     bool _filterGpuResources,
-    const Option<DomainInfo>& _domain)
+    const Option<DomainInfo>& _domain,
+    size_t _allocationThreads,
+    const Option<Duration>& _allocationSweepInterval)
 {
   allocationInterval = _allocationInterval;
   offerCallback = _offerCallback;
@@ -163,9 +285,19 @@ void HierarchicalAllocatorProcess::initialize(
   fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
   filterGpuResources = _filterGpuResources;
   domain = _domain;
+  allocationThreads = _allocationThreads;
+  allocationSweepInterval = _allocationSweepInterval;
   initialized = true;
   paused = false;
 
+  if (allocationThreads > 1) {
+    workers.reset(new AllocationWorkers(allocationThreads - 1));
+  }
+
+  if (allocationSweepInterval.isSome()) {
+    allocationSweep = Timeout::in(allocationSweepInterval.get());
+  }
+
   // Resources for quota'ed roles are allocated separately and prior to
   // non-quota'ed roles, hence a dedicated sorter for quota'ed roles is
   // necessary.
@@ -183,7 +315,7 @@ void HierarchicalAllocatorProcess::initialize(
         return after(_allocationInterval);
       },
       [_self](const Nothing&) {
-        return dispatch(_self, &HierarchicalAllocatorProcess::allocate)
+        return dispatch(_self, &HierarchicalAllocatorProcess::allocateDirty)
           .then([]() -> ControlFlow<Nothing> { return Continue(); });
       });
 }
@@ -485,6 +617,10 @@ void HierarchicalAllocatorProcess::updateFramework(
   foreach (const string& role, addedRoles | newRevivedRoles) {
     CHECK(frameworkSorters.contains(role));
     frameworkSorters.at(role)->activate(frameworkId.value());
+
+    // Only the added and revived roles may be allocated additional
+    // resources.
+    markDirty(role);
   }
 
   framework.roles = newRoles;
@@ -575,6 +711,10 @@ void HierarchicalAllocatorProcess::addSlave(
             << " with " << slave.total
             << " (allocated: " << slave.allocated << ")";
 
+  // The agent is also marked dirty in case the allocation is skipped
+  // because the allocator is paused.
+  markDirty(slaveId);
+
   allocate(slaveId);
 }
 
@@ -600,6 +740,9 @@ void HierarchicalAllocatorProcess::removeSlave(
 
   slaves.erase(slaveId);
   allocationCandidates.erase(slaveId);
+  allocationCandidateRoles.erase(slaveId);
+  dirtySlaves.erase(slaveId);
+  dirtySlaveRoles.erase(slaveId);
 
   // Note that we DO NOT actually delete any filters associated with
   // this slave, that will occur when the delayed
@@ -671,6 +814,7 @@ void HierarchicalAllocatorProcess::updateSlave(
   }
 
   if (updated) {
+    markDirty(slaveId);
     allocate(slaveId);
   }
 }
@@ -709,6 +853,8 @@ void HierarchicalAllocatorProcess::addResourceProvider(
   updateSlaveTotal(slaveId, slave.total + total);
   slave.allocated += Resources::sum(used);
 
+  markDirty(slaveId);
+
   VLOG(1)
     << "Grew agent " << slaveId << " by "
     << total << " (total), "
@@ -751,6 +897,8 @@ void HierarchicalAllocatorProcess::activateSlave(
 
   slaves.at(slaveId).activated = true;
 
+  markDirty(slaveId);
+
   LOG(INFO) << "Agent " << slaveId << " reactivated";
 }
 
@@ -774,6 +922,8 @@ void HierarchicalAllocatorProcess::updateWhitelist(
 
   whitelist = _whitelist;
 
+  markDirty();
+
   if (whitelist.isSome()) {
     LOG(INFO) << "Updated agent whitelist: " << stringify(whitelist.get());
 
@@ -969,6 +1119,8 @@ Future<Nothing> HierarchicalAllocatorProcess::updateAvailable(
   // Update the total resources in the allocator and role and quota sorters.
   updateSlaveTotal(slaveId, updatedTotal.get());
 
+  markDirty(slaveId);
+
   return Nothing();
 }
 
@@ -1002,6 +1154,8 @@ void HierarchicalAllocatorProcess::updateUnavailability(
     slave.maintenance = Slave::Maintenance(unavailability.get());
   }
 
+  markDirty(slaveId);
+
   allocate(slaveId);
 }
 
@@ -1189,6 +1343,9 @@ void HierarchicalAllocatorProcess::recoverResources(
 
     slave.allocated -= resources;
 
+    // The recovered resources may be allocated to any role.
+    markDirty(slaveId);
+
     VLOG(1) << "Recovered " << resources
             << " (total: " << slave.total
             << ", allocated: " << slave.allocated << ")"
@@ -1239,15 +1396,6 @@ void HierarchicalAllocatorProcess::recoverResources(
             << " filtered agent " << slaveId
             << " for " << timeout.get();
 
-    // Create a new filter. Note that we unallocate the resources
-    // since filters are applied per-role already.
-    Resources unallocated = resources;
-    unallocated.unallocate();
-
-    OfferFilter* offerFilter = new RefusedOfferFilter(unallocated);
-    frameworks.at(frameworkId)
-      .offerFilters[role][slaveId].insert(offerFilter);
-
     // Expire the filter after both an `allocationInterval` and the
     // `timeout` have elapsed. This ensures that the filter does not
     // expire before we perform the next allocation for this agent,
@@ -1261,6 +1409,30 @@ void HierarchicalAllocatorProcess::recoverResources(
     // (MESOS-3078), we would not need to increase the timeout here.
     timeout = std::max(allocationInterval, timeout.get());
 
+    // Create a new filter. Note that we unallocate the resources
+    // since filters are applied per-role already.
+    Resources unallocated = resources;
+    unallocated.unallocate();
+
+    OfferFilter* offerFilter =
+      new RefusedOfferFilter(unallocated, Timeout::in(timeout.get()));
+
+    hashset<OfferFilter*>& agentFilters =
+      frameworks.at(frameworkId).offerFilters[role][slaveId];
+
+    // Frameworks that keep declining offers on an agent with long
+    // timeouts would otherwise accumulate filters that all need to
+    // be checked in `isFiltered()`. We remove the filters made
+    // redundant by the new filter, but like in `reviveOffers()` we
+    // only delete them once they expire.
+    foreach (OfferFilter* filter, utils::copy(agentFilters)) {
+      if (offerFilter->subsumes(*filter)) {
+        agentFilters.erase(filter);
+      }
+    }
+
+    agentFilters.insert(offerFilter);
+
     // We need to disambiguate the function call to pick the correct
     // `expire()` overload.
     void (Self::*expireOffer)(
@@ -1336,10 +1508,19 @@ void HierarchicalAllocatorProcess::reviveOffers(
   // would expire that filter too soon. Note that this only works
   // right now because ALL Filter types "expire".
 
+  // Only the revived roles may be allocated additional resources.
+  foreach (const string& role, roles) {
+    markDirty(role);
+  }
+
   LOG(INFO) << "Revived offers for roles " << stringify(roles)
             << " of framework " << frameworkId;
 
-  allocate();
+  if (allocationSweepInterval.isSome()) {
+    allocateDirty();
+  } else {
+    allocate();
+  }
 }
 
 
@@ -1377,6 +1558,9 @@ void HierarchicalAllocatorProcess::setQuota(
   LOG(INFO) << "Set quota " << quota.info.guarantee() << " for role '" << role
             << "'";
 
+  // Quota changes affect the headroom held back on all agents.
+  markDirty();
+
   // NOTE: Since quota changes do not result in rebalancing of
   // offered resources, we do not trigger an allocation here; the
   // quota change will be reflected in subsequent allocations.
@@ -1405,6 +1589,9 @@ void HierarchicalAllocatorProcess::removeQuota(
 
   metrics.removeQuota(role);
 
+  // Quota changes affect the headroom held back on all agents.
+  markDirty();
+
   // NOTE: Since quota changes do not result in rebalancing of
   // offered resources, we do not trigger an allocation here; the
   // quota change will be reflected in subsequent allocations.
@@ -1424,6 +1611,8 @@ void HierarchicalAllocatorProcess::updateWeights(
 
     quotaRoleSorter->updateWeight(weightInfo.role(), weightInfo.weight());
     roleSorter->updateWeight(weightInfo.role(), weightInfo.weight());
+
+    markDirty(weightInfo.role());
   }
 
   // NOTE: Since weight changes do not result in rebalancing of
@@ -1480,12 +1669,111 @@ Future<Nothing> HierarchicalAllocatorProcess::allocate(
 
   allocationCandidates |= slaveIds;
 
-  if (allocation.isNone() || !allocation->isPending()) {
+  if (!allocation.pending()) {
     metrics.allocation_run_latency.start();
-    allocation = dispatch(self(), &Self::_allocate);
   }
 
-  return allocation.get();
+  return dispatch(allocation, self(), &Self::_allocate);
+}
+
+
+Future<Nothing> HierarchicalAllocatorProcess::allocateDirty()
+{
+  if (paused) {
+    VLOG(2) << "Skipped allocation because the allocator is paused";
+
+    return Nothing();
+  }
+
+  if (allocationSweepInterval.isNone() || allocationSweep.expired()) {
+    if (allocationSweepInterval.isSome()) {
+      allocationSweep = Timeout::in(allocationSweepInterval.get());
+    }
+
+    dirtySlaves.clear();
+    dirtySlaveRoles.clear();
+
+    return allocate();
+  }
+
+  if (dirtySlaves.empty() && dirtySlaveRoles.empty()) {
+    VLOG(2) << "Skipped allocation because nothing changed";
+
+    return Nothing();
+  }
+
+  foreachpair (const SlaveID& slaveId,
+               const hashset<string>& roles_,
+               dirtySlaveRoles) {
+    if (!dirtySlaves.contains(slaveId)) {
+      allocationCandidateRoles[slaveId] |= roles_;
+    }
+  }
+
+  hashset<SlaveID> slaveIds = std::move(dirtySlaves);
+
+  dirtySlaves.clear();
+  dirtySlaveRoles.clear();
+
+  return allocate(slaveIds);
+}
+
+
+void HierarchicalAllocatorProcess::markDirty()
+{
+  // Without a sweep interval all agents are considered by every
+  // periodic allocation, hence there is no need to track anything.
+  if (allocationSweepInterval.isNone()) {
+    return;
+  }
+
+  dirtySlaves = slaves.keys();
+  dirtySlaveRoles.clear();
+}
+
+
+void HierarchicalAllocatorProcess::markDirty(const SlaveID& slaveId)
+{
+  if (allocationSweepInterval.isSome() && slaves.contains(slaveId)) {
+    dirtySlaves.insert(slaveId);
+    dirtySlaveRoles.erase(slaveId);
+  }
+}
+
+
+void HierarchicalAllocatorProcess::markDirty(const string& role)
+{
+  if (allocationSweepInterval.isNone()) {
+    return;
+  }
+
+  foreachkey (const SlaveID& slaveId, slaves) {
+    markDirty(slaveId, role);
+  }
+}
+
+
+void HierarchicalAllocatorProcess::markDirty(
+    const SlaveID& slaveId,
+    const string& role)
+{
+  if (allocationSweepInterval.isSome() &&
+      slaves.contains(slaveId) &&
+      !dirtySlaves.contains(slaveId)) {
+    dirtySlaveRoles[slaveId].insert(role);
+  }
+}
+
+
+Option<hashset<string>> HierarchicalAllocatorProcess::candidateRoles(
+    const SlaveID& slaveId) const
+{
+  if (allocationCandidates.contains(slaveId) ||
+      !allocationCandidateRoles.contains(slaveId)) {
+    return None();
+  }
+
+  return allocationCandidateRoles.at(slaveId);
 }
 
 
@@ -1515,10 +1803,12 @@ Nothing HierarchicalAllocatorProcess::_allocate()
   metrics.allocation_run.stop();
 
   VLOG(1) << "Performed allocation for " << allocationCandidates.size()
-          << " agents in " << stopwatch.elapsed();
+          << " agents and " << allocationCandidateRoles.size()
+          << " agents for some roles in " << stopwatch.elapsed();
 
   // Clear the candidates on completion of the allocation run.
   allocationCandidates.clear();
+  allocationCandidateRoles.clear();
 
   return Nothing();
 }
@@ -1539,16 +1829,28 @@ void HierarchicalAllocatorProcess::__allocate()
   // assume cluster knowledge when summing resources from that set.
 
   vector<SlaveID> slaveIds;
-  slaveIds.reserve(allocationCandidates.size());
+  slaveIds.reserve(
+      allocationCandidates.size() + allocationCandidateRoles.size());
 
   // Filter out non-whitelisted, removed, and deactivated slaves
   // in order not to send offers for them.
-  foreach (const SlaveID& slaveId, allocationCandidates) {
+  auto addCandidate = [&](const SlaveID& slaveId) {
     if (isWhitelisted(slaveId) &&
         slaves.contains(slaveId) &&
         slaves.at(slaveId).activated) {
       slaveIds.push_back(slaveId);
     }
+  };
+
+  foreach (const SlaveID& slaveId, allocationCandidates) {
+    addCandidate(slaveId);
+  }
+
+  // Agents that are candidates for some roles only.
+  foreachkey (const SlaveID& slaveId, allocationCandidateRoles) {
+    if (!allocationCandidates.contains(slaveId)) {
+      addCandidate(slaveId);
+    }
   }
 
   // Randomize the order in which slaves' resources are allocated.
@@ -1556,6 +1858,14 @@ void HierarchicalAllocatorProcess::__allocate()
   // TODO(vinod): Implement a smarter sorting algorithm.
   std::random_shuffle(slaveIds.begin(), slaveIds.end());
 
+  metrics.allocation_run_agents_visited += slaveIds.size();
+
+  AllocationRunProfile profile;
+
+  // Times the phases of this allocation run, see `Metrics`.
+  Stopwatch stopwatch;
+  stopwatch.start();
+
   // Returns the __quantity__ of resources allocated to a quota role. Since we
   // account for reservations and persistent volumes toward quota, we strip
   // reservation and persistent volume related information for comparability.
@@ -1567,16 +1877,15 @@ void HierarchicalAllocatorProcess::__allocate()
   auto getQuotaRoleAllocatedResources = [this](const string& role) {
     CHECK(quotas.contains(role));
 
-    // NOTE: `allocationScalarQuantities` omits dynamic reservation,
-    // persistent volume info, and allocation info. We additionally
-    // remove the static reservations here via `toUnreserved()`.
-    return quotaRoleSorter->allocationScalarQuantities(role).toUnreserved();
+    // NOTE: `allocationScalarQuantities` omits all reservation,
+    // persistent volume info, and allocation info.
+    return quotaRoleSorter->allocationScalarQuantities(role);
   };
 
   // We need to keep track of allocated reserved resources for roles
   // with quota in order to enforce their quota limit. Note these are
   // __quantities__ with no meta-data.
-  hashmap<string, Resources> allocatedReservationScalarQuantities;
+  hashmap<string, ResourceQuantities> allocatedReservationScalarQuantities;
 
   // We build the map here to avoid repetitive aggregation
   // in the allocation loop. Note, this map will still need to be
@@ -1608,10 +1917,8 @@ void HierarchicalAllocatorProcess::__allocate()
       quotaRoleSorter->allocation(role);
 
     foreachvalue (const Resources& resources, allocations) {
-      // We need to remove the static reservation metadata here via
-      // `toUnreserved()`.
       allocatedReservationScalarQuantities[role] +=
-        resources.reserved().createStrippedScalarQuantity().toUnreserved();
+        ResourceQuantities::fromScalarResources(resources.reserved());
     }
   }
 
@@ -1624,23 +1931,25 @@ void HierarchicalAllocatorProcess::__allocate()
   //
   // Given the above, if a role has more reservations than quota,
   // we don't need to hold back any unreserved headroom for it.
-  Resources requiredHeadroom;
+  ResourceQuantities requiredHeadroom;
   foreachpair (const string& role, const Quota& quota, quotas) {
     // NOTE: Revocable resources are excluded in `quotaRoleSorter`.
     // NOTE: Only scalars are considered for quota.
     // NOTE: The following should all be quantities with no meta-data!
-    Resources allocated = getQuotaRoleAllocatedResources(role);
-    const Resources guarantee = quota.info.guarantee();
+    const ResourceQuantities& allocated = getQuotaRoleAllocatedResources(role);
+    const ResourceQuantities guarantee =
+      ResourceQuantities::fromScalarResources(quota.info.guarantee());
 
     if (allocated.contains(guarantee)) {
       continue; // Quota already satisifed.
     }
 
-    Resources unallocated = guarantee - allocated;
+    ResourceQuantities unallocated = guarantee - allocated;
 
-    Resources unallocatedReservations =
-      reservationScalarQuantities.get(role).getOrElse(Resources()) -
-      allocatedReservationScalarQuantities.get(role).getOrElse(Resources());
+    ResourceQuantities unallocatedReservations =
+      reservationScalarQuantities.get(role).getOrElse(ResourceQuantities()) -
+      allocatedReservationScalarQuantities.get(role)
+        .getOrElse(ResourceQuantities());
 
     requiredHeadroom += unallocated - unallocatedReservations;
   }
@@ -1658,19 +1967,13 @@ void HierarchicalAllocatorProcess::__allocate()
   //                        unallocated reservations -
   //                        unallocated revocable resources
 
-  // NOTE: `totalScalarQuantities` omits dynamic reservation,
-  // persistent volume info, and allocation info. We additionally
-  // remove the static reservations here via `toUnreserved()`.
-  Resources availableHeadroom =
-    roleSorter->totalScalarQuantities().toUnreserved();
+  // NOTE: `totalScalarQuantities` omits all reservation,
+  // persistent volume info, and allocation info.
+  ResourceQuantities availableHeadroom = roleSorter->totalScalarQuantities();
 
   // Subtract allocated resources from the total.
   foreachkey (const string& role, roles) {
-    // NOTE: `totalScalarQuantities` omits dynamic reservation,
-    // persistent volume info, and allocation info. We additionally
-    // remove the static reservations here via `toUnreserved()`.
-    availableHeadroom -=
-      roleSorter->allocationScalarQuantities(role).toUnreserved();
+    availableHeadroom -= roleSorter->allocationScalarQuantities(role);
   }
 
   // Subtract all unallocated reservations.
@@ -1682,15 +1985,12 @@ void HierarchicalAllocatorProcess::__allocate()
       allocations = roleSorter->allocation(role);
     }
 
-    Resources unallocatedReservations =
-      reservationScalarQuantities.get(role).getOrElse(Resources());
+    ResourceQuantities unallocatedReservations =
+      reservationScalarQuantities.get(role).getOrElse(ResourceQuantities());
 
     foreachvalue (const Resources& resources, allocations) {
-      // NOTE: `totalScalarQuantities` omits dynamic reservation,
-      // persistent volume info, and allocation info. We additionally
-      // remove the static reservations here via `toUnreserved()`.
       unallocatedReservations -=
-        resources.reserved().createStrippedScalarQuantity().toUnreserved();
+        ResourceQuantities::fromScalarResources(resources.reserved());
     }
 
     // Subtract the unallocated reservations for this role from the headroom.
@@ -1699,13 +1999,12 @@ void HierarchicalAllocatorProcess::__allocate()
 
   // Subtract revocable resources.
   foreachvalue (const Slave& slave, slaves) {
-    // NOTE: `totalScalarQuantities` omits dynamic reservation,
-    // persistent volume info, and allocation info. We additionally
-    // remove the static reservations here via `toUnreserved()`.
-    availableHeadroom -= slave.available().revocable()
-      .createStrippedScalarQuantity().toUnreserved();
+    availableHeadroom -=
+      ResourceQuantities::fromScalarResources(slave.available().revocable());
   }
 
+  metrics.allocation_run_quota_headroom.record(stopwatch.elapsed());
+
   // Due to the two stages in the allocation algorithm and the nature of
   // shared resources being re-offerable even if already allocated, the
   // same shared resources can appear in two (and not more due to the
@@ -1720,10 +2019,26 @@ void HierarchicalAllocatorProcess::__allocate()
   // Quota comes first and fair share second. Here we process only those
   // roles for which quota is set (quota'ed roles). Such roles form a
   // special allocation group with a dedicated sorter.
+  stopwatch.start();
+
   foreach (const SlaveID& slaveId, slaveIds) {
-    foreach (const string& role, quotaRoleSorter->sort()) {
+    const Option<hashset<string>> candidates = candidateRoles(slaveId);
+
+    Stopwatch sortStopwatch;
+    sortStopwatch.start();
+
+    const vector<string> quotaRoles = quotaRoleSorter->sort();
+
+    profile.sort += sortStopwatch.elapsed();
+
+    foreach (const string& role, quotaRoles) {
       CHECK(quotas.contains(role));
 
+      // Skip the roles this agent is not a candidate for.
+      if (candidates.isSome() && !candidates->contains(role)) {
+        continue;
+      }
+
       const Quota& quota = quotas.at(role);
 
       // If there are no active frameworks in this role, we do not
@@ -1733,12 +2048,13 @@ void HierarchicalAllocatorProcess::__allocate()
       }
 
       // This is a __quantity__ with no meta-data.
-      Resources roleReservationScalarQuantities =
-        reservationScalarQuantities.get(role).getOrElse(Resources());
+      ResourceQuantities roleReservationScalarQuantities =
+        reservationScalarQuantities.get(role).getOrElse(ResourceQuantities());
 
       // This is a __quantity__ with no meta-data.
-      Resources roleAllocatedReservationScalarQuantities =
-        allocatedReservationScalarQuantities.get(role).getOrElse(Resources());
+      ResourceQuantities roleAllocatedReservationScalarQuantities =
+        allocatedReservationScalarQuantities.get(role)
+          .getOrElse(ResourceQuantities());
 
       // We charge a role against its quota by considering its
       // allocation as well as any unallocated reservations
@@ -1751,7 +2067,7 @@ void HierarchicalAllocatorProcess::__allocate()
       //                  = reservations + (allocation - allocated reservations)
       //
       // This is a __quantity__ with no meta-data.
-      Resources resourcesChargedAgainstQuota =
+      ResourceQuantities resourcesChargedAgainstQuota =
         roleReservationScalarQuantities +
           (getQuotaRoleAllocatedResources(role) -
                roleAllocatedReservationScalarQuantities);
@@ -1760,7 +2076,8 @@ void HierarchicalAllocatorProcess::__allocate()
       // further allocate reservations for the role.
       //
       // This is a scalar quantity with no meta-data.
-      Resources unsatisfiedQuota = Resources(quota.info.guarantee()) -
+      ResourceQuantities unsatisfiedQuota =
+        ResourceQuantities::fromScalarResources(quota.info.guarantee()) -
         resourcesChargedAgainstQuota;
 
       // Fetch frameworks according to their fair share.
@@ -1768,7 +2085,15 @@ void HierarchicalAllocatorProcess::__allocate()
       CHECK(frameworkSorters.contains(role));
       const Owned<Sorter>& frameworkSorter = frameworkSorters.at(role);
 
-      foreach (const string& frameworkId_, frameworkSorter->sort()) {
+      sortStopwatch.start();
+
+      const vector<string> frameworkIds = frameworkSorter->sort();
+
+      profile.sort += sortStopwatch.elapsed();
+
+      foreach (const string& frameworkId_, frameworkIds) {
+        ++profile.frameworksVisited;
+
         FrameworkID frameworkId;
         frameworkId.set_value(frameworkId_);
 
@@ -1851,7 +2176,7 @@ void HierarchicalAllocatorProcess::__allocate()
         // allocated towards this role's quota. These resources may
         // not get allocated due to framework filters.
         // These are __quantities__ with no meta-data.
-        Resources newQuotaAllocationScalarQuantities;
+        ResourceQuantities newQuotaAllocationScalarQuantities;
 
         // We put resource that this role has no quota for in
         // `nonQuotaResources` tentatively.
@@ -1891,39 +2216,39 @@ void HierarchicalAllocatorProcess::__allocate()
             //
             // Allocation Limit = Available Headroom - Required Headroom -
             //                    Tentative Allocation to Role
-            Resources upperLimitScalarQuantities =
+            ResourceQuantities upperLimitScalarQuantities =
               availableHeadroom - requiredHeadroom -
               (newQuotaAllocationScalarQuantities +
-                nonQuotaResources.createStrippedScalarQuantity());
+                ResourceQuantities::fromScalarResources(nonQuotaResources));
 
-            Option<Value::Scalar> limitScalar =
-              upperLimitScalarQuantities.get<Value::Scalar>(resource.name());
+            Value::Scalar limitScalar =
+              upperLimitScalarQuantities.get(resource.name());
 
-            if (limitScalar.isNone()) {
+            if (limitScalar.value() <= 0) {
               continue; // Already have a headroom deficit.
             }
 
-            if (Resources::shrink(&resource, limitScalar.get())) {
+            if (Resources::shrink(&resource, limitScalar)) {
               nonQuotaResources += resource;
             }
           } else {
             // Allocating resource that this role has quota for,
             // the limit concern is that it should not exceed this
             // role's unsatisfied quota.
-            Resources upperLimitScalarQuantities =
+            ResourceQuantities upperLimitScalarQuantities =
               unsatisfiedQuota - newQuotaAllocationScalarQuantities;
 
-            Option<Value::Scalar> limitScalar =
-              upperLimitScalarQuantities.get<Value::Scalar>(resource.name());
+            Value::Scalar limitScalar =
+              upperLimitScalarQuantities.get(resource.name());
 
-            if (limitScalar.isNone()) {
+            if (limitScalar.value() <= 0) {
               continue; // Quota limit already met.
             }
 
-            if (Resources::shrink(&resource, limitScalar.get())) {
+            if (Resources::shrink(&resource, limitScalar)) {
               resources += resource;
               newQuotaAllocationScalarQuantities +=
-                Resources(resource).createStrippedScalarQuantity();
+                ResourceQuantities::fromScalarResources(resource);
             }
           }
         }
@@ -1966,7 +2291,15 @@ void HierarchicalAllocatorProcess::__allocate()
 
         // If the framework filters these resources, ignore. The unallocated
         // part of the quota will not be allocated to other roles.
-        if (isFiltered(frameworkId, role, slaveId, resources)) {
+        Stopwatch filterStopwatch;
+        filterStopwatch.start();
+
+        const bool filtered =
+          isFiltered(frameworkId, role, slaveId, resources);
+
+        profile.filter += filterStopwatch.elapsed();
+
+        if (filtered) {
           continue;
         }
 
@@ -1987,7 +2320,7 @@ void HierarchicalAllocatorProcess::__allocate()
         // Track quota headroom change.
         requiredHeadroom -= newQuotaAllocationScalarQuantities;
         availableHeadroom -=
-          resources.unreserved().createStrippedScalarQuantity();
+          ResourceQuantities::fromScalarResources(resources.unreserved());
 
         // Update the tracking of allocated reservations.
         //
@@ -1999,10 +2332,9 @@ void HierarchicalAllocatorProcess::__allocate()
             return !slaves.at(slaveId).allocated.contains(resource);
           });
 
-        // We remove the static reservation metadata here via `toUnreserved()`.
         allocatedReservationScalarQuantities[role] +=
-          (resources.reserved(role).nonShared() + newShared)
-            .createStrippedScalarQuantity().toUnreserved();
+          ResourceQuantities::fromScalarResources(
+              resources.reserved(role).nonShared() + newShared);
 
         slave.allocated += resources;
 
@@ -2011,6 +2343,8 @@ void HierarchicalAllocatorProcess::__allocate()
     }
   }
 
+  metrics.allocation_run_quota_stage.record(stopwatch.elapsed());
+
   // Similar to the first stage, we will allocate resources while ensuring
   // that the required unreserved non-revocable headroom is still available.
   // Otherwise, we will not be able to satisfy quota later. Reservations to
@@ -2018,162 +2352,407 @@ void HierarchicalAllocatorProcess::__allocate()
   // in the offers since these are not part of the headroom (and
   // therefore can't be used to satisfy quota).
 
-  foreach (const SlaveID& slaveId, slaveIds) {
-    foreach (const string& role, roleSorter->sort()) {
-      // In the second allocation stage, we only allocate
-      // for non-quota roles.
-      if (quotas.contains(role)) {
-        continue;
-      }
+  // Tracks an allocation made during the fair share stage.
+  auto track = [&](
+      const SlaveID& slaveId,
+      const FairShareAllocation& allocated) {
+    VLOG(2) << "Allocating " << allocated.resources << " on agent " << slaveId
+            << " to role " << allocated.role
+            << " of framework " << allocated.frameworkId;
 
-      // NOTE: Suppressed frameworks are not included in the sort.
-      CHECK(frameworkSorters.contains(role));
-      const Owned<Sorter>& frameworkSorter = frameworkSorters.at(role);
+    // NOTE: We perform "coarse-grained" allocation, meaning that we always
+    // allocate the entire remaining slave resources to a single framework.
+    //
+    // NOTE: We may have already allocated some resources on the current
+    // agent as part of quota.
+    offerable[allocated.frameworkId][allocated.role][slaveId] +=
+      allocated.resources;
+    offeredSharedResources[slaveId] += allocated.resources.shared();
 
-      foreach (const string& frameworkId_, frameworkSorter->sort()) {
-        FrameworkID frameworkId;
-        frameworkId.set_value(frameworkId_);
+    slaves.at(slaveId).allocated += allocated.resources;
 
-        CHECK(slaves.contains(slaveId));
-        CHECK(frameworks.contains(frameworkId));
+    trackAllocatedResources(
+        slaveId, allocated.frameworkId, allocated.resources);
+  };
 
-        const Framework& framework = frameworks.at(frameworkId);
-        Slave& slave = slaves.at(slaveId);
+  stopwatch.start();
 
-        // Only offer resources from slaves that have GPUs to
-        // frameworks that are capable of receiving GPUs.
-        // See MESOS-5634.
-        if (filterGpuResources &&
-            !framework.capabilities.gpuResources &&
-            slave.total.gpus().getOrElse(0) > 0) {
-          continue;
-        }
+  if (allocationThreads <= 1 || slaveIds.size() <= 1) {
+    foreach (const SlaveID& slaveId, slaveIds) {
+      const vector<FairShareAllocation> allocations = allocateFairShare(
+          slaveId,
+          candidateRoles(slaveId),
+          roleSorter.get(),
+          frameworkSorters,
+          offeredSharedResources.get(slaveId).getOrElse(Resources()),
+          requiredHeadroom,
+          &availableHeadroom,
+          &profile);
+
+      foreach (const FairShareAllocation& allocated, allocations) {
+        track(slaveId, allocated);
+      }
+    }
+  } else {
+    vector<vector<FairShareAllocation>> allocations = allocateFairShare(
+        slaveIds,
+        offeredSharedResources,
+        requiredHeadroom,
+        availableHeadroom,
+        &profile);
+
+    // Each partition of agents was allocated against its own copy of the
+    // available headroom, so combined the partitions may hold back less
+    // than the required headroom. We track the allocations in agent order
+    // and drop the headroom part of those that no longer fit.
+    for (size_t i = 0; i < slaveIds.size(); i++) {
+      const SlaveID& slaveId = slaveIds[i];
+
+      foreach (FairShareAllocation& allocated, allocations[i]) {
+        if (!allocated.headroom.empty()) {
+          bool sufficientHeadroom =
+            (availableHeadroom - allocated.headroom).contains(requiredHeadroom);
+
+          if (sufficientHeadroom) {
+            availableHeadroom -= allocated.headroom;
+          } else {
+            Resources headroomToAllocate = allocated.resources
+              .scalars().unreserved().nonRevocable();
 
-        // If this framework is not region-aware, don't offer it
-        // resources on agents in remote regions.
-        if (!framework.capabilities.regionAware && isRemoteSlave(slave)) {
-          continue;
-        }
+            allocated.resources -= headroomToAllocate;
+            allocated.headroom = ResourceQuantities();
 
-        // Calculate the currently available resources on the slave, which
-        // is the difference in non-shared resources between total and
-        // allocated, plus all shared resources on the agent (if applicable).
-        Resources available = slave.available().nonShared();
+            if (!allocatable(allocated.resources)) {
+              continue;
+            }
 
-        // Since shared resources are offerable even when they are in use, we
-        // make one copy of the shared resources available regardless of the
-        // past allocations. Offer a shared resource only if it has not been
-        // offered in this offer cycle to a framework.
-        if (framework.capabilities.sharedResources) {
-          available += slave.total.shared();
-          if (offeredSharedResources.contains(slaveId)) {
-            available -= offeredSharedResources[slaveId];
+            // Filters are matched against unallocated resources.
+            Resources resources = allocated.resources;
+            resources.unallocate();
+
+            Stopwatch filterStopwatch;
+            filterStopwatch.start();
+
+            const bool filtered = isFiltered(
+                allocated.frameworkId,
+                allocated.role,
+                slaveId,
+                resources);
+
+            profile.filter += filterStopwatch.elapsed();
+
+            if (filtered) {
+              continue;
+            }
           }
         }
 
-        // The resources we offer are the unreserved resources as well as the
-        // reserved resources for this particular role and all its ancestors
-        // in the role hierarchy.
-        //
-        // NOTE: Currently, frameworks are allowed to have '*' role.
-        // Calling reserved('*') returns an empty Resources object.
-        //
-        // TODO(mpark): Offer unreserved resources as revocable beyond quota.
-        Resources resources = available.allocatableTo(role);
+        track(slaveId, allocated);
+      }
+    }
+  }
 
-        // It is safe to break here, because all frameworks under a role would
-        // consider the same resources, so in case we don't have allocatable
-        // resources, we don't have to check for other frameworks under the
-        // same role. We only break out of the innermost loop, so the next step
-        // will use the same slaveId, but a different role.
-        //
-        // The difference to the second `allocatable` check is that here we also
-        // check for revocable resources, which can be disabled on a per frame-
-        // work basis, which requires us to go through all frameworks in case we
-        // have allocatable revocable resources.
-        if (!allocatable(resources)) {
-          break;
-        }
+  metrics.allocation_run_fair_share_stage.record(stopwatch.elapsed());
 
-        // Remove revocable resources if the framework has not opted for them.
-        if (!framework.capabilities.revocableResources) {
-          resources = resources.nonRevocable();
-        }
+  stopwatch.start();
 
-        // When reservation refinements are present, old frameworks without the
-        // RESERVATION_REFINEMENT capability won't be able to understand the
-        // new format. While it's possible to translate the refined reservations
-        // into the old format by "hiding" the intermediate reservations in the
-        // "stack", this leads to ambiguity when processing RESERVE / UNRESERVE
-        // operations. This is due to the loss of information when we drop the
-        // intermediate reservations. Therefore, for now we simply filter out
-        // resources with refined reservations if the framework does not have
-        // the capability.
-        if (!framework.capabilities.reservationRefinement) {
-          resources = resources.filter([](const Resource& resource) {
-            return !Resources::hasRefinedReservations(resource);
-          });
-        }
+  if (offerable.empty()) {
+    VLOG(2) << "No allocations performed";
+  } else {
+    // Now offer the resources to each framework.
+    foreachkey (const FrameworkID& frameworkId, offerable) {
+      offerCallback(frameworkId, offerable.at(frameworkId));
+    }
+  }
 
-        // If allocating these resources would reduce the headroom
-        // below what is required, we will hold them back.
-        const Resources headroomToAllocate = resources
-          .scalars().unreserved().nonRevocable();
+  metrics.allocation_run_offer_callback.record(stopwatch.elapsed());
 
-        bool sufficientHeadroom =
-          (availableHeadroom -
-            headroomToAllocate.createStrippedScalarQuantity())
-            .contains(requiredHeadroom);
+  metrics.allocation_run_sort.record(profile.sort);
+  metrics.allocation_run_filter.record(profile.filter);
+  metrics.allocation_run_frameworks_visited += profile.frameworksVisited;
+}
 
-        if (!sufficientHeadroom) {
-          resources -= headroomToAllocate;
-        }
 
-        // If the resources are not allocatable, ignore. We cannot break
-        // here, because another framework under the same role could accept
-        // revocable resources and breaking would skip all other frameworks.
-        if (!allocatable(resources)) {
-          continue;
-        }
+vector<HierarchicalAllocatorProcess::FairShareAllocation>
+HierarchicalAllocatorProcess::allocateFairShare(
+    const SlaveID& slaveId,
+    const Option<hashset<string>>& candidates,
+    Sorter* _roleSorter,
+    const hashmap<string, Owned<Sorter>>& _frameworkSorters,
+    const Resources& offeredSharedResources,
+    const ResourceQuantities& requiredHeadroom,
+    ResourceQuantities* availableHeadroom,
+    AllocationRunProfile* profile) const
+{
+  CHECK(slaves.contains(slaveId));
+  CHECK_NOTNULL(availableHeadroom);
+  CHECK_NOTNULL(profile);
 
-        // If the framework filters these resources, ignore.
-        if (isFiltered(frameworkId, role, slaveId, resources)) {
-          continue;
-        }
+  const Slave& slave = slaves.at(slaveId);
 
-        VLOG(2) << "Allocating " << resources << " on agent " << slaveId
-                << " to role " << role << " of framework " << frameworkId;
+  vector<FairShareAllocation> result;
 
-        resources.allocate(role);
+  // The allocations on the agent so far, including the ones made here
+  // which are not yet tracked in `slave.allocated`.
+  Resources allocated = slave.allocated;
+  Resources offeredShared = offeredSharedResources;
 
-        // NOTE: We perform "coarse-grained" allocation, meaning that we always
-        // allocate the entire remaining slave resources to a single framework.
-        //
-        // NOTE: We may have already allocated some resources on the current
-        // agent as part of quota.
-        offerable[frameworkId][role][slaveId] += resources;
-        offeredSharedResources[slaveId] += resources.shared();
+  Stopwatch stopwatch;
+  stopwatch.start();
 
-        if (sufficientHeadroom) {
-          availableHeadroom -=
-            headroomToAllocate.createStrippedScalarQuantity();
-        }
+  const vector<string> sortedRoles = _roleSorter->sort();
 
-        slave.allocated += resources;
+  profile->sort += stopwatch.elapsed();
 
-        trackAllocatedResources(slaveId, frameworkId, resources);
+  foreach (const string& role, sortedRoles) {
+    // In the second allocation stage, we only allocate
+    // for non-quota roles.
+    if (quotas.contains(role)) {
+      continue;
+    }
+
+    // Skip the roles this agent is not a candidate for.
+    if (candidates.isSome() && !candidates->contains(role)) {
+      continue;
+    }
+
+    // NOTE: Suppressed frameworks are not included in the sort.
+    CHECK(_frameworkSorters.contains(role));
+    const Owned<Sorter>& frameworkSorter = _frameworkSorters.at(role);
+
+    stopwatch.start();
+
+    const vector<string> frameworkIds = frameworkSorter->sort();
+
+    profile->sort += stopwatch.elapsed();
+
+    foreach (const string& frameworkId_, frameworkIds) {
+      ++profile->frameworksVisited;
+
+      FrameworkID frameworkId;
+      frameworkId.set_value(frameworkId_);
+
+      CHECK(frameworks.contains(frameworkId));
+
+      const Framework& framework = frameworks.at(frameworkId);
+
+      // Only offer resources from slaves that have GPUs to
+      // frameworks that are capable of receiving GPUs.
+      // See MESOS-5634.
+      if (filterGpuResources &&
+          !framework.capabilities.gpuResources &&
+          slave.total.gpus().getOrElse(0) > 0) {
+        continue;
+      }
+
+      // If this framework is not region-aware, don't offer it
+      // resources on agents in remote regions.
+      if (!framework.capabilities.regionAware && isRemoteSlave(slave)) {
+        continue;
+      }
+
+      // Calculate the currently available resources on the slave, which
+      // is the difference in non-shared resources between total and
+      // allocated, plus all shared resources on the agent (if applicable).
+      // See `Slave::available()`.
+      Resources allocated_ = allocated;
+      allocated_.unallocate();
+
+      Resources available = (slave.total - allocated_).nonShared();
+
+      // Since shared resources are offerable even when they are in use, we
+      // make one copy of the shared resources available regardless of the
+      // past allocations. Offer a shared resource only if it has not been
+      // offered in this offer cycle to a framework.
+      if (framework.capabilities.sharedResources) {
+        available += slave.total.shared();
+        available -= offeredShared;
+      }
+
+      // The resources we offer are the unreserved resources as well as the
+      // reserved resources for this particular role and all its ancestors
+      // in the role hierarchy.
+      //
+      // NOTE: Currently, frameworks are allowed to have '*' role.
+      // Calling reserved('*') returns an empty Resources object.
+      //
+      // TODO(mpark): Offer unreserved resources as revocable beyond quota.
+      Resources resources = available.allocatableTo(role);
+
+      // It is safe to break here, because all frameworks under a role would
+      // consider the same resources, so in case we don't have allocatable
+      // resources, we don't have to check for other frameworks under the
+      // same role. We only break out of the innermost loop, so the next step
+      // will use the same slaveId, but a different role.
+      //
+      // The difference to the second `allocatable` check is that here we also
+      // check for revocable resources, which can be disabled on a per frame-
+      // work basis, which requires us to go through all frameworks in case we
+      // have allocatable revocable resources.
+      if (!allocatable(resources)) {
+        break;
+      }
+
+      // Remove revocable resources if the framework has not opted for them.
+      if (!framework.capabilities.revocableResources) {
+        resources = resources.nonRevocable();
+      }
+
+      // When reservation refinements are present, old frameworks without the
+      // RESERVATION_REFINEMENT capability won't be able to understand the
+      // new format. While it's possible to translate the refined reservations
+      // into the old format by "hiding" the intermediate reservations in the
+      // "stack", this leads to ambiguity when processing RESERVE / UNRESERVE
+      // operations. This is due to the loss of information when we drop the
+      // intermediate reservations. Therefore, for now we simply filter out
+      // resources with refined reservations if the framework does not have
+      // the capability.
+      if (!framework.capabilities.reservationRefinement) {
+        resources = resources.filter([](const Resource& resource) {
+          return !Resources::hasRefinedReservations(resource);
+        });
+      }
+
+      // If allocating these resources would reduce the headroom
+      // below what is required, we will hold them back.
+      const Resources headroomToAllocate = resources
+        .scalars().unreserved().nonRevocable();
+
+      const ResourceQuantities headroomQuantities =
+        ResourceQuantities::fromScalarResources(headroomToAllocate);
+
+      bool sufficientHeadroom =
+        (*availableHeadroom - headroomQuantities).contains(requiredHeadroom);
+
+      if (!sufficientHeadroom) {
+        resources -= headroomToAllocate;
+      }
+
+      // If the resources are not allocatable, ignore. We cannot break
+      // here, because another framework under the same role could accept
+      // revocable resources and breaking would skip all other frameworks.
+      if (!allocatable(resources)) {
+        continue;
+      }
+
+      // If the framework filters these resources, ignore.
+      stopwatch.start();
+
+      const bool filtered = isFiltered(frameworkId, role, slaveId, resources);
+
+      profile->filter += stopwatch.elapsed();
+
+      if (filtered) {
+        continue;
+      }
+
+      resources.allocate(role);
+
+      FairShareAllocation allocation;
+      allocation.frameworkId = frameworkId;
+      allocation.role = role;
+      allocation.resources = resources;
+
+      if (sufficientHeadroom) {
+        allocation.headroom = headroomQuantities;
+        *availableHeadroom -= allocation.headroom;
       }
+
+      allocated += resources;
+      offeredShared += resources.shared();
+
+      result.push_back(std::move(allocation));
     }
   }
 
-  if (offerable.empty()) {
-    VLOG(2) << "No allocations performed";
-  } else {
-    // Now offer the resources to each framework.
-    foreachkey (const FrameworkID& frameworkId, offerable) {
-      offerCallback(frameworkId, offerable.at(frameworkId));
+  return result;
+}
+
+
+vector<vector<HierarchicalAllocatorProcess::FairShareAllocation>>
+HierarchicalAllocatorProcess::allocateFairShare(
+    const vector<SlaveID>& slaveIds,
+    const hashmap<SlaveID, Resources>& offeredSharedResources,
+    const ResourceQuantities& requiredHeadroom,
+    const ResourceQuantities& availableHeadroom,
+    AllocationRunProfile* profile) const
+{
+  CHECK_NOTNULL(profile);
+
+  vector<vector<FairShareAllocation>> result(slaveIds.size());
+
+  const size_t partitions = std::min(allocationThreads, slaveIds.size());
+  const size_t partitionSize = (slaveIds.size() + partitions - 1) / partitions;
+
+  vector<AllocationRunProfile> profiles(partitions);
+
+  // Allocates the agents in [begin, end) against snapshots of the
+  // sorters, so that the allocations within a partition affect the
+  // order in which roles and frameworks are considered (as they do when
+  // allocating serially) without touching the allocator's own sorters.
+  //
+  // NOTE: Each partition only writes to its own entries in `result`
+  // and to its own entry in `profiles`.
+  auto allocatePartition = [&](size_t begin, size_t end) {
+    AllocationRunProfile* _profile = &profiles[begin / partitionSize];
+
+    Owned<Sorter> _roleSorter(roleSorter->snapshot());
+
+    hashmap<string, Owned<Sorter>> _frameworkSorters;
+    foreachpair (const string& role,
+                 const Owned<Sorter>& frameworkSorter,
+                 frameworkSorters) {
+      if (!quotas.contains(role)) {
+        _frameworkSorters.put(role, Owned<Sorter>(frameworkSorter->snapshot()));
+      }
+    }
+
+    ResourceQuantities _availableHeadroom = availableHeadroom;
+
+    for (size_t i = begin; i < end; i++) {
+      const SlaveID& slaveId = slaveIds[i];
+
+      result[i] = allocateFairShare(
+          slaveId,
+          candidateRoles(slaveId),
+          _roleSorter.get(),
+          _frameworkSorters,
+          offeredSharedResources.get(slaveId).getOrElse(Resources()),
+          requiredHeadroom,
+          &_availableHeadroom,
+          _profile);
+
+      // Mirror `trackAllocatedResources()` on the snapshots.
+      foreach (const FairShareAllocation& allocated, result[i]) {
+        const Owned<Sorter>& frameworkSorter =
+          _frameworkSorters.at(allocated.role);
+
+        _roleSorter->allocated(allocated.role, slaveId, allocated.resources);
+        frameworkSorter->add(slaveId, allocated.resources);
+        frameworkSorter->allocated(
+            allocated.frameworkId.value(), slaveId, allocated.resources);
+      }
     }
+  };
+
+  vector<std::function<void()>> functions;
+  for (size_t begin = 0; begin < slaveIds.size(); begin += partitionSize) {
+    const size_t end = std::min(begin + partitionSize, slaveIds.size());
+
+    functions.push_back([&allocatePartition, begin, end]() {
+      allocatePartition(begin, end);
+    });
   }
+
+  CHECK(workers.get() != nullptr);
+
+  workers->run(std::move(functions));
+
+  foreach (const AllocationRunProfile& _profile, profiles) {
+    *profile += _profile;
+  }
+
+  return result;
 }
 
 
@@ -2301,7 +2880,9 @@ void HierarchicalAllocatorProcess::_expire(
 
       if (agentFilters != roleFilters->second.end()) {
         // Erase the filter (may be a no-op per the comment above).
-        agentFilters->second.erase(offerFilter);
+        if (agentFilters->second.erase(offerFilter) > 0) {
+          markDirty(slaveId, role);
+        }
 
         if (agentFilters->second.empty()) {
           roleFilters->second.erase(slaveId);
@@ -2350,7 +2931,9 @@ void HierarchicalAllocatorProcess::expire(
 
     auto filters = framework.inverseOfferFilters.find(slaveId);
     if (filters != framework.inverseOfferFilters.end()) {
-      filters->second.erase(inverseOfferFilter);
+      if (filters->second.erase(inverseOfferFilter) > 0) {
+        markDirty(slaveId);
+      }
 
       if (filters->second.empty()) {
         framework.inverseOfferFilters.erase(slaveId);
@@ -2424,8 +3007,11 @@ bool HierarchicalAllocatorProcess::isFiltered(
     return false;
   }
 
+  const ResourceQuantities quantities =
+    ResourceQuantities::fromScalarResources(resources);
+
   foreach (OfferFilter* offerFilter, agentFilters->second) {
-    if (offerFilter->filter(resources)) {
+    if (offerFilter->filter(resources, quantities)) {
       VLOG(1) << "Filtered offer with " << resources
               << " on agent " << slaveId
               << " for role " << role
@@ -2496,11 +3082,7 @@ double HierarchicalAllocatorProcess::_resources_offered_or_allocated(
 double HierarchicalAllocatorProcess::_resources_total(
     const string& resource)
 {
-  Option<Value::Scalar> total =
-    roleSorter->totalScalarQuantities()
-      .get<Value::Scalar>(resource);
-
-  return total.isSome() ? total->value() : 0;
+  return roleSorter->totalScalarQuantities().get(resource).value();
 }
 
 
@@ -2508,11 +3090,8 @@ double HierarchicalAllocatorProcess::_quota_allocated(
     const string& role,
     const string& resource)
 {
-  Option<Value::Scalar> used =
-    quotaRoleSorter->allocationScalarQuantities(role)
-      .get<Value::Scalar>(resource);
-
-  return used.isSome() ? used->value() : 0;
+  return quotaRoleSorter->allocationScalarQuantities(role)
+    .get(resource).value();
 }
 
 
@@ -2613,11 +3192,8 @@ void HierarchicalAllocatorProcess::trackReservations(
 {
   foreachpair (const string& role,
                const Resources& resources, reservations) {
-    // We remove the static reservation metadata here via `toUnreserved()`.
-    const Resources scalarQuantitesToTrack =
-        resources.createStrippedScalarQuantity().toUnreserved();
-
-    reservationScalarQuantities[role] += scalarQuantitesToTrack;
+    reservationScalarQuantities[role] +=
+      ResourceQuantities::fromScalarResources(resources);
   }
 }
 
@@ -2628,12 +3204,11 @@ void HierarchicalAllocatorProcess::untrackReservations(
   foreachpair (const string& role,
                const Resources& resources, reservations) {
     CHECK(reservationScalarQuantities.contains(role));
-    Resources& currentReservationQuantity =
+    ResourceQuantities& currentReservationQuantity =
         reservationScalarQuantities.at(role);
 
-    // We remove the static reservation metadata here via `toUnreserved()`.
-    const Resources scalarQuantitesToUntrack =
-        resources.createStrippedScalarQuantity().toUnreserved();
+    const ResourceQuantities scalarQuantitesToUntrack =
+        ResourceQuantities::fromScalarResources(resources);
     CHECK(currentReservationQuantity.contains(scalarQuantitesToUntrack));
     currentReservationQuantity -= scalarQuantitesToUntrack;
 
@@ -17,14 +17,22 @@
 #ifndef __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 #define __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
 #include <process/owned.hpp>
+#include <process/timeout.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
@@ -33,6 +41,7 @@
 #include <stout/option.hpp>
 
 #include "common/protobuf_utils.hpp"
+#include "common/resource_quantities.hpp"
 
 #include "master/allocator/mesos/allocator.hpp"
 #include "master/allocator/mesos/metrics.hpp"
@@ -68,6 +77,43 @@ class OfferFilter;
 class InverseOfferFilter;
 
 
+// The threads that allocate the partitions of the fair share stage of
+// an allocation run, see `allocateFairShare()`. They are started when
+// the allocator is initialized and used for every allocation run.
+class AllocationWorkers
+{
+public:
+  explicit AllocationWorkers(size_t count);
+
+  // Waits for the functions being run to return and stops the threads.
+  ~AllocationWorkers();
+
+  // Runs the functions on the worker threads and on the calling thread
+  // and returns once all of them have returned. Not to be called
+  // concurrently.
+  void run(std::vector<std::function<void()>>&& functions);
+
+private:
+  AllocationWorkers(const AllocationWorkers&) = delete;
+  AllocationWorkers& operator=(const AllocationWorkers&) = delete;
+
+  void loop();
+
+  std::mutex mutex;
+  std::condition_variable available;
+  std::condition_variable done;
+
+  // The functions that have not started yet and the number of
+  // functions that have not returned yet (protected by `mutex`).
+  std::deque<std::function<void()>> functions;
+  size_t pending;
+
+  bool stopping;
+
+  std::vector<std::thread> threads;
+};
+
+
 // Implements the basic allocator algorithm - first pick a role by
 // some criteria, then pick one of their frameworks to allocate to.
 class HierarchicalAllocatorProcess : public MesosAllocatorProcess
@@ -104,7 +150,9 @@ public:
       const Option<std::set<std::string>>&
         fairnessExcludeResourceNames = None(),
       bool filterGpuResources = true,
-      const Option<DomainInfo>& domain = None());
+      const Option<DomainInfo>& domain = None(),
+      size_t allocationThreads = 1,
+      const Option<Duration>& allocationSweepInterval = None());
 
   void recover(
       const int _expectedAgentCount,
@@ -235,6 +283,23 @@ protected:
   // is deferred and batched with other allocation requests.
   process::Future<Nothing> allocate(const hashset<SlaveID>& slaveIds);
 
+  // Allocate resources from the agents and roles marked dirty since the
+  // previous allocation, or from all agents if no sweep interval is set
+  // or a sweep is due. This is used for the periodic allocations.
+  process::Future<Nothing> allocateDirty();
+
+  // Helpers to mark all roles on all agents, all roles on an agent, a
+  // role on all agents, or a role on an agent as dirty, i.e., to be
+  // considered by the next `allocateDirty()`.
+  void markDirty();
+  void markDirty(const SlaveID& slaveId);
+  void markDirty(const std::string& role);
+  void markDirty(const SlaveID& slaveId, const std::string& role);
+
+  // Returns the roles to consider on an allocation candidate, `None`
+  // meaning all roles.
+  Option<hashset<std::string>> candidateRoles(const SlaveID& slaveId) const;
+
   // Method that performs allocation work.
   Nothing _allocate();
 
@@ -434,9 +499,18 @@ protected:
   // processed, the set of candidates is cleared.
   hashset<SlaveID> allocationCandidates;
 
-  // Future for the dispatched allocation that becomes
-  // ready after the allocation run is complete.
-  Option<process::Future<Nothing>> allocation;
+  // Agents that are kept as allocation candidates for some roles only.
+  // Agents in `allocationCandidates` are candidates for all roles.
+  hashmap<SlaveID, hashset<std::string>> allocationCandidateRoles;
+
+  // Agents, and roles on agents, affected by events since the previous
+  // periodic allocation, see `allocateDirty()`.
+  hashset<SlaveID> dirtySlaves;
+  hashmap<SlaveID, hashset<std::string>> dirtySlaveRoles;
+
+  // Used to coalesce allocation requests into a single dispatched
+  // allocation run until that run starts.
+  process::Coalescer<Nothing> allocation;
 
   // We track information about roles that we're aware of in the system.
   // Specifically, we keep track of the roles when a framework subscribes to
@@ -454,12 +528,12 @@ protected:
   hashmap<std::string, Quota> quotas;
 
   // Aggregated resource reservations on all agents tied to a
-  // particular role, if any. These are stripped scalar quantities
-  // that contain no meta-data. Used for accounting resource
+  // particular role, if any. These are scalar quantities that
+  // contain no meta-data. Used for accounting resource
   // reservations for quota limit.
   //
   // Only roles with non-empty reservations will be stored in the map.
-  hashmap<std::string, Resources> reservationScalarQuantities;
+  hashmap<std::string, ResourceQuantities> reservationScalarQuantities;
 
   // Slaves to send offers for.
   Option<hashset<std::string>> whitelist;
@@ -473,6 +547,20 @@ protected:
   // The master's domain, if any.
   Option<DomainInfo> domain;
 
+  // Number of threads used for the fair share stage of an allocation
+  // run, see `allocateFairShare()`.
+  size_t allocationThreads;
+
+  // The `allocationThreads - 1` threads that allocate the partitions
+  // of the fair share stage along with the allocator's own thread (if
+  // `allocationThreads` is more than one).
+  process::Owned<AllocationWorkers> workers;
+
+  // If set, periodic allocations only consider the dirty agents and
+  // roles, and all agents once the `allocationSweep` expires.
+  Option<Duration> allocationSweepInterval;
+  process::Timeout allocationSweep;
+
   // There are two stages of allocation. During the first stage resources
   // are allocated only to frameworks under roles with quota set. During
   // the second stage remaining resources that would not be required to
@@ -584,6 +672,69 @@ private:
   // the agent and the master are both configured with a fault domain.
   bool isRemoteSlave(const Slave& slave) const;
 
+  // Resources allocated to a framework on an agent during the fair share
+  // stage (i.e., the second stage) of an allocation run.
+  struct FairShareAllocation
+  {
+    FrameworkID frameworkId;
+    std::string role;
+
+    // Allocated to `role`.
+    Resources resources;
+
+    // The quantities of the unreserved non-revocable scalar part of
+    // `resources` that were deducted from the available headroom.
+    ResourceQuantities headroom;
+  };
+
+  // Time spent sorting and checking filters, and the number of times a
+  // framework was considered for an agent, during an allocation run.
+  // These are spread across both allocation stages, so they are summed
+  // up here and reported through `Metrics` once the run completes.
+  struct AllocationRunProfile
+  {
+    AllocationRunProfile& operator+=(const AllocationRunProfile& that)
+    {
+      sort += that.sort;
+      filter += that.filter;
+      frameworksVisited += that.frameworksVisited;
+      return *this;
+    }
+
+    Duration sort;
+    Duration filter;
+    size_t frameworksVisited = 0;
+  };
+
+  // Helper for the fair share stage of `__allocate()` that determines
+  // the allocations on a single agent, in the order given by the role
+  // and framework sorters. This does not update any allocator state
+  // other than `availableHeadroom`, i.e., the caller is responsible for
+  // tracking the returned allocations. If `candidates` is set, only
+  // those roles are considered.
+  std::vector<FairShareAllocation> allocateFairShare(
+      const SlaveID& slaveId,
+      const Option<hashset<std::string>>& candidates,
+      Sorter* _roleSorter,
+      const hashmap<std::string, process::Owned<Sorter>>& _frameworkSorters,
+      const Resources& offeredSharedResources,
+      const ResourceQuantities& requiredHeadroom,
+      ResourceQuantities* availableHeadroom,
+      AllocationRunProfile* profile) const;
+
+  // Helper for the fair share stage of `__allocate()` that partitions
+  // the agents across `allocationThreads` threads. Each thread allocates
+  // its agents against its own snapshot of the sorters and of the
+  // available headroom, hence the headroom needs to be checked again
+  // when tracking the returned allocations (indexed like `slaveIds`).
+  // The profiles of all threads are added to `profile`.
+  std::vector<std::vector<FairShareAllocation>> allocateFairShare(
+      const std::vector<SlaveID>& slaveIds,
+      const hashmap<SlaveID, Resources>& offeredSharedResources,
+      const ResourceQuantities& requiredHeadroom,
+      const ResourceQuantities& availableHeadroom,
+      AllocationRunProfile* profile) const;
+
   // Helper to track allocated resources on an agent.
   void trackAllocatedResources(
       const SlaveID& slaveId,
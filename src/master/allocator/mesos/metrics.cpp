@@ -49,13 +49,35 @@ Metrics::Metrics(const HierarchicalAllocatorProcess& _allocator)
             allocator, &HierarchicalAllocatorProcess::_event_queue_dispatches)),
     allocation_runs("allocator/mesos/allocation_runs"),
     allocation_run("allocator/mesos/allocation_run", Hours(1)),
-    allocation_run_latency("allocator/mesos/allocation_run_latency", Hours(1))
+    allocation_run_latency("allocator/mesos/allocation_run_latency", Hours(1)),
+    allocation_run_quota_headroom(
+        "allocator/mesos/allocation_run/quota_headroom", Hours(1)),
+    allocation_run_quota_stage(
+        "allocator/mesos/allocation_run/quota_stage", Hours(1)),
+    allocation_run_fair_share_stage(
+        "allocator/mesos/allocation_run/fair_share_stage", Hours(1)),
+    allocation_run_sort("allocator/mesos/allocation_run/sort", Hours(1)),
+    allocation_run_filter("allocator/mesos/allocation_run/filter", Hours(1)),
+    allocation_run_offer_callback(
+        "allocator/mesos/allocation_run/offer_callback", Hours(1)),
+    allocation_run_agents_visited(
+        "allocator/mesos/allocation_run/agents_visited"),
+    allocation_run_frameworks_visited(
+        "allocator/mesos/allocation_run/frameworks_visited")
 {
   process::metrics::add(event_queue_dispatches);
   process::metrics::add(event_queue_dispatches_);
   process::metrics::add(allocation_runs);
   process::metrics::add(allocation_run);
   process::metrics::add(allocation_run_latency);
+  process::metrics::add(allocation_run_quota_headroom);
+  process::metrics::add(allocation_run_quota_stage);
+  process::metrics::add(allocation_run_fair_share_stage);
+  process::metrics::add(allocation_run_sort);
+  process::metrics::add(allocation_run_filter);
+  process::metrics::add(allocation_run_offer_callback);
+  process::metrics::add(allocation_run_agents_visited);
+  process::metrics::add(allocation_run_frameworks_visited);
 
   // Create and install gauges for the total and allocated
   // amount of standard scalar resources.
@@ -95,6 +117,14 @@ Metrics::~Metrics()
   process::metrics::remove(allocation_runs);
   process::metrics::remove(allocation_run);
   process::metrics::remove(allocation_run_latency);
+  process::metrics::remove(allocation_run_quota_headroom);
+  process::metrics::remove(allocation_run_quota_stage);
+  process::metrics::remove(allocation_run_fair_share_stage);
+  process::metrics::remove(allocation_run_sort);
+  process::metrics::remove(allocation_run_filter);
+  process::metrics::remove(allocation_run_offer_callback);
+  process::metrics::remove(allocation_run_agents_visited);
+  process::metrics::remove(allocation_run_frameworks_visited);
 
   foreach (const Gauge& gauge, resources_total) {
     process::metrics::remove(gauge);
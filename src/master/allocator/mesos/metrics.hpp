@@ -72,6 +72,25 @@ struct Metrics
   // The latency of allocation runs due to the batching of allocation requests.
   process::metrics::Timer<Milliseconds> allocation_run_latency;
 
+  // Time spent in the phases of the allocation algorithm. Sorting and
+  // filter checks happen in both allocation stages and are also
+  // included in their timers. When the fair share stage is allocated
+  // on multiple threads, the sorting and filter check times are summed
+  // across the threads and thus may exceed the time of the stage.
+  process::metrics::Timer<Milliseconds> allocation_run_quota_headroom;
+  process::metrics::Timer<Milliseconds> allocation_run_quota_stage;
+  process::metrics::Timer<Milliseconds> allocation_run_fair_share_stage;
+  process::metrics::Timer<Milliseconds> allocation_run_sort;
+  process::metrics::Timer<Milliseconds> allocation_run_filter;
+  process::metrics::Timer<Milliseconds> allocation_run_offer_callback;
+
+  // Number of agents considered by allocation runs.
+  process::metrics::Counter allocation_run_agents_visited;
+
+  // Number of times a framework was considered for an agent by
+  // allocation runs.
+  process::metrics::Counter allocation_run_frameworks_visited;
+
   // Gauges for the total amount of each resource in the cluster.
   std::vector<process::metrics::Gauge> resources_total;
 
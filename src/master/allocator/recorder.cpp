@@ -0,0 +1,628 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "master/allocator/recorder.hpp"
+
+#include <fcntl.h>
+
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
+#include <stout/recordio.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/write.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+using process::Process;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// The size of the batches in which calls are written, and the maximum
+// time calls are buffered before being written.
+constexpr Bytes RECORDER_BATCH_SIZE = Megabytes(1);
+constexpr Duration RECORDER_FLUSH_INTERVAL = Seconds(1);
+
+// The maximum number of calls waiting to be written, above which the
+// recording is stopped.
+constexpr size_t RECORDER_MAX_PENDING_CALLS = 100000;
+
+
+class RecorderProcess : public Process<RecorderProcess>
+{
+public:
+  RecorderProcess(
+      int_fd _fd,
+      const string& _path,
+      std::atomic<size_t>* _pending,
+      std::atomic<bool>* _stopped)
+    : ProcessBase(process::ID::generate("allocator-recorder")),
+      fd(_fd),
+      path(_path),
+      pending(_pending),
+      stopped(_stopped),
+      encoder([](const Call& call) { return call.SerializeAsString(); }) {}
+
+  virtual ~RecorderProcess() {}
+
+  void record(const Call& call)
+  {
+    pending->fetch_sub(1);
+
+    // Calls dispatched before the recording was stopped are dropped,
+    // since the trace must remain a prefix of the recorded calls.
+    if (stopped->load()) {
+      return;
+    }
+
+    buffer += encoder.encode(call);
+
+    if (buffer.size() >= RECORDER_BATCH_SIZE.bytes()) {
+      flush();
+    }
+  }
+
+protected:
+  virtual void initialize()
+  {
+    tick();
+  }
+
+  virtual void finalize()
+  {
+    flush();
+
+    if (fd.isSome()) {
+      os::close(fd.get());
+    }
+  }
+
+private:
+  void tick()
+  {
+    flush();
+    process::delay(RECORDER_FLUSH_INTERVAL, self(), &RecorderProcess::tick);
+  }
+
+  void flush()
+  {
+    if (stopped->load()) {
+      buffer.clear();
+    }
+
+    if (buffer.empty() || fd.isNone()) {
+      return;
+    }
+
+    Try<Nothing> write = os::write(fd.get(), buffer);
+    buffer.clear();
+
+    // Nothing is written after a failed write, which might have left
+    // a truncated call at the end of the trace.
+    if (write.isError()) {
+      os::close(fd.get());
+      fd = None();
+
+      if (!stopped->exchange(true)) {
+        LOG(ERROR) << "Stopped recording the allocator calls: Failed to"
+                   << " write to '" << path << "': " << write.error();
+      }
+    }
+  }
+
+  Option<int_fd> fd;
+  const string path;
+
+  std::atomic<size_t>* pending;
+  std::atomic<bool>* stopped;
+
+  ::recordio::Encoder<Call> encoder;
+
+  string buffer;
+};
+
+
+Try<Recorder*> Recorder::create(const string& path)
+{
+  Try<int_fd> fd = os::open(
+      path,
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  return new Recorder(fd.get(), path);
+}
+
+
+Recorder::Recorder(int_fd fd, const string& path)
+  : pending(0),
+    stopped(false)
+{
+  process = new RecorderProcess(fd, path, &pending, &stopped);
+  process::spawn(process);
+}
+
+
+Recorder::~Recorder()
+{
+  // Let the process write the calls that were already recorded.
+  process::terminate(process, false);
+  process::wait(process);
+  delete process;
+}
+
+
+Call Recorder::call(Call::Type type)
+{
+  Call call;
+  call.set_type(type);
+  call.mutable_timestamp()->CopyFrom(protobuf::getCurrentTime());
+  return call;
+}
+
+
+void Recorder::record(Call&& call)
+{
+  if (stopped.load()) {
+    return;
+  }
+
+  // NOTE: Since `pending` is only decremented by the process, a
+  // concurrent call may at worst see the limit exceeded by one.
+  if (pending.fetch_add(1) >= RECORDER_MAX_PENDING_CALLS) {
+    pending.fetch_sub(1);
+
+    if (!stopped.exchange(true)) {
+      LOG(WARNING) << "Stopped recording the allocator calls: More than "
+                   << RECORDER_MAX_PENDING_CALLS << " calls are waiting to"
+                   << " be written";
+    }
+
+    return;
+  }
+
+  process::dispatch(process, &RecorderProcess::record, std::move(call));
+}
+
+
+static void setAllocation(
+    Call::Allocation* allocation,
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  allocation->mutable_framework_id()->CopyFrom(frameworkId);
+  allocation->mutable_slave_id()->CopyFrom(slaveId);
+  *allocation->mutable_resources() = resources;
+}
+
+
+void Recorder::initialize(
+    const Duration& allocationInterval,
+    const Option<set<string>>& fairnessExcludeResourceNames,
+    bool filterGpuResources,
+    const Option<DomainInfo>& domain,
+    size_t allocationThreads,
+    const Option<Duration>& allocationSweepInterval)
+{
+  Call call = Recorder::call(Call::INITIALIZE);
+  Call::Initialize* initialize = call.mutable_initialize();
+
+  initialize->mutable_allocation_interval()->set_nanoseconds(
+      allocationInterval.ns());
+
+  if (fairnessExcludeResourceNames.isSome()) {
+    foreach (const string& name, fairnessExcludeResourceNames.get()) {
+      initialize->add_fairness_excluded_resource_names(name);
+    }
+  }
+
+  initialize->set_filter_gpu_resources(filterGpuResources);
+
+  if (domain.isSome()) {
+    initialize->mutable_domain()->CopyFrom(domain.get());
+  }
+
+  initialize->set_allocation_threads(allocationThreads);
+
+  if (allocationSweepInterval.isSome()) {
+    initialize->mutable_allocation_sweep_interval()->set_nanoseconds(
+        allocationSweepInterval->ns());
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::recover(
+    const int expectedAgentCount,
+    const hashmap<string, Quota>& quotas)
+{
+  Call call = Recorder::call(Call::RECOVER);
+  call.mutable_recover()->set_expected_agent_count(expectedAgentCount);
+
+  foreachvalue (const Quota& quota, quotas) {
+    call.mutable_recover()->add_quotas()->CopyFrom(quota.info);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::addFramework(
+    const FrameworkID& frameworkId,
+    const FrameworkInfo& frameworkInfo,
+    const hashmap<SlaveID, Resources>& used,
+    bool active,
+    const set<string>& suppressedRoles)
+{
+  Call call = Recorder::call(Call::ADD_FRAMEWORK);
+  Call::AddFramework* addFramework = call.mutable_add_framework();
+
+  addFramework->mutable_framework_info()->CopyFrom(frameworkInfo);
+  addFramework->mutable_framework_info()->mutable_id()->CopyFrom(frameworkId);
+
+  foreachpair (const SlaveID& slaveId, const Resources& resources, used) {
+    setAllocation(addFramework->add_used(), frameworkId, slaveId, resources);
+  }
+
+  addFramework->set_active(active);
+
+  foreach (const string& role, suppressedRoles) {
+    addFramework->add_suppressed_roles(role);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::removeFramework(const FrameworkID& frameworkId)
+{
+  Call call = Recorder::call(Call::REMOVE_FRAMEWORK);
+  call.mutable_framework_id()->CopyFrom(frameworkId);
+  record(std::move(call));
+}
+
+
+void Recorder::activateFramework(const FrameworkID& frameworkId)
+{
+  Call call = Recorder::call(Call::ACTIVATE_FRAMEWORK);
+  call.mutable_framework_id()->CopyFrom(frameworkId);
+  record(std::move(call));
+}
+
+
+void Recorder::deactivateFramework(const FrameworkID& frameworkId)
+{
+  Call call = Recorder::call(Call::DEACTIVATE_FRAMEWORK);
+  call.mutable_framework_id()->CopyFrom(frameworkId);
+  record(std::move(call));
+}
+
+
+void Recorder::updateFramework(
+    const FrameworkID& frameworkId,
+    const FrameworkInfo& frameworkInfo,
+    const set<string>& suppressedRoles)
+{
+  Call call = Recorder::call(Call::UPDATE_FRAMEWORK);
+  Call::UpdateFramework* updateFramework = call.mutable_update_framework();
+
+  updateFramework->mutable_framework_info()->CopyFrom(frameworkInfo);
+  updateFramework->mutable_framework_info()->mutable_id()->CopyFrom(
+      frameworkId);
+
+  foreach (const string& role, suppressedRoles) {
+    updateFramework->add_suppressed_roles(role);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::addSlave(
+    const SlaveID& slaveId,
+    const SlaveInfo& slaveInfo,
+    const vector<SlaveInfo::Capability>& capabilities,
+    const Option<Unavailability>& unavailability,
+    const Resources& total,
+    const hashmap<FrameworkID, Resources>& used)
+{
+  Call call = Recorder::call(Call::ADD_SLAVE);
+  Call::AddSlave* addSlave = call.mutable_add_slave();
+
+  addSlave->mutable_slave_info()->CopyFrom(slaveInfo);
+  addSlave->mutable_slave_info()->mutable_id()->CopyFrom(slaveId);
+
+  foreach (const SlaveInfo::Capability& capability, capabilities) {
+    addSlave->add_capabilities()->CopyFrom(capability);
+  }
+
+  if (unavailability.isSome()) {
+    addSlave->mutable_unavailability()->CopyFrom(unavailability.get());
+  }
+
+  *addSlave->mutable_total() = total;
+
+  foreachpair (const FrameworkID& frameworkId,
+               const Resources& resources,
+               used) {
+    setAllocation(addSlave->add_used(), frameworkId, slaveId, resources);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::removeSlave(const SlaveID& slaveId)
+{
+  Call call = Recorder::call(Call::REMOVE_SLAVE);
+  call.mutable_slave_id()->CopyFrom(slaveId);
+  record(std::move(call));
+}
+
+
+void Recorder::updateSlave(
+    const SlaveID& slaveId,
+    const SlaveInfo& slaveInfo,
+    const Option<Resources>& total,
+    const Option<vector<SlaveInfo::Capability>>& capabilities)
+{
+  Call call = Recorder::call(Call::UPDATE_SLAVE);
+  Call::UpdateSlave* updateSlave = call.mutable_update_slave();
+
+  updateSlave->mutable_slave_info()->CopyFrom(slaveInfo);
+  updateSlave->mutable_slave_info()->mutable_id()->CopyFrom(slaveId);
+
+  updateSlave->set_update_total(total.isSome());
+  if (total.isSome()) {
+    *updateSlave->mutable_total() = total.get();
+  }
+
+  updateSlave->set_update_capabilities(capabilities.isSome());
+  if (capabilities.isSome()) {
+    foreach (const SlaveInfo::Capability& capability, capabilities.get()) {
+      updateSlave->add_capabilities()->CopyFrom(capability);
+    }
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::addResourceProvider(
+    const SlaveID& slaveId,
+    const Resources& total,
+    const hashmap<FrameworkID, Resources>& used)
+{
+  Call call = Recorder::call(Call::ADD_RESOURCE_PROVIDER);
+  Call::AddResourceProvider* addResourceProvider =
+    call.mutable_add_resource_provider();
+
+  addResourceProvider->mutable_slave_id()->CopyFrom(slaveId);
+  *addResourceProvider->mutable_total() = total;
+
+  foreachpair (const FrameworkID& frameworkId,
+               const Resources& resources,
+               used) {
+    setAllocation(
+        addResourceProvider->add_used(), frameworkId, slaveId, resources);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::activateSlave(const SlaveID& slaveId)
+{
+  Call call = Recorder::call(Call::ACTIVATE_SLAVE);
+  call.mutable_slave_id()->CopyFrom(slaveId);
+  record(std::move(call));
+}
+
+
+void Recorder::deactivateSlave(const SlaveID& slaveId)
+{
+  Call call = Recorder::call(Call::DEACTIVATE_SLAVE);
+  call.mutable_slave_id()->CopyFrom(slaveId);
+  record(std::move(call));
+}
+
+
+void Recorder::updateWhitelist(const Option<hashset<string>>& whitelist)
+{
+  Call call = Recorder::call(Call::UPDATE_WHITELIST);
+  Call::UpdateWhitelist* updateWhitelist = call.mutable_update_whitelist();
+
+  // NOTE: The whitelist is set even if it is empty, since an empty
+  // whitelist (i.e., no agent is whitelisted) differs from none.
+  if (whitelist.isSome()) {
+    Call::UpdateWhitelist::Whitelist* whitelist_ =
+      updateWhitelist->mutable_whitelist();
+
+    foreach (const string& hostname, whitelist.get()) {
+      whitelist_->add_hostnames(hostname);
+    }
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::updateAllocation(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& offeredResources,
+    const vector<ResourceConversion>& conversions)
+{
+  Call call = Recorder::call(Call::UPDATE_ALLOCATION);
+  Call::UpdateAllocation* updateAllocation = call.mutable_update_allocation();
+
+  setAllocation(
+      updateAllocation->mutable_offered(),
+      frameworkId,
+      slaveId,
+      offeredResources);
+
+  foreach (const ResourceConversion& conversion, conversions) {
+    Call::UpdateAllocation::Conversion* conversion_ =
+      updateAllocation->add_conversions();
+
+    *conversion_->mutable_consumed() = conversion.consumed;
+    *conversion_->mutable_converted() = conversion.converted;
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::updateAvailable(
+    const SlaveID& slaveId,
+    const vector<Offer::Operation>& operations)
+{
+  Call call = Recorder::call(Call::UPDATE_AVAILABLE);
+  call.mutable_update_available()->mutable_slave_id()->CopyFrom(slaveId);
+
+  foreach (const Offer::Operation& operation, operations) {
+    call.mutable_update_available()->add_operations()->CopyFrom(operation);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::updateUnavailability(
+    const SlaveID& slaveId,
+    const Option<Unavailability>& unavailability)
+{
+  Call call = Recorder::call(Call::UPDATE_UNAVAILABILITY);
+  Call::UpdateUnavailability* updateUnavailability =
+    call.mutable_update_unavailability();
+
+  updateUnavailability->mutable_slave_id()->CopyFrom(slaveId);
+
+  if (unavailability.isSome()) {
+    updateUnavailability->mutable_unavailability()->CopyFrom(
+        unavailability.get());
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::recoverResources(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources,
+    const Option<Filters>& filters)
+{
+  Call call = Recorder::call(Call::RECOVER_RESOURCES);
+  Call::RecoverResources* recoverResources = call.mutable_recover_resources();
+
+  setAllocation(
+      recoverResources->mutable_resources(), frameworkId, slaveId, resources);
+
+  if (filters.isSome()) {
+    recoverResources->mutable_filters()->CopyFrom(filters.get());
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::suppressOffers(
+    const FrameworkID& frameworkId,
+    const set<string>& roles)
+{
+  Call call = Recorder::call(Call::SUPPRESS_OFFERS);
+  call.mutable_framework_id()->CopyFrom(frameworkId);
+
+  foreach (const string& role, roles) {
+    call.mutable_suppress_offers()->add_roles(role);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::reviveOffers(
+    const FrameworkID& frameworkId,
+    const set<string>& roles)
+{
+  Call call = Recorder::call(Call::REVIVE_OFFERS);
+  call.mutable_framework_id()->CopyFrom(frameworkId);
+
+  foreach (const string& role, roles) {
+    call.mutable_revive_offers()->add_roles(role);
+  }
+
+  record(std::move(call));
+}
+
+
+void Recorder::setQuota(const string& role, const Quota& quota)
+{
+  Call call = Recorder::call(Call::SET_QUOTA);
+  call.mutable_set_quota()->CopyFrom(quota.info);
+  call.mutable_set_quota()->set_role(role);
+  record(std::move(call));
+}
+
+
+void Recorder::removeQuota(const string& role)
+{
+  Call call = Recorder::call(Call::REMOVE_QUOTA);
+  call.set_role(role);
+  record(std::move(call));
+}
+
+
+void Recorder::updateWeights(const vector<WeightInfo>& weightInfos)
+{
+  Call call = Recorder::call(Call::UPDATE_WEIGHTS);
+
+  foreach (const WeightInfo& weightInfo, weightInfos) {
+    call.add_update_weights()->CopyFrom(weightInfo);
+  }
+
+  record(std::move(call));
+}
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
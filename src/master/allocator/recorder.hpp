@@ -0,0 +1,178 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ALLOCATOR_RECORDER_HPP__
+#define __MASTER_ALLOCATOR_RECORDER_HPP__
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <mesos/quota/quota.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/int_fd.hpp>
+
+#include "master/allocator/trace.pb.h"
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+class RecorderProcess;
+
+// Records the calls made to an allocator as an allocator trace (see
+// `trace.proto`), e.g., to replay them with the allocator simulator.
+//
+// Recording a call only copies its arguments into a protobuf; the
+// calls are serialized and written in batches by a separate process.
+// If writing falls behind (or fails), the recording is stopped rather
+// than individual calls being dropped, so that the trace stays
+// consistent and the allocator never waits for the disk.
+class Recorder
+{
+public:
+  // Creates a recorder that (over)writes the trace at `path`.
+  static Try<Recorder*> create(const std::string& path);
+
+  ~Recorder();
+
+  void initialize(
+      const Duration& allocationInterval,
+      const Option<std::set<std::string>>& fairnessExcludeResourceNames,
+      bool filterGpuResources,
+      const Option<DomainInfo>& domain,
+      size_t allocationThreads,
+      const Option<Duration>& allocationSweepInterval);
+
+  void recover(
+      const int expectedAgentCount,
+      const hashmap<std::string, Quota>& quotas);
+
+  void addFramework(
+      const FrameworkID& frameworkId,
+      const FrameworkInfo& frameworkInfo,
+      const hashmap<SlaveID, Resources>& used,
+      bool active,
+      const std::set<std::string>& suppressedRoles);
+
+  void removeFramework(const FrameworkID& frameworkId);
+
+  void activateFramework(const FrameworkID& frameworkId);
+
+  void deactivateFramework(const FrameworkID& frameworkId);
+
+  void updateFramework(
+      const FrameworkID& frameworkId,
+      const FrameworkInfo& frameworkInfo,
+      const std::set<std::string>& suppressedRoles);
+
+  void addSlave(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const std::vector<SlaveInfo::Capability>& capabilities,
+      const Option<Unavailability>& unavailability,
+      const Resources& total,
+      const hashmap<FrameworkID, Resources>& used);
+
+  void removeSlave(const SlaveID& slaveId);
+
+  void updateSlave(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const Option<Resources>& total,
+      const Option<std::vector<SlaveInfo::Capability>>& capabilities);
+
+  void addResourceProvider(
+      const SlaveID& slaveId,
+      const Resources& total,
+      const hashmap<FrameworkID, Resources>& used);
+
+  void activateSlave(const SlaveID& slaveId);
+
+  void deactivateSlave(const SlaveID& slaveId);
+
+  void updateWhitelist(const Option<hashset<std::string>>& whitelist);
+
+  void updateAllocation(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& offeredResources,
+      const std::vector<ResourceConversion>& conversions);
+
+  void updateAvailable(
+      const SlaveID& slaveId,
+      const std::vector<Offer::Operation>& operations);
+
+  void updateUnavailability(
+      const SlaveID& slaveId,
+      const Option<Unavailability>& unavailability);
+
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const Option<Filters>& filters);
+
+  void suppressOffers(
+      const FrameworkID& frameworkId,
+      const std::set<std::string>& roles);
+
+  void reviveOffers(
+      const FrameworkID& frameworkId,
+      const std::set<std::string>& roles);
+
+  void setQuota(const std::string& role, const Quota& quota);
+
+  void removeQuota(const std::string& role);
+
+  void updateWeights(const std::vector<WeightInfo>& weightInfos);
+
+private:
+  Recorder(int_fd fd, const std::string& path);
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  // Returns a call of the given type, made now.
+  static Call call(Call::Type type);
+
+  void record(Call&& call);
+
+  RecorderProcess* process;
+
+  // The number of calls that have not been written yet, and whether
+  // the recording was stopped. Shared with the process.
+  std::atomic<size_t> pending;
+  std::atomic<bool> stopped;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_RECORDER_HPP__
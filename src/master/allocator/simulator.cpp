@@ -0,0 +1,1066 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays a trace of allocator calls (see `master/allocator/trace.proto`)
+// against the hierarchical DRF allocator, and reports the allocation
+// latency as well as the fairness and utilization of the allocations.
+//
+// The replay runs on a paused clock: between two calls the clock is
+// advanced to the time of the next call in steps of (at most) the
+// allocation interval, and the allocator is settled after each step
+// and each call. Hence a trace of hours is replayed as fast as the
+// allocator can process it, and the reported latencies are the (wall
+// clock) time the allocator took to process each step or call.
+//
+// NOTE: The simulated offers will differ from the recorded ones as
+// soon as the allocator behaves differently than the recorded one
+// (e.g., due to a different configuration or implementation). Since
+// the frameworks are not simulated, a recorded recovery of resources
+// is mapped onto the simulated allocation: if the framework holds the
+// recorded resources on the agent they are recovered, otherwise all
+// the resources the framework holds for the same roles on the agent
+// are recovered.
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/allocator/allocator.hpp>
+
+#include <mesos/quota/quota.hpp>
+
+#include <process/clock.hpp>
+#include <process/time.hpp>
+
+#include <stout/check.hpp>
+#include <stout/duration.hpp>
+#include <stout/flags.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/recordio.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/read.hpp>
+
+#include "common/protobuf_utils.hpp"
+#include "common/resource_quantities.hpp"
+
+#include "master/allocator/trace.pb.h"
+
+#include "master/allocator/mesos/hierarchical.hpp"
+
+using namespace mesos;
+using namespace mesos::internal;
+
+using mesos::allocator::Allocator;
+
+using mesos::internal::master::allocator::AllocatorOptions;
+using mesos::internal::master::allocator::Call;
+using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+
+using mesos::internal::protobuf::framework::getRoles;
+
+using mesos::quota::QuotaInfo;
+
+using process::Clock;
+using process::Time;
+
+using std::cerr;
+using std::cout;
+using std::deque;
+using std::endl;
+using std::set;
+using std::string;
+using std::vector;
+
+
+class Flags : public virtual flags::FlagsBase
+{
+public:
+  Flags()
+  {
+    add(&Flags::trace,
+        "trace",
+        "Path of the allocator trace to replay, i.e., of the \"recordio\"\n"
+        "encoded allocator calls.");
+
+    add(&Flags::allocation_interval,
+        "allocation_interval",
+        "Overrides the allocation interval of the trace.");
+
+    add(&Flags::allocation_threads,
+        "allocation_threads",
+        "Overrides the number of allocation threads of the trace.");
+
+    add(&Flags::allocation_sweep_interval,
+        "allocation_sweep_interval",
+        "Overrides the allocation sweep interval of the trace.");
+  }
+
+  Option<string> trace;
+  Option<Duration> allocation_interval;
+  Option<size_t> allocation_threads;
+  Option<Duration> allocation_sweep_interval;
+};
+
+
+// Returns the given percentile of the sorted `values`.
+static Duration percentile(const vector<Duration>& values, double p)
+{
+  CHECK(!values.empty());
+
+  size_t index = static_cast<size_t>(p * values.size());
+
+  return values[std::min(index, values.size() - 1)];
+}
+
+
+static void printLatencies(const string& name, vector<Duration> latencies)
+{
+  if (latencies.empty()) {
+    cout << name << ": none" << endl;
+    return;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  cout << name << " (" << latencies.size() << "):"
+       << " p50=" << percentile(latencies, 0.5)
+       << " p90=" << percentile(latencies, 0.9)
+       << " p99=" << percentile(latencies, 0.99)
+       << " p999=" << percentile(latencies, 0.999)
+       << " max=" << latencies.back() << endl;
+}
+
+
+static hashmap<FrameworkID, Resources> allocations(
+    const google::protobuf::RepeatedPtrField<Call::Allocation>& used)
+{
+  hashmap<FrameworkID, Resources> result;
+
+  foreach (const Call::Allocation& allocation, used) {
+    result[allocation.framework_id()] += allocation.resources();
+  }
+
+  return result;
+}
+
+
+class Simulator
+{
+public:
+  explicit Simulator(const Flags& _flags)
+    : flags(_flags),
+      allocator(nullptr) {}
+
+  ~Simulator() { delete allocator; }
+
+  // Replays the call, after advancing the clock to the time of the
+  // call. Returns false if the call was skipped because it is not
+  // consistent with the simulated state (e.g., the framework is not
+  // known) or it is not supported.
+  bool replay(const Call& call);
+
+  // Lets the allocator run another allocation interval after the
+  // last call of the trace.
+  void finish();
+
+  void report() const;
+
+private:
+  void initialize(const Call::Initialize& initialize);
+
+  // Advances the clock to the given (trace) time in steps of at most
+  // the allocation interval, sampling the allocations after each step.
+  void advance(const Time& time);
+
+  // Waits for the allocator to process all dispatched calls, and
+  // returns how long it took.
+  Duration settle();
+
+  void sample(const Duration& elapsed);
+
+  // Recovers the resources of the framework on the agent that
+  // correspond to the recorded `resources`, see the top of the file.
+  bool recover(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const Option<Filters>& filters);
+
+  // Recovers all the resources of the framework on the agent.
+  void recover(const FrameworkID& frameworkId, const SlaveID& slaveId);
+
+  void offer(
+      const FrameworkID& frameworkId,
+      const hashmap<string, hashmap<SlaveID, Resources>>& resources);
+
+  const Flags flags;
+
+  Allocator* allocator;
+
+  bool initialized = false;
+  Duration allocationInterval;
+  set<string> fairnessExcludeResourceNames;
+
+  // The start of the trace, and the corresponding (paused) time of
+  // the clock.
+  Option<Time> traceStart;
+  Time clockStart;
+
+  // The simulated state.
+  hashmap<FrameworkID, set<string>> frameworks;
+  hashmap<SlaveID, Resources> totals;
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> allocated;
+  hashset<string> quotas;
+  hashmap<string, double> weights;
+
+  // The offers are made from the allocator (and possibly from its
+  // allocation threads) while the resources are accounted for in
+  // `allocated` when settling.
+  std::mutex mutex;
+  vector<std::pair<FrameworkID, hashmap<SlaveID, Resources>>> offers;
+
+  // The statistics.
+  size_t replayed = 0;
+  hashmap<string, size_t> skipped;
+  size_t offerCount = 0;
+  vector<Duration> stepLatencies;
+  vector<Duration> callLatencies;
+
+  // Time weighted sums of the samples, divided by `sampledTime`.
+  double fairness = 0.0;
+  hashmap<string, double> utilization;
+  double sampledTime = 0.0;
+};
+
+
+bool Simulator::replay(const Call& call)
+{
+  if (!initialized && call.type() != Call::INITIALIZE) {
+    skipped[Call::Type_Name(call.type())]++;
+    return false;
+  }
+
+  const Time time =
+    Time::epoch() + Nanoseconds(call.timestamp().nanoseconds());
+
+  if (traceStart.isNone()) {
+    traceStart = time;
+    clockStart = Clock::now();
+  }
+
+  advance(time);
+
+  bool consistent = true;
+
+  switch (call.type()) {
+    case Call::INITIALIZE: {
+      if (initialized || !call.has_initialize()) {
+        consistent = false;
+        break;
+      }
+
+      initialize(call.initialize());
+      break;
+    }
+
+    case Call::RECOVER: {
+      if (!call.has_recover() || !totals.empty()) {
+        consistent = false;
+        break;
+      }
+
+      hashmap<string, Quota> quotas_;
+      foreach (const QuotaInfo& info, call.recover().quotas()) {
+        quotas_[info.role()].info = info;
+        quotas.insert(info.role());
+      }
+
+      allocator->recover(call.recover().expected_agent_count(), quotas_);
+      break;
+    }
+
+    case Call::ADD_FRAMEWORK: {
+      const Call::AddFramework& add = call.add_framework();
+      const FrameworkID& frameworkId = add.framework_info().id();
+
+      if (!call.has_add_framework() || frameworks.contains(frameworkId)) {
+        consistent = false;
+        break;
+      }
+
+      // NOTE: The resources used on known agents are accounted for
+      // when the agents were added, see `HierarchicalAllocatorProcess`.
+      hashmap<SlaveID, Resources> used;
+      foreach (const Call::Allocation& allocation, add.used()) {
+        used[allocation.slave_id()] += allocation.resources();
+      }
+
+      const set<string> suppressedRoles(
+          add.suppressed_roles().begin(), add.suppressed_roles().end());
+
+      frameworks[frameworkId] = getRoles(
+          add.framework_info());
+
+      allocator->addFramework(
+          frameworkId,
+          add.framework_info(),
+          used,
+          add.active(),
+          suppressedRoles);
+      break;
+    }
+
+    case Call::REMOVE_FRAMEWORK: {
+      if (!frameworks.contains(call.framework_id())) {
+        consistent = false;
+        break;
+      }
+
+      // The master recovers the resources of a framework before
+      // removing it, but the simulated allocation differs from the
+      // recorded one, so we recover what is left.
+      if (allocated.contains(call.framework_id())) {
+        foreach (const SlaveID& slaveId,
+                 allocated.at(call.framework_id()).keys()) {
+          recover(call.framework_id(), slaveId);
+        }
+      }
+
+      frameworks.erase(call.framework_id());
+      allocated.erase(call.framework_id());
+
+      allocator->removeFramework(call.framework_id());
+      break;
+    }
+
+    case Call::ACTIVATE_FRAMEWORK:
+    case Call::DEACTIVATE_FRAMEWORK: {
+      if (!frameworks.contains(call.framework_id())) {
+        consistent = false;
+        break;
+      }
+
+      if (call.type() == Call::ACTIVATE_FRAMEWORK) {
+        allocator->activateFramework(call.framework_id());
+      } else {
+        allocator->deactivateFramework(call.framework_id());
+      }
+      break;
+    }
+
+    case Call::UPDATE_FRAMEWORK: {
+      const Call::UpdateFramework& update = call.update_framework();
+      const FrameworkID& frameworkId = update.framework_info().id();
+
+      if (!call.has_update_framework() || !frameworks.contains(frameworkId)) {
+        consistent = false;
+        break;
+      }
+
+      const set<string> suppressedRoles(
+          update.suppressed_roles().begin(),
+          update.suppressed_roles().end());
+
+      frameworks[frameworkId] = getRoles(
+          update.framework_info());
+
+      allocator->updateFramework(
+          frameworkId, update.framework_info(), suppressedRoles);
+      break;
+    }
+
+    case Call::ADD_SLAVE: {
+      const Call::AddSlave& add = call.add_slave();
+      const SlaveID& slaveId = add.slave_info().id();
+
+      if (!call.has_add_slave() || totals.contains(slaveId)) {
+        consistent = false;
+        break;
+      }
+
+      const vector<SlaveInfo::Capability> capabilities(
+          add.capabilities().begin(), add.capabilities().end());
+
+      Option<Unavailability> unavailability;
+      if (add.has_unavailability()) {
+        unavailability = add.unavailability();
+      }
+
+      const hashmap<FrameworkID, Resources> used = allocations(add.used());
+
+      totals[slaveId] = add.total();
+
+      foreachpair (const FrameworkID& frameworkId,
+                   const Resources& resources,
+                   used) {
+        allocated[frameworkId][slaveId] += resources;
+      }
+
+      allocator->addSlave(
+          slaveId,
+          add.slave_info(),
+          capabilities,
+          unavailability,
+          add.total(),
+          used);
+      break;
+    }
+
+    case Call::REMOVE_SLAVE: {
+      if (!totals.contains(call.slave_id())) {
+        consistent = false;
+        break;
+      }
+
+      // As with frameworks, the master recovers the resources on an
+      // agent before removing it (see MESOS-621).
+      foreach (const FrameworkID& frameworkId, allocated.keys()) {
+        recover(frameworkId, call.slave_id());
+      }
+
+      totals.erase(call.slave_id());
+
+      allocator->removeSlave(call.slave_id());
+      break;
+    }
+
+    case Call::UPDATE_SLAVE: {
+      const Call::UpdateSlave& update = call.update_slave();
+      const SlaveID& slaveId = update.slave_info().id();
+
+      if (!call.has_update_slave() || !totals.contains(slaveId)) {
+        consistent = false;
+        break;
+      }
+
+      Option<Resources> total;
+      if (update.update_total()) {
+        total = Resources(update.total());
+        totals[slaveId] = total.get();
+      }
+
+      Option<vector<SlaveInfo::Capability>> capabilities;
+      if (update.update_capabilities()) {
+        capabilities = vector<SlaveInfo::Capability>(
+            update.capabilities().begin(), update.capabilities().end());
+      }
+
+      allocator->updateSlave(slaveId, update.slave_info(), total, capabilities);
+      break;
+    }
+
+    case Call::ADD_RESOURCE_PROVIDER: {
+      const Call::AddResourceProvider& add = call.add_resource_provider();
+
+      if (!call.has_add_resource_provider() ||
+          !totals.contains(add.slave_id())) {
+        consistent = false;
+        break;
+      }
+
+      const hashmap<FrameworkID, Resources> used = allocations(add.used());
+
+      totals[add.slave_id()] += add.total();
+
+      foreachpair (const FrameworkID& frameworkId,
+                   const Resources& resources,
+                   used) {
+        allocated[frameworkId][add.slave_id()] += resources;
+      }
+
+      allocator->addResourceProvider(add.slave_id(), add.total(), used);
+      break;
+    }
+
+    case Call::ACTIVATE_SLAVE:
+    case Call::DEACTIVATE_SLAVE: {
+      if (!totals.contains(call.slave_id())) {
+        consistent = false;
+        break;
+      }
+
+      if (call.type() == Call::ACTIVATE_SLAVE) {
+        allocator->activateSlave(call.slave_id());
+      } else {
+        allocator->deactivateSlave(call.slave_id());
+      }
+      break;
+    }
+
+    case Call::UPDATE_WHITELIST: {
+      Option<hashset<string>> whitelist;
+
+      if (call.update_whitelist().has_whitelist()) {
+        whitelist = hashset<string>();
+
+        foreach (const string& hostname,
+                 call.update_whitelist().whitelist().hostnames()) {
+          whitelist->insert(hostname);
+        }
+      }
+
+      allocator->updateWhitelist(whitelist);
+      break;
+    }
+
+    case Call::UPDATE_ALLOCATION: {
+      const Call::Allocation& offered = call.update_allocation().offered();
+      const FrameworkID& frameworkId = offered.framework_id();
+      const SlaveID& slaveId = offered.slave_id();
+      const Resources offeredResources = offered.resources();
+
+      // The framework can only operate on the resources which were
+      // also offered to it in the simulation.
+      if (!call.has_update_allocation() ||
+          !frameworks.contains(frameworkId) ||
+          !totals.contains(slaveId) ||
+          !allocated.contains(frameworkId) ||
+          !allocated.at(frameworkId).contains(slaveId) ||
+          !allocated.at(frameworkId).at(slaveId).contains(offeredResources)) {
+        consistent = false;
+        break;
+      }
+
+      vector<ResourceConversion> conversions;
+      foreach (const Call::UpdateAllocation::Conversion& conversion,
+               call.update_allocation().conversions()) {
+        conversions.emplace_back(
+            Resources(conversion.consumed()),
+            Resources(conversion.converted()));
+      }
+
+      Try<Resources> updated = offeredResources.apply(conversions);
+      if (updated.isError()) {
+        consistent = false;
+        break;
+      }
+
+      Resources& allocation = allocated.at(frameworkId).at(slaveId);
+      allocation -= offeredResources;
+      allocation += updated.get();
+
+      allocator->updateAllocation(
+          frameworkId, slaveId, offeredResources, conversions);
+      break;
+    }
+
+    case Call::UPDATE_AVAILABLE: {
+      const Call::UpdateAvailable& update = call.update_available();
+
+      if (!call.has_update_available() ||
+          !totals.contains(update.slave_id())) {
+        consistent = false;
+        break;
+      }
+
+      // NOTE: The update fails if the resources are not available in
+      // the simulation, which is what the master would observe.
+      allocator->updateAvailable(
+          update.slave_id(),
+          vector<Offer::Operation>(
+              update.operations().begin(), update.operations().end()));
+      break;
+    }
+
+    case Call::UPDATE_UNAVAILABILITY: {
+      const Call::UpdateUnavailability& update =
+        call.update_unavailability();
+
+      if (!call.has_update_unavailability() ||
+          !totals.contains(update.slave_id())) {
+        consistent = false;
+        break;
+      }
+
+      Option<Unavailability> unavailability;
+      if (update.has_unavailability()) {
+        unavailability = update.unavailability();
+      }
+
+      allocator->updateUnavailability(update.slave_id(), unavailability);
+      break;
+    }
+
+    case Call::RECOVER_RESOURCES: {
+      const Call::RecoverResources& recover_ = call.recover_resources();
+
+      Option<Filters> filters;
+      if (recover_.has_filters()) {
+        filters = recover_.filters();
+      }
+
+      consistent = call.has_recover_resources() &&
+        recover(
+            recover_.resources().framework_id(),
+            recover_.resources().slave_id(),
+            recover_.resources().resources(),
+            filters);
+      break;
+    }
+
+    case Call::SUPPRESS_OFFERS:
+    case Call::REVIVE_OFFERS: {
+      if (!frameworks.contains(call.framework_id())) {
+        consistent = false;
+        break;
+      }
+
+      const Call::Roles& roles_ = call.type() == Call::SUPPRESS_OFFERS
+        ? call.suppress_offers()
+        : call.revive_offers();
+
+      const set<string> roles(roles_.roles().begin(), roles_.roles().end());
+
+      if (call.type() == Call::SUPPRESS_OFFERS) {
+        allocator->suppressOffers(call.framework_id(), roles);
+      } else {
+        allocator->reviveOffers(call.framework_id(), roles);
+      }
+      break;
+    }
+
+    case Call::SET_QUOTA: {
+      if (!call.has_set_quota() || quotas.contains(call.set_quota().role())) {
+        consistent = false;
+        break;
+      }
+
+      Quota quota;
+      quota.info = call.set_quota();
+
+      quotas.insert(quota.info.role());
+
+      allocator->setQuota(quota.info.role(), quota);
+      break;
+    }
+
+    case Call::REMOVE_QUOTA: {
+      if (!quotas.contains(call.role())) {
+        consistent = false;
+        break;
+      }
+
+      quotas.erase(call.role());
+
+      allocator->removeQuota(call.role());
+      break;
+    }
+
+    case Call::UPDATE_WEIGHTS: {
+      foreach (const WeightInfo& weight, call.update_weights()) {
+        weights[weight.role()] = weight.weight();
+      }
+
+      allocator->updateWeights(vector<WeightInfo>(
+          call.update_weights().begin(), call.update_weights().end()));
+      break;
+    }
+
+    case Call::UNKNOWN: {
+      consistent = false;
+      break;
+    }
+  }
+
+  if (!consistent) {
+    skipped[Call::Type_Name(call.type())]++;
+    return false;
+  }
+
+  replayed++;
+  callLatencies.push_back(settle());
+
+  return true;
+}
+
+
+void Simulator::initialize(const Call::Initialize& initialize)
+{
+  allocationInterval = flags.allocation_interval.getOrElse(
+      Nanoseconds(initialize.allocation_interval().nanoseconds()));
+
+  fairnessExcludeResourceNames = set<string>(
+      initialize.fairness_excluded_resource_names().begin(),
+      initialize.fairness_excluded_resource_names().end());
+
+  Option<set<string>> excluded;
+  if (!fairnessExcludeResourceNames.empty()) {
+    excluded = fairnessExcludeResourceNames;
+  }
+
+  Option<DomainInfo> domain;
+  if (initialize.has_domain()) {
+    domain = initialize.domain();
+  }
+
+  // The allocator is only created now since its options are part of
+  // the recorded initialization.
+  AllocatorOptions options;
+  options.allocationThreads = flags.allocation_threads.getOrElse(
+      initialize.has_allocation_threads()
+        ? initialize.allocation_threads()
+        : 1u);
+
+  options.allocationSweepInterval = flags.allocation_sweep_interval;
+  if (options.allocationSweepInterval.isNone() &&
+      initialize.has_allocation_sweep_interval()) {
+    options.allocationSweepInterval =
+      Nanoseconds(initialize.allocation_sweep_interval().nanoseconds());
+  }
+
+  Try<Allocator*> create = HierarchicalDRFAllocator::create(options);
+  CHECK_SOME(create);
+
+  allocator = create.get();
+
+  allocator->initialize(
+      allocationInterval,
+      lambda::bind(&Simulator::offer, this, lambda::_1, lambda::_2),
+      [](const FrameworkID&, const hashmap<SlaveID, UnavailableResources>&) {},
+      excluded,
+      initialize.has_filter_gpu_resources()
+        ? initialize.filter_gpu_resources()
+        : true,
+      domain);
+
+  initialized = true;
+}
+
+
+void Simulator::advance(const Time& time)
+{
+  const Time target = clockStart + (time - traceStart.get());
+
+  while (initialized && Clock::now() < target) {
+    const Duration step = std::min(allocationInterval, target - Clock::now());
+
+    Clock::advance(step);
+
+    stepLatencies.push_back(settle());
+
+    sample(step);
+  }
+}
+
+
+void Simulator::finish()
+{
+  if (initialized) {
+    const Duration elapsed = Clock::now() - clockStart;
+
+    advance(traceStart.get() + elapsed + allocationInterval);
+  }
+}
+
+
+Duration Simulator::settle()
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Clock::settle();
+
+  const Duration elapsed = stopwatch.elapsed();
+
+  synchronized (mutex) {
+    foreach (auto& offer, offers) {
+      foreachpair (const SlaveID& slaveId,
+                   const Resources& resources,
+                   offer.second) {
+        allocated[offer.first][slaveId] += resources;
+      }
+    }
+
+    offers.clear();
+  }
+
+  return elapsed;
+}
+
+
+void Simulator::offer(
+    const FrameworkID& frameworkId,
+    const hashmap<string, hashmap<SlaveID, Resources>>& resources)
+{
+  synchronized (mutex) {
+    foreachvalue (const auto& resources_, resources) {
+      offers.emplace_back(frameworkId, resources_);
+      offerCount += resources_.size();
+    }
+  }
+}
+
+
+bool Simulator::recover(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources,
+    const Option<Filters>& filters)
+{
+  if (!allocated.contains(frameworkId) ||
+      !allocated.at(frameworkId).contains(slaveId)) {
+    return false;
+  }
+
+  Resources& allocation = allocated.at(frameworkId).at(slaveId);
+
+  Resources recovered = resources;
+
+  if (!allocation.contains(recovered)) {
+    const hashmap<string, Resources> allocations = allocation.allocations();
+
+    recovered = Resources();
+    foreachkey (const string& role, resources.allocations()) {
+      if (allocations.contains(role)) {
+        recovered += allocations.at(role);
+      }
+    }
+  }
+
+  if (recovered.empty()) {
+    return false;
+  }
+
+  allocation -= recovered;
+
+  if (allocation.empty()) {
+    allocated.at(frameworkId).erase(slaveId);
+  }
+
+  allocator->recoverResources(frameworkId, slaveId, recovered, filters);
+
+  return true;
+}
+
+
+void Simulator::recover(const FrameworkID& frameworkId, const SlaveID& slaveId)
+{
+  if (allocated.contains(frameworkId) &&
+      allocated.at(frameworkId).contains(slaveId)) {
+    const Resources resources = allocated.at(frameworkId).at(slaveId);
+
+    allocated.at(frameworkId).erase(slaveId);
+
+    allocator->recoverResources(frameworkId, slaveId, resources, None());
+  }
+}
+
+
+void Simulator::sample(const Duration& elapsed)
+{
+  ResourceQuantities total;
+  foreachvalue (const Resources& resources, totals) {
+    total += ResourceQuantities::fromScalarResources(resources);
+  }
+
+  ResourceQuantities allocatedTotal;
+  hashmap<string, ResourceQuantities> roles;
+
+  foreachvalue (const auto& allocation, allocated) {
+    foreachvalue (const Resources& resources, allocation) {
+      foreachpair (const string& role,
+                   const Resources& resources_,
+                   resources.allocations()) {
+        const ResourceQuantities quantities =
+          ResourceQuantities::fromScalarResources(resources_);
+
+        roles[role] += quantities;
+        allocatedTotal += quantities;
+      }
+    }
+  }
+
+  // Roles with frameworks are considered even without allocations.
+  foreachvalue (const set<string>& roles_, frameworks) {
+    foreach (const string& role, roles_) {
+      roles[role];
+    }
+  }
+
+  const double seconds = elapsed.secs();
+
+  // The fairness is Jain's index of the weighted dominant shares.
+  double sum = 0.0;
+  double squares = 0.0;
+
+  foreachpair (const string& role,
+               const ResourceQuantities& quantities,
+               roles) {
+    double share = 0.0;
+
+    foreach (const ResourceQuantities::Quantity& quantity, total) {
+      const string& name = quantity.first.value();
+
+      if (quantity.second > 0 &&
+          fairnessExcludeResourceNames.count(name) == 0) {
+        share = std::max(
+            share,
+            quantities.get(name).value() / (quantity.second / 1000.0));
+      }
+    }
+
+    share /= weights.contains(role) ? weights.at(role) : 1.0;
+
+    sum += share;
+    squares += share * share;
+  }
+
+  if (squares > 0.0) {
+    fairness += seconds * (sum * sum) / (roles.size() * squares);
+  } else {
+    fairness += seconds;
+  }
+
+  foreach (const ResourceQuantities::Quantity& quantity, total) {
+    if (quantity.second > 0) {
+      const string& name = quantity.first.value();
+
+      utilization[name] += seconds *
+        allocatedTotal.get(name).value() / (quantity.second / 1000.0);
+    }
+  }
+
+  sampledTime += seconds;
+}
+
+
+void Simulator::report() const
+{
+  cout << "Replayed " << replayed << " calls, "
+       << "made " << offerCount << " offers" << endl;
+
+  foreachpair (const string& type, size_t count, skipped) {
+    cout << "Skipped " << count << " " << type << " calls" << endl;
+  }
+
+  printLatencies("Allocation interval latency", stepLatencies);
+  printLatencies("Call latency", callLatencies);
+
+  if (sampledTime > 0.0) {
+    cout << std::fixed << std::setprecision(3)
+         << "Fairness (Jain's index of dominant shares): "
+         << fairness / sampledTime << endl;
+
+    foreachpair (const string& name, double value, utilization) {
+      cout << "Utilization of " << name << ": "
+           << value / sampledTime << endl;
+    }
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  Flags flags;
+  flags.setUsageMessage(
+      "Usage: " + Path(argv[0]).basename() + " --trace=<path> [options]");
+
+  Try<flags::Warnings> load = flags.load(None(), argc, argv);
+
+  if (flags.help) {
+    cout << flags.usage() << endl;
+    return EXIT_SUCCESS;
+  }
+
+  if (load.isError()) {
+    cerr << flags.usage(load.error()) << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Log any flag warnings.
+  foreach (const flags::Warning& warning, load->warnings) {
+    cerr << warning.message << endl;
+  }
+
+  if (flags.trace.isNone()) {
+    cerr << flags.usage("Missing required option --trace") << endl;
+    return EXIT_FAILURE;
+  }
+
+  Try<int_fd> fd = os::open(flags.trace.get(), O_RDONLY | O_CLOEXEC);
+
+  if (fd.isError()) {
+    cerr << "Failed to open '" << flags.trace.get() << "': "
+         << fd.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // The allocator is paused before it is initialized, so that all its
+  // timers (allocation interval, filters, etc.) use the trace's time.
+  Clock::pause();
+
+  Simulator simulator(flags);
+
+  ::recordio::Decoder<Call> decoder(::protobuf::deserialize<Call>);
+
+  while (true) {
+    Result<string> data = os::read(fd.get(), 1024 * 1024);
+
+    if (data.isError()) {
+      cerr << "Failed to read trace: " << data.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    if (data.isNone()) {
+      break;
+    }
+
+    Try<deque<Try<Call>>> calls = decoder.decode(data.get());
+
+    if (calls.isError()) {
+      cerr << "Failed to decode trace: " << calls.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    foreach (const Try<Call>& call, calls.get()) {
+      if (call.isError()) {
+        cerr << "Failed to deserialize call: " << call.error() << endl;
+        return EXIT_FAILURE;
+      }
+
+      simulator.replay(call.get());
+    }
+  }
+
+  os::close(fd.get());
+
+  simulator.finish();
+  simulator.report();
+
+  return EXIT_SUCCESS;
+}
@@ -64,7 +64,13 @@ DRFSorter::~DRFSorter()
 void DRFSorter::initialize(
     const Option<set<string>>& _fairnessExcludeResourceNames)
 {
-  fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
+  if (_fairnessExcludeResourceNames.isSome()) {
+    fairnessExcludeResourceNames = hashset<InternedString>();
+
+    foreach (const string& name, _fairnessExcludeResourceNames.get()) {
+      fairnessExcludeResourceNames->insert(InternedString(name));
+    }
+  }
 }
 
 
@@ -273,18 +279,19 @@ void DRFSorter::activate(const string& clientPath)
     client->kind = Node::ACTIVE_LEAF;
 
     // `client` has been activated, so move it to the beginning of its
-    // parent's list of children. We mark the tree dirty, so that the
-    // client's share is updated correctly and it is sorted properly.
-    //
-    // TODO(neilc): We could instead calculate share here and insert
-    // the client into the appropriate place here, which would avoid
-    // dirtying the whole tree.
+    // parent's list of children.
     CHECK_NOTNULL(client->parent);
 
     client->parent->removeChild(client);
     client->parent->addChild(client);
 
-    dirty = true;
+    // The share of an inactive client is not kept up to date, so
+    // calculate it and insert the client into the appropriate place
+    // among the active children, which avoids dirtying the tree.
+    if (!dirty) {
+      client->share = calculateShare(client);
+      client->parent->resortChild(client);
+    }
   }
 }
 
@@ -320,7 +327,8 @@ void DRFSorter::allocated(
     const SlaveID& slaveId,
     const Resources& resources)
 {
-  Node* current = CHECK_NOTNULL(find(clientPath));
+  Node* client = CHECK_NOTNULL(find(clientPath));
+  Node* current = client;
 
   // NOTE: We don't currently update the `allocation` for the root
   // node. This is debatable, but the current implementation doesn't
@@ -330,8 +338,7 @@ void DRFSorter::allocated(
     current = CHECK_NOTNULL(current->parent);
   }
 
-  // TODO(neilc): Avoid dirtying the tree in some circumstances.
-  dirty = true;
+  updateShares(client);
 }
 
 
@@ -346,7 +353,8 @@ void DRFSorter::update(
   // Otherwise, we need to ensure we re-calculate the shares, as
   // is being currently done, for safety.
 
-  Node* current = CHECK_NOTNULL(find(clientPath));
+  Node* client = CHECK_NOTNULL(find(clientPath));
+  Node* current = client;
 
   // NOTE: We don't currently update the `allocation` for the root
   // node. This is debatable, but the current implementation doesn't
@@ -356,8 +364,8 @@ void DRFSorter::update(
     current = CHECK_NOTNULL(current->parent);
   }
 
-  // Just assume the total has changed, per the TODO above.
-  dirty = true;
+  // Just assume the quantities have changed, per the TODO above.
+  updateShares(client);
 }
 
 
@@ -366,7 +374,8 @@ void DRFSorter::unallocated(
     const SlaveID& slaveId,
     const Resources& resources)
 {
-  Node* current = CHECK_NOTNULL(find(clientPath));
+  Node* client = CHECK_NOTNULL(find(clientPath));
+  Node* current = client;
 
   // NOTE: We don't currently update the `allocation` for the root
   // node. This is debatable, but the current implementation doesn't
@@ -376,8 +385,7 @@ void DRFSorter::unallocated(
     current = CHECK_NOTNULL(current->parent);
   }
 
-  // TODO(neilc): Avoid dirtying the tree in some circumstances.
-  dirty = true;
+  updateShares(client);
 }
 
 
@@ -389,7 +397,7 @@ const hashmap<SlaveID, Resources>& DRFSorter::allocation(
 }
 
 
-const Resources& DRFSorter::allocationScalarQuantities(
+const ResourceQuantities& DRFSorter::allocationScalarQuantities(
     const string& clientPath) const
 {
   const Node* client = CHECK_NOTNULL(find(clientPath));
@@ -437,7 +445,7 @@ Resources DRFSorter::allocation(
 }
 
 
-const Resources& DRFSorter::totalScalarQuantities() const
+const ResourceQuantities& DRFSorter::totalScalarQuantities() const
 {
   return total_.scalarQuantities;
 }
@@ -455,14 +463,8 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
 
     total_.resources[slaveId] += resources;
 
-    const Resources scalarQuantities =
-      (resources.nonShared() + newShared).createStrippedScalarQuantity();
-
-    total_.scalarQuantities += scalarQuantities;
-
-    foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] += resource.scalar();
-    }
+    total_.scalarQuantities += ResourceQuantities::fromScalarResources(
+        resources.nonShared() + newShared);
 
     // We have to recalculate all shares when the total resources
     // change, but we put it off until `sort` is called so that if
@@ -489,12 +491,9 @@ void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
         return !total_.resources[slaveId].contains(resource);
       });
 
-    const Resources scalarQuantities =
-      (resources.nonShared() + absentShared).createStrippedScalarQuantity();
-
-    foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] -= resource.scalar();
-    }
+    const ResourceQuantities scalarQuantities =
+      ResourceQuantities::fromScalarResources(
+          resources.nonShared() + absentShared);
 
     CHECK(total_.scalarQuantities.contains(scalarQuantities));
     total_.scalarQuantities -= scalarQuantities;
@@ -590,6 +589,45 @@ size_t DRFSorter::count() const
 }
 
 
+Sorter* DRFSorter::snapshot() const
+{
+  DRFSorter* sorter = new DRFSorter();
+
+  sorter->fairnessExcludeResourceNames = fairnessExcludeResourceNames;
+  sorter->dirty = dirty;
+  sorter->weights = weights;
+
+  // We only copy what is needed to calculate shares, i.e., we omit
+  // the per-agent resources of the total and of the allocations.
+  sorter->total_.scalarQuantities = total_.scalarQuantities;
+
+  std::function<void (const Node*, Node*)> copyChildren =
+      [sorter, &copyChildren](const Node* node, Node* copy) {
+    // We add the copies of the children in the same order (rather
+    // than via `addChild()`) so that the copy stays sorted.
+    foreach (const Node* child, node->children) {
+      Node* childCopy = new Node(child->name, child->kind, copy);
+      childCopy->share = child->share;
+      childCopy->allocation.count = child->allocation.count;
+      childCopy->allocation.scalarQuantities =
+        child->allocation.scalarQuantities;
+
+      copy->children.push_back(childCopy);
+
+      if (childCopy->isLeaf()) {
+        sorter->clients[childCopy->clientPath()] = childCopy;
+      } else {
+        copyChildren(child, childCopy);
+      }
+    }
+  };
+
+  copyChildren(root, sorter->root);
+
+  return sorter;
+}
+
+
 double DRFSorter::calculateShare(const Node* node) const
 {
   double share = 0.0;
@@ -598,28 +636,62 @@ double DRFSorter::calculateShare(const Node* node) const
   // currently does not take into account resources that are not
   // scalars.
 
-  foreachpair (const string& resourceName,
-               const Value::Scalar& scalar,
-               total_.totals) {
+  // Both quantities are sorted by name, so we walk them in lockstep.
+  // Since only the ratio of the quantities matters, we can use their
+  // fixed point values directly.
+  const ResourceQuantities& allocation = node->allocation.scalarQuantities;
+  ResourceQuantities::const_iterator it = allocation.begin();
+
+  InternedString::HandleLess less;
+
+  foreach (const ResourceQuantities::Quantity& total, total_.scalarQuantities) {
+    while (it != allocation.end() && less(it->first, total.first)) {
+      ++it;
+    }
+
+    if (it == allocation.end()) {
+      break;
+    }
+
+    if (it->first != total.first) {
+      continue;
+    }
+
     // Filter out the resources excluded from fair sharing.
     if (fairnessExcludeResourceNames.isSome() &&
-        fairnessExcludeResourceNames->count(resourceName) > 0) {
+        fairnessExcludeResourceNames->count(total.first) > 0) {
       continue;
     }
 
-    if (scalar.value() > 0.0 &&
-        node->allocation.totals.contains(resourceName)) {
-      const double allocation =
-        node->allocation.totals.at(resourceName).value();
-
-      share = std::max(share, allocation / scalar.value());
-    }
+    share = std::max(
+        share,
+        static_cast<double>(it->second) / static_cast<double>(total.second));
   }
 
   return share / findWeight(node);
 }
 
 
+void DRFSorter::updateShares(Node* node)
+{
+  // If the tree is dirty `sort()` recalculates all shares anyway.
+  if (dirty) {
+    return;
+  }
+
+  while (node != root) {
+    // Inactive leaves are not sorted (see `sort()`), so we only need
+    // to calculate their share once they are activated.
+    if (node->kind != Node::INACTIVE_LEAF) {
+      node->share = calculateShare(node);
+      CHECK_NOTNULL(node->parent)->resortChild(node);
+    }
+
+    node = node->parent;
+  }
+}
+
+
 double DRFSorter::findWeight(const Node* node) const
 {
   Option<double> weight = weights.get(node->path);
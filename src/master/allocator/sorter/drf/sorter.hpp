@@ -22,14 +22,18 @@
 #include <string>
 #include <vector>
 
+#include <mesos/interned.hpp>
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 #include <mesos/values.hpp>
 
 #include <stout/check.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/option.hpp>
 
+#include "common/resource_quantities.hpp"
+
 #include "master/allocator/sorter/drf/metrics.hpp"
 
 #include "master/allocator/sorter/sorter.hpp"
@@ -83,7 +87,7 @@ public:
   virtual const hashmap<SlaveID, Resources>& allocation(
       const std::string& clientPath) const;
 
-  virtual const Resources& allocationScalarQuantities(
+  virtual const ResourceQuantities& allocationScalarQuantities(
       const std::string& clientPath) const;
 
   virtual hashmap<std::string, Resources> allocation(
@@ -93,7 +97,7 @@ public:
       const std::string& clientPath,
       const SlaveID& slaveId) const;
 
-  virtual const Resources& totalScalarQuantities() const;
+  virtual const ResourceQuantities& totalScalarQuantities() const;
 
   virtual void add(const SlaveID& slaveId, const Resources& resources);
 
@@ -105,6 +109,8 @@ public:
 
   virtual size_t count() const;
 
+  virtual Sorter* snapshot() const;
+
 private:
   // A node in the sorter's tree.
   struct Node;
@@ -112,6 +118,12 @@ private:
   // Returns the dominant resource share for the node.
   double calculateShare(const Node* node) const;
 
+  // Recalculates the shares of the node and its ancestors after their
+  // allocation has changed and moves each of them to its new position
+  // among its siblings. The shares of all other nodes are unaffected,
+  // so this keeps the tree sorted without having to mark it dirty.
+  void updateShares(Node* node);
+
   // Returns the weight associated with the node. If no weight has
   // been configured for the node's path, the default weight (1.0) is
   // returned.
@@ -122,10 +134,13 @@ private:
   // internal node in the tree (not a client).
   Node* find(const std::string& clientPath) const;
 
-  // Resources (by name) that will be excluded from fair sharing.
-  Option<std::set<std::string>> fairnessExcludeResourceNames;
+  // Resources (by name) that will be excluded from fair sharing. These
+  // are interned to match the names of the scalar quantities.
+  Option<hashset<InternedString>> fairnessExcludeResourceNames;
 
   // If true, sort() will recalculate all shares and resort the tree.
+  // Changes to the allocation of a client do not dirty the tree, see
+  // `updateShares()`.
   bool dirty = false;
 
   // The root node in the sorter tree.
@@ -166,16 +181,11 @@ private:
     // Sharedness info is also stripped out when resource identities
     // are omitted because sharedness inherently refers to the
     // identities of resources and not quantities.
-    Resources scalarQuantities;
-
-    // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
     //
-    // TODO(bmahler): Ideally we do not store `scalarQuantities`
-    // redundantly here, investigate performance improvements to
-    // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    // NOTE: Static reservations are omitted as well, which together
+    // with the flat representation of `ResourceQuantities` improves
+    // the performance of calculating shares. See MESOS-4694.
+    ResourceQuantities scalarQuantities;
   } total_;
 
   // Metrics are optionally exposed by the sorter.
@@ -258,7 +268,7 @@ struct DRFSorter::Node
   // can stop when the first inactive leaf is observed.
   //
   // (2) If the tree is not dirty, the active leaves and internal
-  // nodes are kept sorted by DRF share.
+  // nodes are kept sorted by DRF share (see `resortChild()`).
   std::vector<Node*> children;
 
   // If this node represents a sorter client, this returns the path of
@@ -316,6 +326,31 @@ struct DRFSorter::Node
     }
   }
 
+  // Moves an active leaf or internal node to its position in DRF
+  // order, assuming that only its share (or allocation count) has
+  // changed since the children were last sorted. This maintains
+  // ordering invariant (2) above without re-sorting all children.
+  void resortChild(Node* child)
+  {
+    CHECK(child->kind != INACTIVE_LEAF);
+
+    auto it = std::find(children.begin(), children.end(), child);
+    CHECK(it != children.end());
+
+    children.erase(it);
+
+    // Per invariant (1), the active children are a prefix of
+    // `children` so we can find their end with a binary search.
+    auto active = std::partition_point(
+        children.begin(),
+        children.end(),
+        [](const Node* node) { return node->kind != INACTIVE_LEAF; });
+
+    children.insert(
+        std::upper_bound(children.begin(), active, child, compareDRF),
+        child);
+  }
+
   // Allocation for a node.
   struct Allocation
   {
@@ -330,15 +365,9 @@ struct DRFSorter::Node
             return !resources[slaveId].contains(resource);
         });
 
-      const Resources quantitiesToAdd =
-        (toAdd.nonShared() + sharedToAdd).createStrippedScalarQuantity();
-
       resources[slaveId] += toAdd;
-      scalarQuantities += quantitiesToAdd;
-
-      foreach (const Resource& resource, quantitiesToAdd) {
-        totals[resource.name()] += resource.scalar();
-      }
+      scalarQuantities += ResourceQuantities::fromScalarResources(
+          toAdd.nonShared() + sharedToAdd);
 
       count++;
     }
@@ -359,12 +388,9 @@ struct DRFSorter::Node
             return !resources[slaveId].contains(resource);
         });
 
-      const Resources quantitiesToRemove =
-        (toRemove.nonShared() + sharedToRemove).createStrippedScalarQuantity();
-
-      foreach (const Resource& resource, quantitiesToRemove) {
-        totals[resource.name()] -= resource.scalar();
-      }
+      const ResourceQuantities quantitiesToRemove =
+        ResourceQuantities::fromScalarResources(
+            toRemove.nonShared() + sharedToRemove);
 
       CHECK(scalarQuantities.contains(quantitiesToRemove))
         << scalarQuantities << " does not contain " << quantitiesToRemove;
@@ -381,10 +407,10 @@ struct DRFSorter::Node
         const Resources& oldAllocation,
         const Resources& newAllocation)
     {
-      const Resources oldAllocationQuantity =
-        oldAllocation.createStrippedScalarQuantity();
-      const Resources newAllocationQuantity =
-        newAllocation.createStrippedScalarQuantity();
+      const ResourceQuantities oldAllocationQuantity =
+        ResourceQuantities::fromScalarResources(oldAllocation);
+      const ResourceQuantities newAllocationQuantity =
+        ResourceQuantities::fromScalarResources(newAllocation);
 
       CHECK(resources.contains(slaveId));
       CHECK(resources[slaveId].contains(oldAllocation))
@@ -399,14 +425,6 @@ struct DRFSorter::Node
 
       scalarQuantities -= oldAllocationQuantity;
       scalarQuantities += newAllocationQuantity;
-
-      foreach (const Resource& resource, oldAllocationQuantity) {
-        totals[resource.name()] -= resource.scalar();
-      }
-
-      foreach (const Resource& resource, newAllocationQuantity) {
-        totals[resource.name()] += resource.scalar();
-      }
     }
 
     // We store the number of times this client has been chosen for
@@ -425,18 +443,9 @@ struct DRFSorter::Node
     hashmap<SlaveID, Resources> resources;
 
     // Similarly, we aggregate scalars across slaves and omit information
-    // about dynamic reservations, persistent volumes and sharedness of
-    // the corresponding resource. See notes above.
-    Resources scalarQuantities;
-
-    // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
-    //
-    // TODO(bmahler): Ideally we do not store `scalarQuantities`
-    // redundantly here, investigate performance improvements to
-    // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    // about reservations, persistent volumes and sharedness of the
+    // corresponding resource. See notes above.
+    ResourceQuantities scalarQuantities;
   } allocation;
 
   // Compares two nodes according to DRF share.
@@ -26,6 +26,8 @@
 
 #include <process/pid.hpp>
 
+#include "common/resource_quantities.hpp"
+
 namespace mesos {
 namespace internal {
 namespace master {
@@ -108,9 +110,9 @@ public:
       const std::string& client) const = 0;
 
   // Returns the total scalar resource quantities that are allocated to
-  // this client. This omits metadata about dynamic reservations and
-  // persistent volumes; see `Resources::createStrippedScalarQuantity`.
-  virtual const Resources& allocationScalarQuantities(
+  // this client. This omits all metadata such as reservations and
+  // persistent volumes; see `ResourceQuantities`.
+  virtual const ResourceQuantities& allocationScalarQuantities(
       const std::string& client) const = 0;
 
   // Returns the clients that have allocations on this slave.
@@ -124,9 +126,9 @@ public:
       const SlaveID& slaveId) const = 0;
 
   // Returns the total scalar resource quantities in this sorter. This
-  // omits metadata about dynamic reservations and persistent volumes; see
-  // `Resources::createStrippedScalarQuantity`.
-  virtual const Resources& totalScalarQuantities() const = 0;
+  // omits all metadata such as reservations and persistent volumes; see
+  // `ResourceQuantities`.
+  virtual const ResourceQuantities& totalScalarQuantities() const = 0;
 
   // Add resources to the total pool of resources this
   // Sorter should consider.
@@ -146,6 +148,14 @@ public:
   // Returns the number of clients this Sorter contains,
   // either active or inactive.
   virtual size_t count() const = 0;
+
+  // Returns a copy of this Sorter that can be used to tentatively
+  // allocate resources to the clients (and sort them accordingly)
+  // without affecting this Sorter. The copy only tracks the resources
+  // that are allocated to it (or added to its total) after it has
+  // been taken, so it cannot be used to look up or unallocate the
+  // resources that were allocated beforehand.
+  virtual Sorter* snapshot() const = 0;
 };
 
 } // namespace allocator {
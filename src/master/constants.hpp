@@ -47,6 +47,11 @@ constexpr double MIN_CPUS = 0.01;
 // Minimum amount of memory per offer.
 constexpr Bytes MIN_MEM = Megabytes(32);
 
+// Maximum number of changes to the master's state that are kept to
+// answer `since=<version>` queries of the state endpoints, see
+// `Master::StateChanges`.
+constexpr size_t MAX_STATE_CHANGES = 100000;
+
 // Default interval the master uses to send heartbeats to an HTTP
 // scheduler.
 constexpr Duration DEFAULT_HEARTBEAT_INTERVAL = Seconds(15);
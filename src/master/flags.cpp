@@ -194,6 +194,38 @@ mesos::internal::master::Flags::Flags()
       " (batch) allocations (e.g., 500ms, 1sec, etc).",
       DEFAULT_ALLOCATION_INTERVAL);
 
+  add(&Flags::allocation_sweep_interval,
+      "allocation_sweep_interval",
+      "If set, periodic (batch) allocations only consider the agents and\n"
+      "roles affected by events since the previous allocation (e.g.,\n"
+      "recovered resources, added agents, revived offers, expired offer\n"
+      "filters or quota changes), and all agents are considered at least\n"
+      "once per this interval (e.g., 10secs, 1mins, etc). If not set, all\n"
+      "agents are considered on every periodic allocation. Only supported\n"
+      "by the default allocator.",
+      [](const Option<Duration>& value) -> Option<Error> {
+        if (value.isSome() && value.get() < Duration::zero()) {
+          return Error(
+              "Expected `--allocation_sweep_interval` to be non-negative");
+        }
+        return None();
+      });
+
+  add(&Flags::allocation_threads,
+      "allocation_threads",
+      "Number of threads the allocator uses to allocate the resources\n"
+      "remaining after quota allocation. With more than one thread the\n"
+      "agents are partitioned between the threads, and fair sharing\n"
+      "between roles is only approximated across the partitions within\n"
+      "one allocation run. Only supported by the default allocator.",
+      1,
+      [](size_t value) -> Option<Error> {
+        if (value < 1) {
+          return Error("Expected `--allocation_threads` to be at least 1");
+        }
+        return None();
+      });
+
   add(&Flags::cluster,
       "cluster",
       "Human readable name for the cluster, displayed in the webui.");
@@ -448,6 +480,15 @@ mesos::internal::master::Flags::Flags()
       "load an alternate allocator module using `--modules`.",
       DEFAULT_ALLOCATOR);
 
+  add(&Flags::allocator_trace,
+      "allocator_trace",
+      "Path of a file to record all the calls made to the allocator to,\n"
+      "e.g., to replay them with the `mesos-allocator-simulator`\n"
+      "(installed in the `libexec` directory of Mesos). The file\n"
+      "is overwritten when the master starts. Recording stops (and a\n"
+      "warning is logged) if writing the file cannot keep up with the\n"
+      "calls. Only supported by the default allocator.");
+
   add(&Flags::fair_sharing_excluded_resource_names,
       "fair_sharing_excluded_resource_names",
       "A comma-separated list of the resource names (e.g. 'gpus')\n"
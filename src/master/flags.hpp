@@ -63,6 +63,8 @@ public:
   std::string user_sorter;
   std::string framework_sorter;
   Duration allocation_interval;
+  size_t allocation_threads;
+  Option<Duration> allocation_sweep_interval;
   Option<std::string> cluster;
   Option<std::string> roles;
   Option<std::string> weights;
@@ -80,6 +82,7 @@ public:
   Option<std::string> modulesDir;
   std::string authenticators;
   std::string allocator;
+  Option<std::string> allocator_trace;
   Option<std::set<std::string>> fair_sharing_excluded_resource_names;
   bool filter_gpu_resources;
   Option<std::string> hooks;
@@ -38,6 +38,7 @@
 
 #include <process/collect.hpp>
 #include <process/defer.hpp>
+#include <process/dispatch.hpp>
 #include <process/help.hpp>
 #include <process/logging.hpp>
 
@@ -199,6 +200,7 @@ using mesos::internal::model;
 using process::http::Response;
 using process::http::Request;
 using process::Owned;
+using process::Promise;
 
 
 // The summary representation of `T` to support the `/state-summary` endpoint.
@@ -219,6 +221,17 @@ struct Full : Representation<T>
 };
 
 
+const string& Framework::renderTask(const Task& task) const
+{
+  auto it = renderedTasks.find(&task);
+  if (it != renderedTasks.end()) {
+    return it->second;
+  }
+
+  return renderedTasks.emplace(&task, jsonify(task)).first->second;
+}
+
+
 // Forward declaration for `FullFrameworkWriter`.
 static void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary);
 
@@ -322,7 +335,7 @@ struct FullFrameworkWriter {
           continue;
         }
 
-        writer->element(*task);
+        writer->element(JSON::RawValue(framework_->renderTask(*task)));
       }
     });
 
@@ -333,7 +346,7 @@ struct FullFrameworkWriter {
           continue;
         }
 
-        writer->element(*task);
+        writer->element(JSON::RawValue(framework_->renderTask(*task)));
       }
     });
 
@@ -344,7 +357,7 @@ struct FullFrameworkWriter {
           continue;
         }
 
-        writer->element(*task);
+        writer->element(JSON::RawValue(framework_->renderTask(*task)));
       }
     });
 
@@ -1915,12 +1928,34 @@ Future<Response> Master::Http::getState(
           mesos::master::Response response;
           response.set_type(mesos::master::Response::GET_STATE);
 
-          *response.mutable_get_state() =
-              _getState(
-                  frameworksApprover,
-                  tasksApprover,
-                  executorsApprover,
-                  rolesAcceptor);
+          // Only the changes are returned if they are still known.
+          Option<StateDelta> delta;
+          if (call.get_state().has_since()) {
+            Option<string> masterId;
+            if (call.get_state().has_master_id()) {
+              masterId = call.get_state().master_id();
+            }
+
+            delta = stateDelta(masterId, call.get_state().since());
+          }
+
+          if (delta.isSome()) {
+            *response.mutable_get_state() =
+                _getState(
+                    call.get_state().since(),
+                    delta.get(),
+                    frameworksApprover,
+                    tasksApprover,
+                    executorsApprover,
+                    rolesAcceptor);
+          } else {
+            *response.mutable_get_state() =
+                _getState(
+                    frameworksApprover,
+                    tasksApprover,
+                    executorsApprover,
+                    rolesAcceptor);
+          }
 
           return OK(
               serialize(contentType, evolve(response)), stringify(contentType));
@@ -1953,6 +1988,246 @@ mesos::master::Response::GetState Master::Http::_getState(
   *getState.mutable_get_agents() =
       _getAgents(rolesAcceptor);
 
+  getState.set_version(master->stateChanges.version);
+  getState.set_master_id(master->info().id());
+
+  return getState;
+}
+
+
+Option<Master::Http::StateDelta> Master::Http::stateDelta(
+    const Option<string>& masterId,
+    uint64_t since) const
+{
+  if (masterId != master->info().id()) {
+    return None();
+  }
+
+  Option<StateChanges::Delta> changes = master->stateChanges.since(since);
+  if (changes.isNone()) {
+    return None();
+  }
+
+  StateDelta delta;
+  delta.version = master->stateChanges.version;
+
+  foreach (const SlaveID& slaveId, changes->agents) {
+    const Slave* slave = master->slaves.registered.get(slaveId);
+    if (slave != nullptr) {
+      delta.agents.push_back(slave);
+    } else {
+      delta.removedAgents.push_back(slaveId);
+    }
+  }
+
+  // Returns the framework if it is registered or completed, and sorts
+  // it into the frameworks of the delta if it changed itself.
+  hashmap<FrameworkID, const Framework*> frameworks;
+  auto lookup = [&](const FrameworkID& frameworkId) -> const Framework* {
+    if (!frameworks.contains(frameworkId)) {
+      const Framework* framework = master->getFramework(frameworkId);
+      bool completed = false;
+
+      if (framework == nullptr &&
+          master->frameworks.completed.contains(frameworkId)) {
+        framework = master->frameworks.completed.at(frameworkId).get();
+        completed = true;
+      }
+
+      if (framework != nullptr && changes->frameworks.contains(frameworkId)) {
+        if (completed) {
+          delta.completedFrameworks.push_back(framework);
+        } else {
+          delta.frameworks.push_back(framework);
+        }
+      }
+
+      frameworks[frameworkId] = framework;
+    }
+
+    return frameworks.at(frameworkId);
+  };
+
+  foreach (const FrameworkID& frameworkId, changes->frameworks) {
+    lookup(frameworkId);
+  }
+
+  foreachpair (const FrameworkID& frameworkId,
+               const hashset<TaskID>& taskIds,
+               changes->tasks) {
+    const Framework* framework = lookup(frameworkId);
+    if (framework == nullptr) {
+      continue;
+    }
+
+    // The completed tasks are only indexed when needed. Task IDs can
+    // be reused, in which case the most recently completed task wins.
+    Option<hashmap<TaskID, const Task*>> completedTasks;
+
+    foreach (const TaskID& taskId, taskIds) {
+      if (framework->tasks.contains(taskId)) {
+        delta.tasks.emplace_back(framework, framework->tasks.at(taskId));
+        continue;
+      }
+
+      if (framework->unreachableTasks.contains(taskId)) {
+        delta.unreachableTasks.emplace_back(
+            framework, framework->unreachableTasks.at(taskId).get());
+        continue;
+      }
+
+      if (completedTasks.isNone()) {
+        completedTasks = hashmap<TaskID, const Task*>();
+        foreach (const Owned<Task>& task, framework->completedTasks) {
+          completedTasks->put(task->task_id(), task.get());
+        }
+      }
+
+      if (completedTasks->contains(taskId)) {
+        delta.completedTasks.emplace_back(
+            framework, completedTasks->at(taskId));
+      } else {
+        delta.removedTasks.emplace_back(framework, taskId);
+      }
+    }
+  }
+
+  foreachpair (const FrameworkID& frameworkId,
+               const auto& executors,
+               changes->executors) {
+    const Framework* framework = lookup(frameworkId);
+    if (framework == nullptr) {
+      continue;
+    }
+
+    foreachpair (const SlaveID& slaveId,
+                 const hashset<ExecutorID>& executorIds,
+                 executors) {
+      foreach (const ExecutorID& executorId, executorIds) {
+        StateDelta::Executor executor{framework, slaveId, executorId, nullptr};
+
+        if (framework->executors.contains(slaveId) &&
+            framework->executors.at(slaveId).contains(executorId)) {
+          executor.info = &framework->executors.at(slaveId).at(executorId);
+          delta.executors.push_back(executor);
+        } else {
+          delta.removedExecutors.push_back(executor);
+        }
+      }
+    }
+  }
+
+  return delta;
+}
+
+
+mesos::master::Response::GetState Master::Http::_getState(
+    uint64_t since,
+    const StateDelta& delta,
+    const Owned<ObjectApprover>& frameworksApprover,
+    const Owned<ObjectApprover>& tasksApprover,
+    const Owned<ObjectApprover>& executorsApprover,
+    const Owned<AuthorizationAcceptor>& rolesAcceptor) const
+{
+  mesos::master::Response::GetState getState;
+  getState.set_version(delta.version);
+  getState.set_master_id(master->info().id());
+  getState.set_since(since);
+
+  mesos::master::Response::GetAgents* getAgents =
+    getState.mutable_get_agents();
+
+  foreach (const Slave* slave, delta.agents) {
+    *getAgents->add_agents() =
+      protobuf::master::event::createAgentResponse(*slave, rolesAcceptor);
+  }
+
+  foreach (const SlaveID& slaveId, delta.removedAgents) {
+    *getState.add_removed_agents() = slaveId;
+  }
+
+  mesos::master::Response::GetFrameworks* getFrameworks =
+    getState.mutable_get_frameworks();
+
+  foreach (const Framework* framework, delta.frameworks) {
+    if (approveViewFrameworkInfo(frameworksApprover, framework->info)) {
+      *getFrameworks->add_frameworks() = model(*framework);
+    }
+  }
+
+  foreach (const Framework* framework, delta.completedFrameworks) {
+    if (approveViewFrameworkInfo(frameworksApprover, framework->info)) {
+      *getFrameworks->add_completed_frameworks() = model(*framework);
+    }
+  }
+
+  mesos::master::Response::GetTasks* getTasks = getState.mutable_get_tasks();
+
+  auto approveTask = [&](const StateDelta::FrameworkTask& task) {
+    return approveViewFrameworkInfo(frameworksApprover, task.first->info) &&
+           approveViewTask(tasksApprover, *task.second, task.first->info);
+  };
+
+  foreach (const StateDelta::FrameworkTask& task, delta.tasks) {
+    if (approveTask(task)) {
+      *getTasks->add_tasks() = *task.second;
+    }
+  }
+
+  foreach (const StateDelta::FrameworkTask& task, delta.unreachableTasks) {
+    if (approveTask(task)) {
+      *getTasks->add_unreachable_tasks() = *task.second;
+    }
+  }
+
+  foreach (const StateDelta::FrameworkTask& task, delta.completedTasks) {
+    if (approveTask(task)) {
+      *getTasks->add_completed_tasks() = *task.second;
+    }
+  }
+
+  // The removed tasks and executors can only be authorized by their
+  // framework, but their IDs are all that is exposed.
+  foreachpair (const Framework* framework,
+               const TaskID& taskId,
+               delta.removedTasks) {
+    if (approveViewFrameworkInfo(frameworksApprover, framework->info)) {
+      mesos::master::Response::GetState::RemovedTask* task =
+        getState.add_removed_tasks();
+
+      *task->mutable_framework_id() = framework->id();
+      *task->mutable_task_id() = taskId;
+    }
+  }
+
+  mesos::master::Response::GetExecutors* getExecutors =
+    getState.mutable_get_executors();
+
+  foreach (const StateDelta::Executor& executor, delta.executors) {
+    if (approveViewFrameworkInfo(
+            frameworksApprover, executor.framework->info) &&
+        approveViewExecutorInfo(
+            executorsApprover, *executor.info, executor.framework->info)) {
+      mesos::master::Response::GetExecutors::Executor* _executor =
+        getExecutors->add_executors();
+
+      *_executor->mutable_executor_info() = *executor.info;
+      *_executor->mutable_slave_id() = executor.slaveId;
+    }
+  }
+
+  foreach (const StateDelta::Executor& executor, delta.removedExecutors) {
+    if (approveViewFrameworkInfo(
+            frameworksApprover, executor.framework->info)) {
+      mesos::master::Response::GetState::RemovedExecutor* _executor =
+        getState.add_removed_executors();
+
+      *_executor->mutable_framework_id() = executor.framework->id();
+      *_executor->mutable_slave_id() = executor.slaveId;
+      *_executor->mutable_executor_id() = executor.executorId;
+    }
+  }
+
   return getState;
 }
 
@@ -2742,6 +3017,87 @@ Future<Response> Master::Http::weights(
 }
 
 
+// Returns the key under which identical read-only requests share one
+// rendering, see `Master::Http::deferBatchedRequest()`. All query
+// parameters (e.g., `jsonp` or `since`) are part of the key.
+static string batchKey(
+    const string& endpoint,
+    const Request& request,
+    const Option<Principal>& principal)
+{
+  std::ostringstream key;
+
+  key << endpoint;
+
+  if (principal.isSome()) {
+    key << " principal=" << principal.get();
+  }
+
+  // Sort the query parameters so that their order does not matter.
+  const map<string, string> parameters(
+      request.url.query.begin(), request.url.query.end());
+
+  foreachpair (const string& parameter, const string& value, parameters) {
+    key << " " << parameter << "=" << value;
+  }
+
+  return key.str();
+}
+
+
+Future<Response> Master::Http::deferBatchedRequest(
+    const string& key,
+    const lambda::function<Response()>& render) const
+{
+  // Identical requests are served from the same rendering.
+  foreach (const BatchedRequest& batchedRequest, batchedRequests) {
+    if (batchedRequest.key == key) {
+      return batchedRequest.promise->future();
+    }
+  }
+
+  const bool scheduleBatch = batchedRequests.empty();
+
+  BatchedRequest batchedRequest;
+  batchedRequest.key = key;
+  batchedRequest.render = render;
+  batchedRequest.promise.reset(new Promise<Response>());
+
+  Future<Response> response = batchedRequest.promise->future();
+
+  batchedRequests.push_back(std::move(batchedRequest));
+
+  // Schedule the processing of the batch if it is not yet scheduled.
+  // Requests that arrive before the master gets to it join the batch.
+  if (scheduleBatch) {
+    process::dispatch(master->self(), [this]() {
+      processRequestsBatch();
+    });
+  }
+
+  return response;
+}
+
+
+void Master::Http::processRequestsBatch() const
+{
+  CHECK(!batchedRequests.empty()) << "Bug in read-only request batching";
+
+  VLOG(1) << "Processing batch of " << batchedRequests.size()
+          << " read-only master HTTP requests";
+
+  // NOTE: The responses are rendered on the master actor since they
+  // read the master state, which is only safe from the master actor.
+  // Identical requests were already merged in `deferBatchedRequest()`,
+  // so each distinct response is rendered exactly once.
+  foreach (const BatchedRequest& batchedRequest, batchedRequests) {
+    batchedRequest.promise->set(batchedRequest.render());
+  }
+
+  batchedRequests.clear();
+}
+
+
 string Master::Http::STATE_HELP()
 {
   return HELP(
@@ -2761,6 +3117,19 @@ string Master::Http::STATE_HELP()
         "The information shown might be filtered based on the user",
         "accessing the endpoint.",
         "",
+        "Query parameters:",
+        "",
+        ">        since=VALUE          A `state_version` of an earlier "
+        "response.",
+        ">        master_id=VALUE      The `id` of that response.",
+        "",
+        "If `since` is set, only the agents, frameworks, tasks and",
+        "executors that were added, changed or removed after that version",
+        "are returned, along with the `since` version. The full state is",
+        "returned if the master does not know the changes since then,",
+        "or if `master_id` is not the ID of this master, e.g., because",
+        "the master failed over in the meantime.",
+        "",
         "Example (**Note**: this is not exhaustive):",
         "",
         "```",
@@ -2775,6 +3144,7 @@ string Master::Http::STATE_HELP()
         "    \"start_time\" : 1455643643.42422,",
         "    \"elected_time\" : 1455643643.43457,",
         "    \"id\" : \"b5eac2c5-609b-4ca1-a352-61941702fc9e\",",
+        "    \"state_version\" : 42,",
         "    \"pid\" : \"master@127.0.0.1:5050\",",
         "    \"hostname\" : \"localhost\",",
         "    \"activated_slaves\" : 0,",
@@ -2857,6 +3227,11 @@ Future<Response> Master::Http::state(
     return redirect(request);
   }
 
+  Result<uint64_t> since = numify<uint64_t>(request.url.query.get("since"));
+  if (since.isError()) {
+    return BadRequest("Failed to parse 'since': " + since.error());
+  }
+
   Future<Owned<AuthorizationAcceptor>> authorizeRole =
     AuthorizationAcceptor::create(
         principal, master->authorizer, authorization::VIEW_ROLE);
@@ -2881,170 +3256,324 @@ Future<Response> Master::Http::state(
       authorizeFlags)
     .then(defer(
         master->self(),
-        [this, request](const tuple<Owned<AuthorizationAcceptor>,
-                                    Owned<AuthorizationAcceptor>,
-                                    Owned<AuthorizationAcceptor>,
-                                    Owned<AuthorizationAcceptor>,
-                                    Owned<AuthorizationAcceptor>>& acceptors)
-          -> Response {
-      // This lambda is consumed before the outer lambda
-      // returns, hence capture by reference is fine here.
-      auto state = [this, &acceptors](JSON::ObjectWriter* writer) {
-        Owned<AuthorizationAcceptor> authorizeRole;
-        Owned<AuthorizationAcceptor> authorizeFrameworkInfo;
-        Owned<AuthorizationAcceptor> authorizeTask;
-        Owned<AuthorizationAcceptor> authorizeExecutorInfo;
-        Owned<AuthorizationAcceptor> authorizeFlags;
-        tie(authorizeRole,
-            authorizeFrameworkInfo,
-            authorizeTask,
-            authorizeExecutorInfo,
-            authorizeFlags) = acceptors;
+        [this, request, principal, since](
+            const tuple<Owned<AuthorizationAcceptor>,
+                        Owned<AuthorizationAcceptor>,
+                        Owned<AuthorizationAcceptor>,
+                        Owned<AuthorizationAcceptor>,
+                        Owned<AuthorizationAcceptor>>& acceptors)
+          -> Future<Response> {
+      // Rendered by `processRequestsBatch()` together with the other
+      // read-only requests that are batched with this one.
+      auto render = [this, request, acceptors, since]() -> Response {
+        // Only the changes are returned if they are still known.
+        Option<StateDelta> delta;
+        if (since.isSome()) {
+          delta = stateDelta(request.url.query.get("master_id"), since.get());
+        }
 
-        writer->field("version", MESOS_VERSION);
+        if (delta.isSome()) {
+          auto changes = [this, &acceptors, &since, &delta](
+              JSON::ObjectWriter* writer) {
+            Owned<AuthorizationAcceptor> authorizeRole;
+            Owned<AuthorizationAcceptor> authorizeFrameworkInfo;
+            Owned<AuthorizationAcceptor> authorizeTask;
+            Owned<AuthorizationAcceptor> authorizeExecutorInfo;
+            tie(authorizeRole,
+                authorizeFrameworkInfo,
+                authorizeTask,
+                authorizeExecutorInfo,
+                std::ignore) = acceptors;
 
-        if (build::GIT_SHA.isSome()) {
-          writer->field("git_sha", build::GIT_SHA.get());
-        }
+            writer->field("id", master->info().id());
+            writer->field("state_version", delta->version);
+            writer->field("since", since.get());
 
-        if (build::GIT_BRANCH.isSome()) {
-          writer->field("git_branch", build::GIT_BRANCH.get());
-        }
+            writer->field("slaves", [&](JSON::ArrayWriter* writer) {
+              foreach (const Slave* slave, delta->agents) {
+                writer->element(SlaveWriter(*slave, authorizeRole));
+              }
+            });
 
-        if (build::GIT_TAG.isSome()) {
-          writer->field("git_tag", build::GIT_TAG.get());
-        }
+            writer->field("removed_slaves", [&](JSON::ArrayWriter* writer) {
+              foreach (const SlaveID& slaveId, delta->removedAgents) {
+                writer->element(slaveId.value());
+              }
+            });
 
-        writer->field("build_date", build::DATE);
-        writer->field("build_time", build::TIME);
-        writer->field("build_user", build::USER);
-        writer->field("start_time", master->startTime.secs());
+            // Frameworks are modeled without their tasks and executors,
+            // which are listed separately below.
+            auto writeFrameworks = [&](
+                JSON::ArrayWriter* writer,
+                const vector<const Framework*>& frameworks) {
+              foreach (const Framework* framework, frameworks) {
+                if (!authorizeFrameworkInfo->accept(framework->info)) {
+                  continue;
+                }
 
-        if (master->electedTime.isSome()) {
-          writer->field("elected_time", master->electedTime.get().secs());
-        }
+                writer->element([&](JSON::ObjectWriter* writer) {
+                  json(writer, Summary<Framework>(*framework));
+                });
+              }
+            };
 
-        writer->field("id", master->info().id());
-        writer->field("pid", string(master->self()));
-        writer->field("hostname", master->info().hostname());
-        writer->field("capabilities", master->info().capabilities());
-        writer->field("activated_slaves", master->_slaves_active());
-        writer->field("deactivated_slaves", master->_slaves_inactive());
-        writer->field("unreachable_slaves", master->_slaves_unreachable());
+            writer->field("frameworks", [&](JSON::ArrayWriter* writer) {
+              writeFrameworks(writer, delta->frameworks);
+            });
 
-        if (master->info().has_domain()) {
-          writer->field("domain", master->info().domain());
-        }
+            writer->field(
+                "completed_frameworks",
+                [&](JSON::ArrayWriter* writer) {
+              writeFrameworks(writer, delta->completedFrameworks);
+            });
 
-        // TODO(haosdent): Deprecated this in favor of `leader_info` below.
-        if (master->leader.isSome()) {
-          writer->field("leader", master->leader->pid());
-        }
+            auto writeTasks = [&](
+                JSON::ArrayWriter* writer,
+                const vector<StateDelta::FrameworkTask>& tasks) {
+              foreachpair (const Framework* framework,
+                           const Task* task,
+                           tasks) {
+                if (!authorizeFrameworkInfo->accept(framework->info) ||
+                    !authorizeTask->accept(*task, framework->info)) {
+                  continue;
+                }
 
-        if (master->leader.isSome()) {
-          writer->field("leader_info", [this](JSON::ObjectWriter* writer) {
-            json(writer, master->leader.get());
-          });
+                writer->element(JSON::RawValue(framework->renderTask(*task)));
+              }
+            };
+
+            writer->field("tasks", [&](JSON::ArrayWriter* writer) {
+              writeTasks(writer, delta->tasks);
+            });
+
+            writer->field("unreachable_tasks", [&](JSON::ArrayWriter* writer) {
+              writeTasks(writer, delta->unreachableTasks);
+            });
+
+            writer->field("completed_tasks", [&](JSON::ArrayWriter* writer) {
+              writeTasks(writer, delta->completedTasks);
+            });
+
+            // The removed tasks and executors can only be authorized by
+            // their framework, but their IDs are all that is exposed.
+            writer->field("removed_tasks", [&](JSON::ArrayWriter* writer) {
+              foreachpair (const Framework* framework,
+                           const TaskID& taskId,
+                           delta->removedTasks) {
+                if (!authorizeFrameworkInfo->accept(framework->info)) {
+                  continue;
+                }
+
+                writer->element([&](JSON::ObjectWriter* writer) {
+                  writer->field("framework_id", framework->id().value());
+                  writer->field("id", taskId.value());
+                });
+              }
+            });
+
+            writer->field("executors", [&](JSON::ArrayWriter* writer) {
+              foreach (const StateDelta::Executor& executor,
+                       delta->executors) {
+                const FrameworkInfo& frameworkInfo = executor.framework->info;
+
+                if (!authorizeFrameworkInfo->accept(frameworkInfo) ||
+                    !authorizeExecutorInfo->accept(
+                        *executor.info, frameworkInfo)) {
+                  continue;
+                }
+
+                writer->element([&](JSON::ObjectWriter* writer) {
+                  json(writer, *executor.info);
+                  writer->field("slave_id", executor.slaveId.value());
+                });
+              }
+            });
+
+            writer->field("removed_executors", [&](JSON::ArrayWriter* writer) {
+              foreach (const StateDelta::Executor& executor,
+                       delta->removedExecutors) {
+                if (!authorizeFrameworkInfo->accept(
+                        executor.framework->info)) {
+                  continue;
+                }
+
+                writer->element([&](JSON::ObjectWriter* writer) {
+                  writer->field(
+                      "framework_id", executor.framework->id().value());
+                  writer->field("slave_id", executor.slaveId.value());
+                  writer->field("executor_id", executor.executorId.value());
+                });
+              }
+            });
+          };
+
+          return OK(jsonify(changes), request.url.query.get("jsonp"));
         }
 
-        if (authorizeFlags->accept()) {
-          if (master->flags.cluster.isSome()) {
-            writer->field("cluster", master->flags.cluster.get());
+        // This lambda is consumed before the outer lambda
+        // returns, hence capture by reference is fine here.
+        auto state = [this, &acceptors](JSON::ObjectWriter* writer) {
+          Owned<AuthorizationAcceptor> authorizeRole;
+          Owned<AuthorizationAcceptor> authorizeFrameworkInfo;
+          Owned<AuthorizationAcceptor> authorizeTask;
+          Owned<AuthorizationAcceptor> authorizeExecutorInfo;
+          Owned<AuthorizationAcceptor> authorizeFlags;
+          tie(authorizeRole,
+              authorizeFrameworkInfo,
+              authorizeTask,
+              authorizeExecutorInfo,
+              authorizeFlags) = acceptors;
+
+          writer->field("version", MESOS_VERSION);
+
+          if (build::GIT_SHA.isSome()) {
+            writer->field("git_sha", build::GIT_SHA.get());
           }
 
-          if (master->flags.log_dir.isSome()) {
-            writer->field("log_dir", master->flags.log_dir.get());
+          if (build::GIT_BRANCH.isSome()) {
+            writer->field("git_branch", build::GIT_BRANCH.get());
           }
 
-          if (master->flags.external_log_file.isSome()) {
-            writer->field("external_log_file",
-                          master->flags.external_log_file.get());
+          if (build::GIT_TAG.isSome()) {
+            writer->field("git_tag", build::GIT_TAG.get());
           }
 
-          writer->field("flags", [this](JSON::ObjectWriter* writer) {
-              foreachvalue (const flags::Flag& flag, master->flags) {
-                Option<string> value = flag.stringify(master->flags);
-                if (value.isSome()) {
-                  writer->field(flag.effective_name().value, value.get());
+          writer->field("build_date", build::DATE);
+          writer->field("build_time", build::TIME);
+          writer->field("build_user", build::USER);
+          writer->field("start_time", master->startTime.secs());
+
+          if (master->electedTime.isSome()) {
+            writer->field("elected_time", master->electedTime.get().secs());
+          }
+
+          writer->field("id", master->info().id());
+          writer->field("state_version", master->stateChanges.version);
+          writer->field("pid", string(master->self()));
+          writer->field("hostname", master->info().hostname());
+          writer->field("capabilities", master->info().capabilities());
+          writer->field("activated_slaves", master->_slaves_active());
+          writer->field("deactivated_slaves", master->_slaves_inactive());
+          writer->field("unreachable_slaves", master->_slaves_unreachable());
+
+          if (master->info().has_domain()) {
+            writer->field("domain", master->info().domain());
+          }
+
+          // TODO(haosdent): Deprecated this in favor of `leader_info` below.
+          if (master->leader.isSome()) {
+            writer->field("leader", master->leader->pid());
+          }
+
+          if (master->leader.isSome()) {
+            writer->field("leader_info", [this](JSON::ObjectWriter* writer) {
+              json(writer, master->leader.get());
+            });
+          }
+
+          if (authorizeFlags->accept()) {
+            if (master->flags.cluster.isSome()) {
+              writer->field("cluster", master->flags.cluster.get());
+            }
+
+            if (master->flags.log_dir.isSome()) {
+              writer->field("log_dir", master->flags.log_dir.get());
+            }
+
+            if (master->flags.external_log_file.isSome()) {
+              writer->field("external_log_file",
+                            master->flags.external_log_file.get());
+            }
+
+            writer->field("flags", [this](JSON::ObjectWriter* writer) {
+                foreachvalue (const flags::Flag& flag, master->flags) {
+                  Option<string> value = flag.stringify(master->flags);
+                  if (value.isSome()) {
+                    writer->field(flag.effective_name().value, value.get());
+                  }
                 }
+              });
+          }
+
+          // Model all of the registered slaves.
+          writer->field("slaves",
+            [this, &authorizeRole](JSON::ArrayWriter* writer) {
+              foreachvalue (Slave* slave, master->slaves.registered) {
+                writer->element(SlaveWriter(*slave, authorizeRole));
               }
             });
-        }
 
-        // Model all of the registered slaves.
-        writer->field("slaves",
-          [this, &authorizeRole](JSON::ArrayWriter* writer) {
-            foreachvalue (Slave* slave, master->slaves.registered) {
-              writer->element(SlaveWriter(*slave, authorizeRole));
+          // Model all of the recovered slaves.
+          writer->field("recovered_slaves", [this](JSON::ArrayWriter* writer) {
+            foreachvalue (const SlaveInfo& slaveInfo,
+                          master->slaves.recovered) {
+              writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
+                json(writer, slaveInfo);
+              });
             }
           });
 
-        // Model all of the recovered slaves.
-        writer->field("recovered_slaves", [this](JSON::ArrayWriter* writer) {
-          foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
-            writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
-              json(writer, slaveInfo);
-            });
-          }
-        });
+          // Model all of the frameworks.
+          writer->field(
+              "frameworks",
+              [this,
+               &authorizeFrameworkInfo,
+               &authorizeTask,
+               &authorizeExecutorInfo](JSON::ArrayWriter* writer) {
+            foreachvalue (
+                Framework* framework,
+                master->frameworks.registered) {
+              // Skip unauthorized frameworks.
+              if (!authorizeFrameworkInfo->accept(framework->info)) {
+                continue;
+              }
 
-        // Model all of the frameworks.
-        writer->field(
-            "frameworks",
-            [this,
-             &authorizeFrameworkInfo,
-             &authorizeTask,
-             &authorizeExecutorInfo](JSON::ArrayWriter* writer) {
-          foreachvalue (
-              Framework* framework,
-              master->frameworks.registered) {
-            // Skip unauthorized frameworks.
-            if (!authorizeFrameworkInfo->accept(framework->info)) {
-              continue;
+              auto frameworkWriter = FullFrameworkWriter(
+                  authorizeTask,
+                  authorizeExecutorInfo,
+                  framework);
+
+              writer->element(frameworkWriter);
             }
+          });
 
-            auto frameworkWriter = FullFrameworkWriter(
-                authorizeTask,
-                authorizeExecutorInfo,
-                framework);
+          // Model all of the completed frameworks.
+          writer->field(
+              "completed_frameworks",
+              [this,
+               &authorizeFrameworkInfo,
+               &authorizeTask,
+               &authorizeExecutorInfo](JSON::ArrayWriter* writer) {
+            foreachvalue (const Owned<Framework>& framework,
+                          master->frameworks.completed) {
+              // Skip unauthorized frameworks.
+              if (!authorizeFrameworkInfo->accept(framework->info)) {
+                continue;
+              }
 
-            writer->element(frameworkWriter);
-          }
-        });
+              auto frameworkWriter = FullFrameworkWriter(
+                  authorizeTask,
+                  authorizeExecutorInfo,
+                  framework.get());
 
-        // Model all of the completed frameworks.
-        writer->field(
-            "completed_frameworks",
-            [this,
-             &authorizeFrameworkInfo,
-             &authorizeTask,
-             &authorizeExecutorInfo](JSON::ArrayWriter* writer) {
-          foreachvalue (const Owned<Framework>& framework,
-                        master->frameworks.completed) {
-            // Skip unauthorized frameworks.
-            if (!authorizeFrameworkInfo->accept(framework->info)) {
-              continue;
+              writer->element(frameworkWriter);
             }
+          });
 
-            auto frameworkWriter = FullFrameworkWriter(
-                authorizeTask,
-                authorizeExecutorInfo,
-                framework.get());
-
-            writer->element(frameworkWriter);
-          }
-        });
+          // Orphan tasks are no longer possible. We emit an empty array
+          // for the sake of backward compatibility.
+          writer->field("orphan_tasks", [](JSON::ArrayWriter*) {});
 
-        // Orphan tasks are no longer possible. We emit an empty array
-        // for the sake of backward compatibility.
-        writer->field("orphan_tasks", [](JSON::ArrayWriter*) {});
+          // Unregistered frameworks are no longer possible. We emit an
+          // empty array for the sake of backward compatibility.
+          writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
+        };
 
-        // Unregistered frameworks are no longer possible. We emit an
-        // empty array for the sake of backward compatibility.
-        writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
+        return OK(jsonify(state), request.url.query.get("jsonp"));
       };
 
-      return OK(jsonify(state), request.url.query.get("jsonp"));
+      return deferBatchedRequest(
+          batchKey("/state", request, principal), render);
     }));
 }
 
@@ -3329,146 +3858,158 @@ Future<Response> Master::Http::stateSummary(
 
   return collect(authorizeRole, authorizeFrameworkInfo).then(defer(
       master->self(),
-      [this, request](const tuple<Owned<AuthorizationAcceptor>,
-                                  Owned<AuthorizationAcceptor>>& acceptors)
-          -> Response {
-        auto stateSummary = [this, &acceptors](JSON::ObjectWriter* writer) {
-          Owned<AuthorizationAcceptor> authorizeRole;
-          Owned<AuthorizationAcceptor> authorizeFrameworkInfo;
-          tie(authorizeRole, authorizeFrameworkInfo) = acceptors;
-
-          writer->field("hostname", master->info().hostname());
-
-          if (master->flags.cluster.isSome()) {
-            writer->field("cluster", master->flags.cluster.get());
-          }
-
-          // We use the tasks in the 'Frameworks' struct to compute summaries
-          // for this endpoint. This is done 1) for consistency between the
-          // 'slaves' and 'frameworks' subsections below 2) because we want to
-          // provide summary information for frameworks that are currently
-          // registered 3) the frameworks keep a circular buffer of completed
-          // tasks that we can use to keep a limited view on the history of
-          // recent completed / failed tasks.
-
-          // Generate mappings from 'slave' to 'framework' and reverse.
-          SlaveFrameworkMapping slaveFrameworkMapping(
-              master->frameworks.registered);
-
-          // Generate 'TaskState' summaries for all framework and slave ids.
-          TaskStateSummaries taskStateSummaries(master->frameworks.registered);
-
-          // Model all of the slaves.
-          writer->field(
-              "slaves",
-              [this,
-               &slaveFrameworkMapping,
-               &taskStateSummaries,
-               &authorizeRole](JSON::ArrayWriter* writer) {
-                foreachvalue (Slave* slave, master->slaves.registered) {
-                  writer->element(
-                      [&slave,
-                       &slaveFrameworkMapping,
-                       &taskStateSummaries,
-                       &authorizeRole](JSON::ObjectWriter* writer) {
-                        SlaveWriter slaveWriter(*slave, authorizeRole);
-                        slaveWriter(writer);
-
-                        // Add the 'TaskState' summary for this slave.
-                        const TaskStateSummary& summary =
-                            taskStateSummaries.slave(slave->id);
-
-                        // Certain per-agent status totals will always be zero
-                        // (e.g., TASK_ERROR, TASK_UNREACHABLE). We report them
-                        // here anyway, for completeness.
-                        //
-                        // TODO(neilc): Update for TASK_GONE and
-                        // TASK_GONE_BY_OPERATOR.
-                        writer->field("TASK_STAGING", summary.staging);
-                        writer->field("TASK_STARTING", summary.starting);
-                        writer->field("TASK_RUNNING", summary.running);
-                        writer->field("TASK_KILLING", summary.killing);
-                        writer->field("TASK_FINISHED", summary.finished);
-                        writer->field("TASK_KILLED", summary.killed);
-                        writer->field("TASK_FAILED", summary.failed);
-                        writer->field("TASK_LOST", summary.lost);
-                        writer->field("TASK_ERROR", summary.error);
-                        writer->field("TASK_UNREACHABLE", summary.unreachable);
-
-                        // Add the ids of all the frameworks running on this
-                        // slave.
-                        const hashset<FrameworkID>& frameworks =
-                            slaveFrameworkMapping.frameworks(slave->id);
-
-                        writer->field(
-                            "framework_ids",
-                            [&frameworks](JSON::ArrayWriter* writer) {
-                              foreach (
-                                  const FrameworkID& frameworkId,
-                                  frameworks) {
-                                writer->element(frameworkId.value());
-                              }
-                            });
-                      });
-                }
-              });
+      [this, request, principal](
+          const tuple<Owned<AuthorizationAcceptor>,
+                      Owned<AuthorizationAcceptor>>& acceptors)
+          -> Future<Response> {
+        // Rendered by `processRequestsBatch()` together with the other
+        // read-only requests that are batched with this one.
+        auto render = [this, request, acceptors]() -> Response {
+          auto stateSummary = [this, &acceptors](JSON::ObjectWriter* writer) {
+            Owned<AuthorizationAcceptor> authorizeRole;
+            Owned<AuthorizationAcceptor> authorizeFrameworkInfo;
+            tie(authorizeRole, authorizeFrameworkInfo) = acceptors;
+
+            writer->field("hostname", master->info().hostname());
+
+            if (master->flags.cluster.isSome()) {
+              writer->field("cluster", master->flags.cluster.get());
+            }
 
-          // Model all of the frameworks.
-          writer->field(
-              "frameworks",
-              [this,
-               &slaveFrameworkMapping,
-               &taskStateSummaries,
-               &authorizeFrameworkInfo](JSON::ArrayWriter* writer) {
-                foreachpair (const FrameworkID& frameworkId,
-                             Framework* framework,
-                             master->frameworks.registered) {
-                  // Skip unauthorized frameworks.
-                  if (!authorizeFrameworkInfo->accept(framework->info)) {
-                    continue;
+            // We use the tasks in the 'Frameworks' struct to compute summaries
+            // for this endpoint. This is done 1) for consistency between the
+            // 'slaves' and 'frameworks' subsections below 2) because we want to
+            // provide summary information for frameworks that are currently
+            // registered 3) the frameworks keep a circular buffer of completed
+            // tasks that we can use to keep a limited view on the history of
+            // recent completed / failed tasks.
+
+            // Generate mappings from 'slave' to 'framework' and reverse.
+            SlaveFrameworkMapping slaveFrameworkMapping(
+                master->frameworks.registered);
+
+            // Generate 'TaskState' summaries for all framework and slave ids.
+            TaskStateSummaries taskStateSummaries(
+                master->frameworks.registered);
+
+            // Model all of the slaves.
+            writer->field(
+                "slaves",
+                [this,
+                 &slaveFrameworkMapping,
+                 &taskStateSummaries,
+                 &authorizeRole](JSON::ArrayWriter* writer) {
+                  foreachvalue (Slave* slave, master->slaves.registered) {
+                    writer->element(
+                        [&slave,
+                         &slaveFrameworkMapping,
+                         &taskStateSummaries,
+                         &authorizeRole](JSON::ObjectWriter* writer) {
+                          SlaveWriter slaveWriter(*slave, authorizeRole);
+                          slaveWriter(writer);
+
+                          // Add the 'TaskState' summary for this slave.
+                          const TaskStateSummary& summary =
+                              taskStateSummaries.slave(slave->id);
+
+                          // Certain per-agent status totals will always be
+                          // zero (e.g., TASK_ERROR, TASK_UNREACHABLE). We
+                          // report them here anyway, for completeness.
+                          //
+                          // TODO(neilc): Update for TASK_GONE and
+                          // TASK_GONE_BY_OPERATOR.
+                          writer->field("TASK_STAGING", summary.staging);
+                          writer->field("TASK_STARTING", summary.starting);
+                          writer->field("TASK_RUNNING", summary.running);
+                          writer->field("TASK_KILLING", summary.killing);
+                          writer->field("TASK_FINISHED", summary.finished);
+                          writer->field("TASK_KILLED", summary.killed);
+                          writer->field("TASK_FAILED", summary.failed);
+                          writer->field("TASK_LOST", summary.lost);
+                          writer->field("TASK_ERROR", summary.error);
+                          writer->field(
+                              "TASK_UNREACHABLE", summary.unreachable);
+
+                          // Add the ids of all the frameworks running on this
+                          // slave.
+                          const hashset<FrameworkID>& frameworks =
+                              slaveFrameworkMapping.frameworks(slave->id);
+
+                          writer->field(
+                              "framework_ids",
+                              [&frameworks](JSON::ArrayWriter* writer) {
+                                foreach (
+                                    const FrameworkID& frameworkId,
+                                    frameworks) {
+                                  writer->element(frameworkId.value());
+                                }
+                              });
+                        });
+                  }
+                });
+
+            // Model all of the frameworks.
+            writer->field(
+                "frameworks",
+                [this,
+                 &slaveFrameworkMapping,
+                 &taskStateSummaries,
+                 &authorizeFrameworkInfo](JSON::ArrayWriter* writer) {
+                  foreachpair (const FrameworkID& frameworkId,
+                               Framework* framework,
+                               master->frameworks.registered) {
+                    // Skip unauthorized frameworks.
+                    if (!authorizeFrameworkInfo->accept(framework->info)) {
+                      continue;
+                    }
+
+                    writer->element(
+                        [&frameworkId,
+                         &framework,
+                         &slaveFrameworkMapping,
+                         &taskStateSummaries](JSON::ObjectWriter* writer) {
+                          json(writer, Summary<Framework>(*framework));
+
+                          // Add the 'TaskState' summary for this framework.
+                          const TaskStateSummary& summary =
+                              taskStateSummaries.framework(frameworkId);
+
+                          // TODO(neilc): Update for TASK_GONE and
+                          // TASK_GONE_BY_OPERATOR.
+                          writer->field("TASK_STAGING", summary.staging);
+                          writer->field("TASK_STARTING", summary.starting);
+                          writer->field("TASK_RUNNING", summary.running);
+                          writer->field("TASK_KILLING", summary.killing);
+                          writer->field("TASK_FINISHED", summary.finished);
+                          writer->field("TASK_KILLED", summary.killed);
+                          writer->field("TASK_FAILED", summary.failed);
+                          writer->field("TASK_LOST", summary.lost);
+                          writer->field("TASK_ERROR", summary.error);
+                          writer->field(
+                              "TASK_UNREACHABLE", summary.unreachable);
+
+                          // Add the ids of all the slaves running this
+                          // framework.
+                          const hashset<SlaveID>& slaves =
+                              slaveFrameworkMapping.slaves(frameworkId);
+
+                          writer->field(
+                              "slave_ids",
+                              [&slaves](JSON::ArrayWriter* writer) {
+                                foreach (const SlaveID& slaveId, slaves) {
+                                  writer->element(slaveId.value());
+                                }
+                              });
+                        });
                   }
+                });
+          };
 
-                  writer->element(
-                      [&frameworkId,
-                       &framework,
-                       &slaveFrameworkMapping,
-                       &taskStateSummaries](JSON::ObjectWriter* writer) {
-                        json(writer, Summary<Framework>(*framework));
-
-                        // Add the 'TaskState' summary for this framework.
-                        const TaskStateSummary& summary =
-                            taskStateSummaries.framework(frameworkId);
-
-                        // TODO(neilc): Update for TASK_GONE and
-                        // TASK_GONE_BY_OPERATOR.
-                        writer->field("TASK_STAGING", summary.staging);
-                        writer->field("TASK_STARTING", summary.starting);
-                        writer->field("TASK_RUNNING", summary.running);
-                        writer->field("TASK_KILLING", summary.killing);
-                        writer->field("TASK_FINISHED", summary.finished);
-                        writer->field("TASK_KILLED", summary.killed);
-                        writer->field("TASK_FAILED", summary.failed);
-                        writer->field("TASK_LOST", summary.lost);
-                        writer->field("TASK_ERROR", summary.error);
-                        writer->field("TASK_UNREACHABLE", summary.unreachable);
-
-                        // Add the ids of all the slaves running this framework.
-                        const hashset<SlaveID>& slaves =
-                            slaveFrameworkMapping.slaves(frameworkId);
-
-                        writer->field(
-                            "slave_ids",
-                            [&slaves](JSON::ArrayWriter* writer) {
-                              foreach (const SlaveID& slaveId, slaves) {
-                                writer->element(slaveId.value());
-                              }
-                            });
-                      });
-                }
-              });
+          return OK(jsonify(stateSummary), request.url.query.get("jsonp"));
         };
 
-        return OK(jsonify(stateSummary), request.url.query.get("jsonp"));
+        return deferBatchedRequest(
+            batchKey("/state-summary", request, principal), render);
       }));
 }
 
@@ -4089,7 +4630,10 @@ Future<Response> Master::Http::tasks(
           // Construct task list with both running,
           // completed and unreachable tasks.
           vector<const Task*> tasks;
+          hashmap<FrameworkID, const Framework*> owners;
           foreach (const Framework* framework, frameworks) {
+            owners[framework->id()] = framework;
+
             foreachvalue (Task* task, framework->tasks) {
               CHECK_NOTNULL(task);
               // Skip unauthorized tasks or tasks without matching task ID.
@@ -4134,13 +4678,18 @@ Future<Response> Master::Http::tasks(
           }
 
           auto tasksWriter =
-            [&tasks, limit, offset](JSON::ObjectWriter* writer) {
-            writer->field("tasks",
-                          [&tasks, limit, offset](JSON::ArrayWriter* writer) {
+            [&tasks, &owners, limit, offset](JSON::ObjectWriter* writer) {
+            writer->field(
+                "tasks",
+                [&tasks, &owners, limit, offset](JSON::ArrayWriter* writer) {
               // Collect 'limit' number of tasks starting from 'offset'.
               size_t end = std::min(offset + limit, tasks.size());
               for (size_t i = offset; i < end; i++) {
-                writer->element(*tasks[i]);
+                const Framework* framework =
+                  owners.at(tasks[i]->framework_id());
+
+                writer->element(
+                    JSON::RawValue(framework->renderTask(*tasks[i])));
               }
             });
           };
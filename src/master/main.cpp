@@ -68,6 +68,7 @@
 #include "logging/flags.hpp"
 #include "logging/logging.hpp"
 
+#include "master/constants.hpp"
 #include "master/master.hpp"
 #include "master/registrar.hpp"
 
@@ -97,6 +98,9 @@ using mesos::log::Log;
 
 using mesos::allocator::Allocator;
 
+using mesos::internal::master::allocator::AllocatorOptions;
+using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+
 using mesos::master::contender::MasterContender;
 
 using mesos::master::detector::MasterDetector;
@@ -327,7 +331,32 @@ int main(int argc, char** argv)
 
   // Create an instance of allocator.
   const string allocatorName = flags.allocator;
-  Try<Allocator*> allocator = Allocator::create(allocatorName);
+
+  if (flags.allocator_trace.isSome() &&
+      allocatorName != DEFAULT_ALLOCATOR) {
+    EXIT(EXIT_FAILURE)
+      << "Flag '--allocator_trace' is only supported by the default"
+      << " allocator";
+  }
+
+  if ((flags.allocation_threads != 1 ||
+       flags.allocation_sweep_interval.isSome()) &&
+      allocatorName != DEFAULT_ALLOCATOR) {
+    EXIT(EXIT_FAILURE)
+      << "Flags '--allocation_threads' and '--allocation_sweep_interval'"
+      << " are only supported by the default allocator";
+  }
+
+  // The options of the default allocator are given at creation since
+  // they are not part of the allocator module interface.
+  AllocatorOptions allocatorOptions;
+  allocatorOptions.allocationThreads = flags.allocation_threads;
+  allocatorOptions.allocationSweepInterval = flags.allocation_sweep_interval;
+  allocatorOptions.tracePath = flags.allocator_trace;
+
+  Try<Allocator*> allocator = allocatorName == DEFAULT_ALLOCATOR
+    ? HierarchicalDRFAllocator::create(allocatorOptions)
+    : Allocator::create(allocatorName);
 
   if (allocator.isError()) {
     EXIT(EXIT_FAILURE)
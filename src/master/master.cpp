@@ -2677,6 +2677,8 @@ void Master::_subscribe(
     // Start the heartbeat after sending SUBSCRIBED event.
     framework->heartbeat();
 
+    stateChanges.framework(framework->id());
+
     if (!subscribers.subscribed.empty()) {
       subscribers.send(
           protobuf::master::event::createFrameworkAdded(*framework));
@@ -2728,6 +2730,8 @@ void Master::_subscribe(
     }
   }
 
+  stateChanges.framework(framework->id());
+
   if (!subscribers.subscribed.empty()) {
     subscribers.send(
         protobuf::master::event::createFrameworkUpdated(*framework));
@@ -2982,6 +2986,8 @@ void Master::_subscribe(
     message.mutable_master_info()->MergeFrom(info_);
     framework->send(message);
 
+    stateChanges.framework(framework->id());
+
     if (!subscribers.subscribed.empty()) {
       subscribers.send(
           protobuf::master::event::createFrameworkAdded(*framework));
@@ -3059,6 +3065,8 @@ void Master::_subscribe(
       LOG(INFO) << "Framework " << *framework << " failed over";
       failoverFramework(framework, from);
 
+      stateChanges.framework(framework->id());
+
       if (!subscribers.subscribed.empty()) {
         subscribers.send(
             protobuf::master::event::createFrameworkUpdated(*framework));
@@ -3111,6 +3119,8 @@ void Master::_subscribe(
       message.mutable_master_info()->MergeFrom(info_);
       framework->send(message);
 
+      stateChanges.framework(framework->id());
+
       if (!subscribers.subscribed.empty()) {
         subscribers.send(
             protobuf::master::event::createFrameworkUpdated(*framework));
@@ -3132,6 +3142,8 @@ void Master::_subscribe(
       return;
     }
 
+    stateChanges.framework(framework->id());
+
     if (!subscribers.subscribed.empty()) {
       subscribers.send(
           protobuf::master::event::createFrameworkUpdated(*framework));
@@ -3218,6 +3230,8 @@ void Master::disconnect(Framework* framework)
 
   framework->state = Framework::State::DISCONNECTED;
 
+  stateChanges.framework(framework->id());
+
   if (framework->pid.isSome()) {
     // Remove the framework from authenticated. This is safe because
     // a framework will always reauthenticate before (re-)registering.
@@ -3241,6 +3255,8 @@ void Master::deactivate(Framework* framework, bool rescind)
 
   framework->state = Framework::State::INACTIVE;
 
+  stateChanges.framework(framework->id());
+
   // Tell the allocator to stop allocating resources to this framework.
   allocator->deactivateFramework(framework->id());
 
@@ -3278,6 +3294,8 @@ void Master::disconnect(Slave* slave)
 
   slave->connected = false;
 
+  stateChanges.agent(slave->id);
+
   // Inform the slave observer.
   dispatch(slave->observer, &SlaveObserver::disconnect);
 
@@ -3297,6 +3315,8 @@ void Master::deactivate(Slave* slave)
 
   slave->active = false;
 
+  stateChanges.agent(slave->id);
+
   allocator->deactivateSlave(slave->id);
 
   // Remove and rescind offers.
@@ -7044,6 +7064,10 @@ void Master::___reregisterSlave(
 
   slave->reregisteredTime = Clock::now();
 
+  // The agent info, version and capabilities might have changed, and
+  // the agent might be reconnected below.
+  stateChanges.agent(slave->id);
+
   allocator->updateSlave(
     slave->id,
     slave->info,
@@ -8753,28 +8777,14 @@ void Master::offer(
       // separate offers, so that rescinding offers with revocable
       // resources does not affect offers with regular resources.
 
-      // TODO(bmahler): Set "https" if only "https" is supported.
-      mesos::URL url;
-      url.set_scheme("http");
-      url.mutable_address()->set_hostname(slave->info.hostname());
-      url.mutable_address()->set_ip(stringify(slave->pid.address.ip));
-      url.mutable_address()->set_port(slave->pid.address.port);
-      url.set_path("/" + slave->pid.id);
-
-      Offer* offer = new Offer();
+      // The fields that only depend on the agent are cached across
+      // allocation cycles, see `Slave::offerTemplate()`.
+      Offer* offer = new Offer(slave->offerTemplate());
       offer->mutable_id()->MergeFrom(newOfferId());
       offer->mutable_framework_id()->MergeFrom(framework->id());
-      offer->mutable_slave_id()->MergeFrom(slave->id);
-      offer->set_hostname(slave->info.hostname());
-      offer->mutable_url()->MergeFrom(url);
       offer->mutable_resources()->MergeFrom(offered);
-      offer->mutable_attributes()->MergeFrom(slave->info.attributes());
       offer->mutable_allocation_info()->set_role(role);
 
-      if (slave->info.has_domain()) {
-        offer->mutable_domain()->MergeFrom(slave->info.domain());
-      }
-
       // Add all framework's executors running on this slave.
       if (slave->executors.contains(framework->id())) {
         const hashmap<ExecutorID, ExecutorInfo>& executors =
@@ -8806,15 +8816,17 @@ void Master::offer(
                 offer->id());
       }
 
+      // The offer sent to the framework is built in place in the
+      // message to avoid copying it again.
+      Offer& offer_ = *message.add_offers();
+      offer_.CopyFrom(*offer);
+
       // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
       // offers so that frameworks do not see this resource. This is a
       // short term workaround. Revisit this once we resolve MESOS-1654.
-      Offer offer_ = *offer;
-      offer_.clear_resources();
-
-      foreach (const Resource& resource, offered) {
-        if (resource.name() != "ephemeral_ports") {
-          offer_.add_resources()->CopyFrom(resource);
+      for (int i = offer_.resources_size() - 1; i >= 0; i--) {
+        if (offer_.resources(i).name() == "ephemeral_ports") {
+          offer_.mutable_resources()->DeleteSubrange(i, 1);
         }
       }
 
@@ -8840,8 +8852,7 @@ void Master::offer(
             offer_.mutable_resources(), PRE_RESERVATION_REFINEMENT);
       }
 
-      // Add the offer *AND* the corresponding slave's PID.
-      message.add_offers()->MergeFrom(offer_);
+      // Add the corresponding slave's PID for the offer.
       message.add_pids(slave->pid);
     }
   }
@@ -9515,6 +9526,8 @@ void Master::_failoverFramework(Framework* framework)
   if (!framework->active()) {
     framework->state = Framework::State::ACTIVE;
     allocator->activateFramework(framework->id());
+
+    stateChanges.framework(framework->id());
   }
 
   // The scheduler driver safely ignores any duplicate registration
@@ -9706,6 +9719,8 @@ void Master::removeFramework(Framework* framework)
   // The framework pointer is now owned by `frameworks.completed`.
   frameworks.completed.set(framework->id(), Owned<Framework>(framework));
 
+  stateChanges.framework(framework->id());
+
   if (!subscribers.subscribed.empty()) {
     subscribers.send(
         protobuf::master::event::createFrameworkRemoved(framework->info));
@@ -9876,6 +9891,8 @@ void Master::addSlave(
       slave->totalResources,
       slave->usedResources);
 
+  stateChanges.agent(slave->id);
+
   if (!subscribers.subscribed.empty()) {
     subscribers.send(protobuf::master::event::createAgentAdded(*slave));
   }
@@ -10052,6 +10069,8 @@ void Master::_removeSlave(
 
   sendSlaveLost(slave->info);
 
+  stateChanges.agent(slave->id);
+
   if (!subscribers.subscribed.empty()) {
     subscribers.send(protobuf::master::event::createAgentRemoved(slave->id));
   }
@@ -10177,6 +10196,8 @@ void Master::__removeSlave(
   // This requires a new capability.
   sendSlaveLost(slave->info);
 
+  stateChanges.agent(slave->id);
+
   delete slave;
 }
 
@@ -10241,6 +10262,16 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
   // MESOS-1746.
   task->mutable_statuses(task->statuses_size() - 1)->clear_data();
 
+  // The cached rendering of the task (if any) is now stale.
+  Framework* framework = getFramework(task->framework_id());
+  if (framework != nullptr) {
+    framework->invalidateRenderedTask(task);
+  }
+
+  // Unlike the event below, every update is a change of the state
+  // since it is included in the statuses of the task.
+  stateChanges.task(task->framework_id(), task->task_id());
+
   if (sendSubscribersUpdate && !subscribers.subscribed.empty()) {
     subscribers.send(protobuf::master::event::createTaskUpdated(
         *task, task->state(), status));
@@ -10266,7 +10297,6 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 
     slave->recoverResources(task);
 
-    Framework* framework = getFramework(task->framework_id());
     if (framework != nullptr) {
       framework->recoverResources(task);
     }
@@ -11423,6 +11453,84 @@ void Master::Subscribers::Subscriber::send(
 }
 
 
+void Master::StateChanges::framework(const FrameworkID& frameworkId)
+{
+  Change change;
+  change.frameworkId = frameworkId;
+  record(std::move(change));
+}
+
+
+void Master::StateChanges::agent(const SlaveID& slaveId)
+{
+  Change change;
+  change.slaveId = slaveId;
+  record(std::move(change));
+}
+
+
+void Master::StateChanges::task(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId)
+{
+  Change change;
+  change.frameworkId = frameworkId;
+  change.taskId = taskId;
+  record(std::move(change));
+}
+
+
+void Master::StateChanges::executor(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const ExecutorID& executorId)
+{
+  Change change;
+  change.frameworkId = frameworkId;
+  change.slaveId = slaveId;
+  change.executorId = executorId;
+  record(std::move(change));
+}
+
+
+void Master::StateChanges::record(Change&& change)
+{
+  change.version = ++version;
+  changes.push_back(std::move(change));
+}
+
+
+Option<Master::StateChanges::Delta> Master::StateChanges::since(
+    uint64_t _version) const
+{
+  // The changes of all the versions after `_version` must still be
+  // kept, i.e., the oldest kept change must be at most `_version + 1`.
+  if (_version > version || _version < version - changes.size()) {
+    return None();
+  }
+
+  Delta delta;
+
+  // Only the most recent changes need to be visited.
+  for (auto change = changes.end() - (version - _version);
+       change != changes.end();
+       ++change) {
+    if (change->taskId.isSome()) {
+      delta.tasks[change->frameworkId.get()].insert(change->taskId.get());
+    } else if (change->executorId.isSome()) {
+      delta.executors[change->frameworkId.get()][change->slaveId.get()]
+        .insert(change->executorId.get());
+    } else if (change->frameworkId.isSome()) {
+      delta.frameworks.insert(change->frameworkId.get());
+    } else {
+      delta.agents.insert(change->slaveId.get());
+    }
+  }
+
+  return delta;
+}
+
+
 void Master::exited(const id::UUID& id)
 {
   if (!subscribers.subscribed.contains(id)) {
@@ -11554,6 +11662,8 @@ void Slave::addTask(Task* task)
     usedResources[frameworkId] += resources;
   }
 
+  master->stateChanges.task(frameworkId, task->task_id());
+
   if (!master->subscribers.subscribed.empty()) {
     master->subscribers.send(protobuf::master::event::createTaskAdded(*task));
   }
@@ -11811,6 +11921,8 @@ Try<Nothing> Slave::update(
   info = _info;
   checkpointedResources = _checkpointedResources;
 
+  cachedOfferTemplate = None();
+
   // There is a short window here where `totalResources` can have an old value,
   // but it should be relatively short because the agent will send
   // an `UpdateSlaveMessage` with the new total resources immediately after
@@ -11824,6 +11936,39 @@ Try<Nothing> Slave::update(
   return Nothing();
 }
 
+
+const Offer& Slave::offerTemplate()
+{
+  // NOTE: The pid is updated without going through `update()` when
+  // the agent re-registers, hence we check it here.
+  if (cachedOfferTemplate.isSome() && cachedOfferTemplatePid == pid) {
+    return cachedOfferTemplate.get();
+  }
+
+  // TODO(bmahler): Set "https" if only "https" is supported.
+  mesos::URL url;
+  url.set_scheme("http");
+  url.mutable_address()->set_hostname(info.hostname());
+  url.mutable_address()->set_ip(stringify(pid.address.ip));
+  url.mutable_address()->set_port(pid.address.port);
+  url.set_path("/" + pid.id);
+
+  Offer offer;
+  offer.mutable_slave_id()->CopyFrom(id);
+  offer.set_hostname(info.hostname());
+  offer.mutable_url()->CopyFrom(url);
+  offer.mutable_attributes()->CopyFrom(info.attributes());
+
+  if (info.has_domain()) {
+    offer.mutable_domain()->CopyFrom(info.domain());
+  }
+
+  cachedOfferTemplate = offer;
+  cachedOfferTemplatePid = pid;
+
+  return cachedOfferTemplate.get();
+}
+
 } // namespace master {
 } // namespace internal {
 } // namespace mesos {
@@ -58,6 +58,7 @@
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
 #include <stout/linkedhashmap.hpp>
 #include <stout/multihashmap.hpp>
 #include <stout/nothing.hpp>
@@ -183,6 +184,12 @@ Slave(Master* const _master,
       const Resources& _checkpointedResources,
       const Option<id::UUID>& resourceVersion);
 
+  // Returns an offer with only the fields that are the same for all
+  // offers of this agent set (i.e., agent ID, hostname, URL, attributes
+  // and domain). This is cached across allocation cycles, and rebuilt
+  // when the agent info or pid changes.
+  const Offer& offerTemplate();
+
   Master* const master;
   const SlaveID id;
   SlaveInfo info;
@@ -282,6 +289,10 @@ Slave(Master* const _master,
   hashmap<ResourceProviderID, ResourceProviderInfo> resourceProviders;
 
 private:
+  // See `offerTemplate()`.
+  Option<Offer> cachedOfferTemplate;
+  process::UPID cachedOfferTemplatePid;
+
   Slave(const Slave&);              // No copying.
   Slave& operator=(const Slave&); // No assigning.
 };
@@ -1702,6 +1713,58 @@ private:
         const process::Owned<ObjectApprover>& executorsApprover,
         const process::Owned<AuthorizationAcceptor>& rolesAcceptor) const;
 
+    // The current state of the objects that changed after some version
+    // of the master's state, see `Master::StateChanges`. The objects
+    // that the master no longer knows about are listed by their IDs,
+    // except for frameworks (and their tasks and executors) that are
+    // not even kept as completed anymore, which cannot be authorized.
+    struct StateDelta
+    {
+      // The version of the master's state this was taken at.
+      uint64_t version;
+
+      std::vector<const Slave*> agents;
+      std::vector<SlaveID> removedAgents;
+
+      std::vector<const Framework*> frameworks;
+      std::vector<const Framework*> completedFrameworks;
+
+      // Tasks along with their frameworks.
+      typedef std::pair<const Framework*, const Task*> FrameworkTask;
+      std::vector<FrameworkTask> tasks;
+      std::vector<FrameworkTask> unreachableTasks;
+      std::vector<FrameworkTask> completedTasks;
+      std::vector<std::pair<const Framework*, TaskID>> removedTasks;
+
+      // `info` is only set for the executors that still exist.
+      struct Executor
+      {
+        const Framework* framework;
+        SlaveID slaveId;
+        ExecutorID executorId;
+        const ExecutorInfo* info;
+      };
+
+      std::vector<Executor> executors;
+      std::vector<Executor> removedExecutors;
+    };
+
+    // Returns `None` if the changes since `since` are not known, in
+    // which case the full state needs to be returned. This is also the
+    // case if `masterId` is not the ID of this master, because `since`
+    // was then handed out by another (e.g., a previously elected) one.
+    Option<StateDelta> stateDelta(
+        const Option<std::string>& masterId,
+        uint64_t since) const;
+
+    mesos::master::Response::GetState _getState(
+        uint64_t since,
+        const StateDelta& delta,
+        const process::Owned<ObjectApprover>& frameworksApprover,
+        const process::Owned<ObjectApprover>& tasksApprover,
+        const process::Owned<ObjectApprover>& executorsApprover,
+        const process::Owned<AuthorizationAcceptor>& rolesAcceptor) const;
+
     process::Future<process::http::Response> subscribe(
         const mesos::master::Call& call,
         const Option<process::http::authentication::Principal>& principal,
@@ -1725,6 +1788,35 @@ private:
     process::Future<process::http::Response> _markAgentGone(
         const SlaveID& slaveId) const;
 
+    // Renders the response to a read-only request (/state and
+    // /state-summary) together with the other read-only requests
+    // that arrive before the master gets to render them, see
+    // `processRequestsBatch()`. Requests with the same `key`, i.e.,
+    // for the same endpoint, principal and query, share one rendering.
+    process::Future<process::http::Response> deferBatchedRequest(
+        const std::string& key,
+        const lambda::function<process::http::Response()>& render) const;
+
+    // Renders the responses of all batched requests on the master
+    // actor, once per distinct request.
+    //
+    // NOTE: This does not take the rendering off the master actor, it
+    // only saves the renderings of identical requests that arrive
+    // while the master is busy. Taking the rendering off the master
+    // requires an immutable snapshot of the master state for separate
+    // query actors, which is not implemented.
+    void processRequestsBatch() const;
+
+    struct BatchedRequest
+    {
+      std::string key;
+      lambda::function<process::http::Response()> render;
+      process::Owned<process::Promise<process::http::Response>> promise;
+    };
+
+    // Read-only requests waiting for `processRequestsBatch()`.
+    mutable std::vector<BatchedRequest> batchedRequests;
+
     Master* master;
 
     // NOTE: The quota specific pieces of the Operator API are factored
@@ -2037,6 +2129,72 @@ private:
 
   Subscribers subscribers;
 
+  // A version of the master's state, bumped for every change that is
+  // reported to the subscribers above (whether or not there are any),
+  // as well as for every task status update and for executors being
+  // added or removed, which have no events of their own. The changes
+  // of the most recent versions are kept so that the /state endpoint
+  // and the `GET_STATE` call can return only the objects that changed
+  // since a version the client already has.
+  //
+  // NOTE: Changes to the resources used or offered on an agent or by
+  // a framework are not versioned, as they change with every offer.
+  struct StateChanges
+  {
+    StateChanges() : changes(MAX_STATE_CHANGES) {}
+
+    // The objects that changed after some version.
+    struct Delta
+    {
+      hashset<FrameworkID> frameworks;
+      hashset<SlaveID> agents;
+      hashmap<FrameworkID, hashset<TaskID>> tasks;
+      hashmap<FrameworkID, hashmap<SlaveID, hashset<ExecutorID>>> executors;
+    };
+
+    void framework(const FrameworkID& frameworkId);
+    void agent(const SlaveID& slaveId);
+    void task(const FrameworkID& frameworkId, const TaskID& taskId);
+
+    void executor(
+        const FrameworkID& frameworkId,
+        const SlaveID& slaveId,
+        const ExecutorID& executorId);
+
+    // Returns the objects that changed after `version`, or `None` if
+    // the changes since then are not known, i.e., if `version` is newer
+    // than the current one, or older than the oldest change that is
+    // kept; the client needs the full state then.
+    Option<Delta> since(uint64_t version) const;
+
+    // NOTE: Versions start at 0 in every master, hence they are only
+    // meaningful together with the ID of the master that handed them
+    // out, see `Master::Http::stateDelta()`.
+    uint64_t version = 0;
+
+  private:
+    struct Change
+    {
+      uint64_t version;
+
+      // Which of these are set determines the kind of the object that
+      // changed: frameworks and agents are identified by their ID only,
+      // tasks by their framework and task ID, and executors by their
+      // framework, agent and executor ID.
+      Option<FrameworkID> frameworkId;
+      Option<SlaveID> slaveId;
+      Option<TaskID> taskId;
+      Option<ExecutorID> executorId;
+    };
+
+    void record(Change&& change);
+
+    // The changes of the most recent versions, oldest first.
+    boost::circular_buffer<Change> changes;
+  };
+
+  StateChanges stateChanges;
+
   hashmap<OfferID, Offer*> offers;
   hashmap<OfferID, process::Timer> offerTimers;
 
@@ -2238,6 +2396,7 @@ struct Framework
     }
 
     tasks[task->task_id()] = task;
+    invalidateRenderedTask(task);
 
     // Unreachable tasks should be added via `addUnreachableTask`.
     CHECK(task->state() != TASK_UNREACHABLE)
@@ -2339,13 +2498,58 @@ struct Framework
     // means that there might be multiple completed tasks with the
     // same task ID. We should consider rejecting attempts to reuse
     // task IDs (MESOS-6779).
-    completedTasks.push_back(process::Owned<Task>(new Task(std::move(task))));
+    process::Owned<Task> completed(new Task(std::move(task)));
+    invalidateRenderedTask(completed.get());
+    completedTasks.push_back(completed);
   }
 
   void addUnreachableTask(const Task& task)
   {
     // TODO(adam-mesos): Check if unreachable task already exists.
-    unreachableTasks.set(task.task_id(), process::Owned<Task>(new Task(task)));
+    process::Owned<Task> unreachable(new Task(task));
+    invalidateRenderedTask(unreachable.get());
+    unreachableTasks.set(task.task_id(), unreachable);
+  }
+
+  // Returns the JSON rendering of one of the tasks of this framework,
+  // rendering it on first use, see `renderedTasks`. This is defined
+  // in `master/http.cpp` alongside the endpoints that use it.
+  const std::string& renderTask(const Task& task) const;
+
+  // Drops the cached rendering of the task. This must be called
+  // whenever the task is mutated and whenever a `Task` is added to
+  // this framework, because the address of a destroyed task may be
+  // reused for the new one.
+  void invalidateRenderedTask(const Task* task)
+  {
+    renderedTasks.erase(task);
+
+    // The renderings of destroyed tasks are not dropped eagerly,
+    // instead we prune them once they make up half of the cache.
+    const size_t live =
+      tasks.size() + completedTasks.size() + unreachableTasks.size();
+
+    if (renderedTasks.size() > 2 * live) {
+      hashset<const Task*> alive;
+
+      foreachvalue (Task* running, tasks) {
+        alive.insert(running);
+      }
+      foreach (const process::Owned<Task>& completed, completedTasks) {
+        alive.insert(completed.get());
+      }
+      foreachvalue (
+          const process::Owned<Task>& unreachable,
+          unreachableTasks) {
+        alive.insert(unreachable.get());
+      }
+
+      foreach (const Task* rendered, renderedTasks.keys()) {
+        if (!alive.contains(rendered)) {
+          renderedTasks.erase(rendered);
+        }
+      }
+    }
   }
 
   // Removes the task. `unreachable` indicates whether the task is removed due
@@ -2376,6 +2580,8 @@ struct Framework
     }
 
     tasks.erase(task->task_id());
+
+    master->stateChanges.task(id(), task->task_id());
   }
 
   void addOffer(Offer* offer)
@@ -2439,6 +2645,8 @@ struct Framework
     totalUsedResources += executorInfo.resources();
     usedResources[slaveId] += executorInfo.resources();
 
+    master->stateChanges.executor(id(), slaveId, executorInfo.executor_id());
+
     // It's possible that we're not tracking the task's role for
     // this framework if the role is absent from the framework's
     // set of roles. In this case, we track the role's allocation
@@ -2487,6 +2695,8 @@ struct Framework
       }
     }
 
+    master->stateChanges.executor(id(), slaveId, executorId);
+
     executors[slaveId].erase(executorId);
     if (executors[slaveId].empty()) {
       executors.erase(slaveId);
@@ -2845,6 +3055,13 @@ struct Framework
   // TASK_LOST instead of TASK_UNREACHABLE for backward compatibility.
   BoundedHashMap<TaskID, process::Owned<Task>> unreachableTasks;
 
+  // JSON renderings of the tasks above, keyed by the address of the
+  // task, so that the state endpoints only re-serialize the tasks that
+  // changed since they were last rendered. Completed and unreachable
+  // tasks are never mutated, so their renderings stay valid for as long
+  // as the tasks are kept.
+  mutable hashmap<const Task*, std::string> renderedTasks;
+
   hashset<Offer*> offers; // Active offers for framework.
 
   hashset<InverseOffer*> inverseOffers; // Active inverse offers for framework.
@@ -131,8 +131,12 @@ Try<process::Owned<Master>> Master::start(
 
   // If the allocator is not provided, create a default one.
   if (allocator.isNone()) {
+    master::allocator::AllocatorOptions options;
+    options.allocationThreads = flags.allocation_threads;
+    options.allocationSweepInterval = flags.allocation_sweep_interval;
+
     Try<mesos::allocator::Allocator*> _allocator =
-      master::allocator::HierarchicalDRFAllocator::create();
+      master::allocator::HierarchicalDRFAllocator::create(options);
 
     if (_allocator.isError()) {
       return Error(
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <atomic>
+#include <deque>
 #include <iostream>
 #include <set>
 #include <string>
@@ -37,12 +38,19 @@
 #include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/recordio.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/utils.hpp>
 
+#include <stout/tests/utils.hpp>
+
 #include "master/constants.hpp"
 #include "master/flags.hpp"
 
+#include "master/allocator/trace.pb.h"
+
 #include "master/allocator/mesos/hierarchical.hpp"
 
 #include "slave/constants.hpp"
@@ -55,6 +63,8 @@
 using mesos::internal::master::MIN_CPUS;
 using mesos::internal::master::MIN_MEM;
 
+using mesos::internal::master::allocator::AllocatorOptions;
+using mesos::internal::master::allocator::Call;
 using mesos::internal::master::allocator::HierarchicalDRFAllocator;
 
 using mesos::internal::protobuf::createLabel;
@@ -126,7 +136,7 @@ struct Deallocation
 };
 
 
-class HierarchicalAllocatorTestBase : public ::testing::Test
+class HierarchicalAllocatorTestBase : public TemporaryDirectoryTest
 {
 protected:
   HierarchicalAllocatorTestBase()
@@ -176,11 +186,28 @@ protected:
         };
     }
 
+    // These are options of the hierarchical allocator rather than of
+    // `Allocator::initialize`, so the allocator is recreated with them.
+    if (flags.allocation_threads != 1 ||
+        flags.allocation_sweep_interval.isSome()) {
+      AllocatorOptions options;
+      options.allocationThreads = flags.allocation_threads;
+      options.allocationSweepInterval = flags.allocation_sweep_interval;
+
+      Try<Allocator*> create = HierarchicalDRFAllocator::create(options);
+      CHECK_SOME(create);
+
+      delete allocator;
+      allocator = create.get();
+    }
+
     allocator->initialize(
         flags.allocation_interval,
         offerCallback.get(),
         inverseOfferCallback.get(),
-        flags.fair_sharing_excluded_resource_names);
+        flags.fair_sharing_excluded_resource_names,
+        flags.filter_gpu_resources,
+        flags.domain);
   }
 
   SlaveInfo createSlaveInfo(const Resources& resources)
@@ -3931,6 +3958,73 @@ TEST_F(HierarchicalAllocatorTest, QuotaAbsentFramework)
 }
 
 
+// This test ensures that when the agents are allocated on multiple
+// threads, the headroom required by quota is still held back, even
+// though each thread on its own sees enough headroom to allocate all
+// of its agents.
+TEST_F(HierarchicalAllocatorTest, QuotaHeadroomAllocationThreads)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  const string QUOTA_ROLE{"quota-role"};
+  const string NO_QUOTA_ROLE{"no-quota-role"};
+
+  master::Flags flags_;
+  flags_.allocation_threads = 2;
+
+  initialize(flags_);
+
+  // Set quota for the quota'ed role. This role isn't registered with
+  // the allocator yet.
+  const Quota quota = createQuota(QUOTA_ROLE, "cpus:2;mem:1024");
+  allocator->setQuota(QUOTA_ROLE, quota);
+
+  // NOTE: No allocations happen because there are no frameworks.
+  for (int i = 0; i < 4; i++) {
+    SlaveInfo agent = createSlaveInfo("cpus:1;mem:512;disk:0");
+    allocator->addSlave(
+        agent.id(),
+        agent,
+        AGENT_CAPABILITIES(),
+        None(),
+        agent.resources(),
+        {});
+  }
+
+  Clock::settle();
+
+  // Adding `framework` triggers an allocation of all four agents,
+  // which are split across two threads. Each thread sees enough
+  // headroom to allocate both of its agents, but only two of the
+  // agents can be allocated while holding back (cpus=2, mem=1024)
+  // for `QUOTA_ROLE`.
+  FrameworkInfo framework = createFrameworkInfo({NO_QUOTA_ROLE});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  Future<Allocation> allocation = allocations.get();
+  AWAIT_READY(allocation);
+
+  EXPECT_EQ(framework.id(), allocation->frameworkId);
+  ASSERT_TRUE(allocation->resources.contains(NO_QUOTA_ROLE));
+  EXPECT_EQ(2u, allocation->resources.at(NO_QUOTA_ROLE).size());
+  EXPECT_EQ(
+      allocatedResources(
+          Resources::parse("cpus:2;mem:1024").get(), NO_QUOTA_ROLE),
+      Resources::sum(allocation->resources.at(NO_QUOTA_ROLE)));
+
+  // Trigger a batch allocation to make sure the remaining agents are
+  // still held back.
+  Clock::advance(flags_.allocation_interval);
+  Clock::settle();
+
+  allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+}
+
+
 // This test checks that if one role with quota has no frameworks in it,
 // other roles with quota are still offered resources. Roles without
 // frameworks have zero fair share and are always considered first during
@@ -4640,6 +4734,82 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(
 }
 
 
+// This test checks that the timers of the phases of an allocation run
+// and the number of agents and frameworks visited are reported in the
+// metrics endpoint.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(
+    HierarchicalAllocatorTest,
+    AllocationRunPhaseMetrics)
+{
+  Clock::pause();
+
+  initialize();
+
+  auto timers = {
+    "allocator/mesos/allocation_run/quota_headroom_ms",
+    "allocator/mesos/allocation_run/quota_stage_ms",
+    "allocator/mesos/allocation_run/fair_share_stage_ms",
+    "allocator/mesos/allocation_run/sort_ms",
+    "allocator/mesos/allocation_run/filter_ms",
+    "allocator/mesos/allocation_run/offer_callback_ms",
+  };
+
+  JSON::Object metrics = Metrics();
+
+  // No timings should appear before the first allocation run.
+  foreach (const string& timer, timers) {
+    EXPECT_EQ(0u, metrics.values.count(timer))
+      << "Expected " << timer << " to be absent";
+  }
+
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(
+      agent.id(),
+      agent,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent.resources(),
+      {});
+
+  Clock::settle();
+
+  // The allocation triggered by `addSlave()` visits the agent,
+  // but there are no frameworks yet.
+  JSON::Object expected;
+  expected.values = {
+    {"allocator/mesos/allocation_run/agents_visited", 1},
+    {"allocator/mesos/allocation_run/frameworks_visited", 0},
+  };
+
+  metrics = Metrics();
+
+  EXPECT_TRUE(metrics.contains(expected));
+
+  foreach (const string& timer, timers) {
+    EXPECT_EQ(1u, metrics.values.count(timer))
+      << "Expected " << timer << " to be present";
+  }
+
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  AWAIT_READY(allocations.get());
+
+  Clock::settle();
+
+  // The allocation triggered by `addFramework()` visits the agent
+  // again and considers the framework for it.
+  expected.values = {
+    {"allocator/mesos/allocation_run/agents_visited", 2},
+    {"allocator/mesos/allocation_run/frameworks_visited", 1},
+  };
+
+  metrics = Metrics();
+
+  EXPECT_TRUE(metrics.contains(expected));
+}
+
+
 // This test checks that the allocation run latency
 // metrics are reported in the metrics endpoint.
 // TODO(xujyan): This test is structurally similar to
@@ -4828,6 +4998,91 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(
 }
 
 
+// This test ensures that an offer filter that is made redundant by a
+// newer filter of the same framework on the same agent is removed,
+// while a filter for fewer resources does not filter larger offers.
+TEST_F(HierarchicalAllocatorTest, RedundantOfferFilters)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  initialize();
+
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(
+      agent.id(),
+      agent,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent.resources(),
+      {});
+
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{"role1", {{agent.id(), agent.resources()}}}});
+
+  Future<Allocation> allocation = allocations.get();
+  AWAIT_EXPECT_EQ(expected, allocation);
+
+  Filters offerFilter;
+  offerFilter.set_refuse_seconds((flags.allocation_interval * 100).secs());
+
+  Filters noFilter;
+  noFilter.set_refuse_seconds(0);
+
+  // The framework declines half of the offer with a filter, and the
+  // other half without one.
+  const Resources half =
+    allocatedResources(Resources::parse("cpus:1;mem:512").get(), "role1");
+
+  allocator->recoverResources(
+      framework.id(), agent.id(), half, offerFilter);
+
+  allocator->recoverResources(
+      framework.id(),
+      agent.id(),
+      allocation->resources.at("role1").at(agent.id()) - half,
+      noFilter);
+
+  // The filter does not apply to the whole agent.
+  Clock::advance(flags.allocation_interval);
+
+  allocation = allocations.get();
+  AWAIT_EXPECT_EQ(expected, allocation);
+
+  JSON::Object metrics = Metrics();
+
+  string activeOfferFilters =
+    "allocator/mesos/offer_filters/roles/role1/active";
+  EXPECT_EQ(1, metrics.values[activeOfferFilters]);
+
+  // Declining the whole agent with the same timeout makes the first
+  // filter redundant.
+  allocator->recoverResources(
+      framework.id(),
+      agent.id(),
+      allocation->resources.at("role1").at(agent.id()),
+      offerFilter);
+
+  Clock::settle();
+
+  metrics = Metrics();
+  EXPECT_EQ(1, metrics.values[activeOfferFilters]);
+
+  // There should be no allocation due to the new filter.
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+}
+
+
 // Verifies that per-role dominant share metrics are correctly reported.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(HierarchicalAllocatorTest, DominantShareMetrics)
 {
@@ -5289,100 +5544,459 @@ TEST_F(HierarchicalAllocatorTest, ReviveOffers)
 }
 
 
-// This test checks that if a multi-role framework declines resources
-// for one role with a long filter, it will be offered filtered resources
-// again to another role with some suppress and revive logic.
-TEST_F(HierarchicalAllocatorTest, SuppressAndReviveOffersWithMultiRole)
+// This test ensures that with an allocation sweep interval, periodic
+// allocations only consider the agents affected by events since the
+// previous allocation, and consider all agents once the sweep is due.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(
+    HierarchicalAllocatorTest,
+    AllocationSweepInterval)
 {
-  // Pausing the clock is not necessary, but ensures that the test
-  // doesn't rely on the batch allocation in the allocator, which
-  // would slow down the test.
   Clock::pause();
 
-  initialize();
+  master::Flags flags_;
+  flags_.allocation_sweep_interval = flags_.allocation_interval * 10;
 
-  // Register a framework with role1 and role2, suppress offer for
-  // role1, then role2 in this framework will be offered all of agent's
-  // resources since it is the only active role in the framework.
-  FrameworkInfo framework = createFrameworkInfo({"role1", "role2"});
+  initialize(flags_);
 
-  allocator->addFramework(framework.id(), framework, {}, true, {});
-  allocator->suppressOffers(framework.id(), {"role1"});
+  SlaveInfo agent1 = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(
+      agent1.id(),
+      agent1,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent1.resources(),
+      {});
 
-  // Total cluster resources will become cpus=2, mem=1024.
-  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  SlaveInfo agent2 = createSlaveInfo("cpus:1;mem:512;disk:0");
   allocator->addSlave(
-      agent.id(),
-      agent,
+      agent2.id(),
+      agent2,
       AGENT_CAPABILITIES(),
       None(),
-      agent.resources(),
+      agent2.resources(),
       {});
 
+  // Adding the framework triggers an allocation of all agents.
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
   Allocation expected = Allocation(
       framework.id(),
-      {{"role2", {{agent.id(), agent.resources()}}}});
+      {{"role1", {{agent1.id(), agent1.resources()},
+                  {agent2.id(), agent2.resources()}}}});
 
   AWAIT_EXPECT_EQ(expected, allocations.get());
 
-  Filters filter1day;
-  filter1day.set_refuse_seconds(Days(1).secs());
+  // The recovered resources are offered again in the next periodic
+  // allocation, which only considers `agent2`.
   allocator->recoverResources(
       framework.id(),
-      agent.id(),
-      allocatedResources(agent.resources(), "role2"),
-      filter1day);
-
-  // Advance the clock to trigger a batch allocation.
-  Clock::advance(flags.allocation_interval);
-  Clock::settle();
-
-  Future<Allocation> allocation = allocations.get();
-  EXPECT_TRUE(allocation.isPending());
+      agent2.id(),
+      allocatedResources(agent2.resources(), "role1"),
+      None());
 
-  // Revive offers for role1, after which the agent's resources
-  // should be offered to it.
-  allocator->reviveOffers(framework.id(), {"role1"});
+  Clock::advance(flags_.allocation_interval);
 
   expected = Allocation(
       framework.id(),
-      {{"role1", {{agent.id(), agent.resources()}}}});
+      {{"role1", {{agent2.id(), agent2.resources()}}}});
 
-  AWAIT_EXPECT_EQ(expected, allocation);
-}
+  AWAIT_EXPECT_EQ(expected, allocations.get());
 
+  Clock::settle();
 
-// This test ensures that resources from non-MULTI_ROLE should not be
-// allocated to MULTI_ROLE framework.
-TEST_F(HierarchicalAllocatorTest, DontOfferOldAgentToMultiRoleFramework)
-{
-  // Pausing the clock is not necessary, but ensures that the test
-  // doesn't rely on the batch allocation in the allocator, which
-  // would slow down the test.
-  Clock::pause();
+  const string metric = "allocator/mesos/allocation_runs";
 
-  initialize();
+  JSON::Object metrics = Metrics();
+  int runs = metrics.values[metric].as<JSON::Number>().as<int>();
 
-  FrameworkInfo framework = createFrameworkInfo(
-      {"foo"},
-      {FrameworkInfo::Capability::MULTI_ROLE});
+  // Nothing changed, hence the periodic allocations are skipped until
+  // the sweep is due.
+  for (int i = 0; i < 7; i++) {
+    Clock::advance(flags_.allocation_interval);
+    Clock::settle();
+  }
 
-  allocator->addFramework(framework.id(), framework, {}, true, {});
+  metrics = Metrics();
+  EXPECT_EQ(runs, metrics.values[metric].as<JSON::Number>().as<int>());
 
-  // Total cluster resources will become cpus=2, mem=1024.
-  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
-  allocator->addSlave(agent.id(), agent, {}, None(), agent.resources(), {});
+  Filters filter1000s;
+  filter1000s.set_refuse_seconds(1000.);
+  allocator->recoverResources(
+      framework.id(),
+      agent2.id(),
+      allocatedResources(agent2.resources(), "role1"),
+      filter1000s);
 
-  // Advance the clock to trigger a batch allocation.
-  Clock::advance(flags.allocation_interval);
+  // The declined agent is considered, but filtered.
+  Clock::advance(flags_.allocation_interval);
   Clock::settle();
 
   Future<Allocation> allocation = allocations.get();
   EXPECT_TRUE(allocation.isPending());
-}
 
+  metrics = Metrics();
+  EXPECT_EQ(runs + 1, metrics.values[metric].as<JSON::Number>().as<int>());
 
-// This tests the behavior of quota when the allocation and
+  // All agents are considered when the sweep is due.
+  Clock::advance(flags_.allocation_interval);
+  Clock::settle();
+
+  EXPECT_TRUE(allocation.isPending());
+
+  metrics = Metrics();
+  EXPECT_EQ(runs + 2, metrics.values[metric].as<JSON::Number>().as<int>());
+
+  // Reviving marks the role on all agents, and allocates immediately.
+  allocator->reviveOffers(framework.id(), {});
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+}
+
+
+// This test ensures that with an allocation sweep interval, roles
+// which a framework adds or unsuppresses through `updateFramework()`
+// are considered by the next periodic allocation rather than only
+// once the sweep is due.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(
+    HierarchicalAllocatorTest,
+    AllocationSweepIntervalUpdateFramework)
+{
+  Clock::pause();
+
+  master::Flags flags_;
+  flags_.allocation_sweep_interval = flags_.allocation_interval * 10;
+
+  initialize(flags_);
+
+  SlaveInfo agent = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(
+      agent.id(),
+      agent,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent.resources(),
+      {});
+
+  // The framework starts out suppressed, hence nothing is allocated.
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {"role1"});
+
+  Clock::advance(flags_.allocation_interval);
+  Clock::settle();
+
+  Future<Allocation> allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+
+  // Unsuppressing the role allocates the agent in the next periodic
+  // allocation, well before the sweep is due.
+  allocator->updateFramework(framework.id(), framework, {});
+
+  Clock::advance(flags_.allocation_interval);
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{"role1", {{agent.id(), agent.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+
+  // Decline the agent for `role1`, and let the periodic allocation
+  // consider (and filter) it.
+  Filters filter1000s;
+  filter1000s.set_refuse_seconds(1000.);
+  allocator->recoverResources(
+      framework.id(),
+      agent.id(),
+      allocatedResources(agent.resources(), "role1"),
+      filter1000s);
+
+  Clock::advance(flags_.allocation_interval);
+  Clock::settle();
+
+  allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+
+  // A role added by the framework is not filtered, and is allocated
+  // the agent in the next periodic allocation.
+  framework.add_roles("role2");
+  allocator->updateFramework(framework.id(), framework, {});
+
+  Clock::advance(flags_.allocation_interval);
+
+  expected = Allocation(
+      framework.id(),
+      {{"role2", {{agent.id(), agent.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+}
+
+
+// This test ensures that the calls to an allocator that records
+// its calls can be read back from the trace, in order.
+TEST_F(HierarchicalAllocatorTest, RecordTrace)
+{
+  const string trace = path::join(sandbox.get(), "trace");
+
+  delete allocator;
+
+  AllocatorOptions options;
+  options.tracePath = trace;
+
+  Try<Allocator*> create = HierarchicalDRFAllocator::create(options);
+  ASSERT_SOME(create);
+
+  allocator = create.get();
+
+  initialize();
+
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(
+      agent.id(),
+      agent,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent.resources(),
+      {});
+
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{"role1", {{agent.id(), agent.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  Filters filters;
+  filters.set_refuse_seconds(10);
+
+  allocator->recoverResources(
+      framework.id(),
+      agent.id(),
+      allocatedResources(agent.resources(), "role1"),
+      filters);
+
+  allocator->removeFramework(framework.id());
+
+  // The remaining calls are written when the allocator is destroyed.
+  delete allocator;
+  allocator = nullptr;
+
+  Try<string> read = os::read(trace);
+  ASSERT_SOME(read);
+
+  ::recordio::Decoder<Call> decoder(::protobuf::deserialize<Call>);
+
+  Try<std::deque<Try<Call>>> calls = decoder.decode(read.get());
+  ASSERT_SOME(calls);
+  ASSERT_EQ(5u, calls->size());
+
+  foreach (const Try<Call>& call, calls.get()) {
+    ASSERT_SOME(call);
+  }
+
+  const Call& initialize = calls->at(0).get();
+  EXPECT_EQ(Call::INITIALIZE, initialize.type());
+  EXPECT_EQ(
+      flags.allocation_interval,
+      Nanoseconds(initialize.initialize().allocation_interval().nanoseconds()));
+
+  const Call& addSlave = calls->at(1).get();
+  EXPECT_EQ(Call::ADD_SLAVE, addSlave.type());
+  EXPECT_EQ(agent, addSlave.add_slave().slave_info());
+  EXPECT_EQ(agent.resources(), Resources(addSlave.add_slave().total()));
+
+  const Call& addFramework = calls->at(2).get();
+  EXPECT_EQ(Call::ADD_FRAMEWORK, addFramework.type());
+  EXPECT_EQ(framework, addFramework.add_framework().framework_info());
+  EXPECT_TRUE(addFramework.add_framework().active());
+
+  const Call& recoverResources = calls->at(3).get();
+  EXPECT_EQ(Call::RECOVER_RESOURCES, recoverResources.type());
+  EXPECT_EQ(
+      allocatedResources(agent.resources(), "role1"),
+      Resources(recoverResources.recover_resources().resources().resources()));
+  EXPECT_EQ(
+      filters.refuse_seconds(),
+      recoverResources.recover_resources().filters().refuse_seconds());
+
+  const Call& removeFramework = calls->at(4).get();
+  EXPECT_EQ(Call::REMOVE_FRAMEWORK, removeFramework.type());
+  EXPECT_EQ(framework.id(), removeFramework.framework_id());
+
+  // The calls are recorded in order.
+  for (size_t i = 1; i < calls->size(); i++) {
+    EXPECT_LE(
+        calls->at(i - 1)->timestamp().nanoseconds(),
+        calls->at(i)->timestamp().nanoseconds());
+  }
+}
+
+
+// This test ensures that the allocator simulator replays a trace
+// recorded by the allocator, and makes the recorded allocations.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(
+    HierarchicalAllocatorTest,
+    SimulateRecordedTrace)
+{
+  const string trace = path::join(sandbox.get(), "trace");
+
+  delete allocator;
+
+  AllocatorOptions options;
+  options.tracePath = trace;
+
+  Try<Allocator*> create = HierarchicalDRFAllocator::create(options);
+  ASSERT_SOME(create);
+
+  allocator = create.get();
+
+  initialize();
+
+  SlaveInfo agent1 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(
+      agent1.id(),
+      agent1,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent1.resources(),
+      {});
+
+  SlaveInfo agent2 = createSlaveInfo("cpus:2;mem:1024");
+  allocator->addSlave(
+      agent2.id(),
+      agent2,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent2.resources(),
+      {});
+
+  FrameworkInfo framework = createFrameworkInfo({"role1"});
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{"role1", {{agent1.id(), agent1.resources()},
+                  {agent2.id(), agent2.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  // The remaining calls are written when the allocator is destroyed.
+  delete allocator;
+  allocator = nullptr;
+
+  Try<string> output = os::shell(
+      getTestHelperPath("mesos-allocator-simulator") + " --trace=" + trace);
+
+  ASSERT_SOME(output);
+
+  // The simulated allocator offers both agents to the framework, and
+  // keeps them allocated for the rest of the simulation.
+  EXPECT_TRUE(strings::contains(
+      output.get(), "Replayed 4 calls, made 2 offers"))
+    << output.get();
+
+  EXPECT_FALSE(strings::contains(output.get(), "Skipped")) << output.get();
+
+  EXPECT_TRUE(strings::contains(output.get(), "Utilization of cpus: "))
+    << output.get();
+}
+
+
+// This test checks that if a multi-role framework declines resources
+// for one role with a long filter, it will be offered filtered resources
+// again to another role with some suppress and revive logic.
+TEST_F(HierarchicalAllocatorTest, SuppressAndReviveOffersWithMultiRole)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  initialize();
+
+  // Register a framework with role1 and role2, suppress offer for
+  // role1, then role2 in this framework will be offered all of agent's
+  // resources since it is the only active role in the framework.
+  FrameworkInfo framework = createFrameworkInfo({"role1", "role2"});
+
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+  allocator->suppressOffers(framework.id(), {"role1"});
+
+  // Total cluster resources will become cpus=2, mem=1024.
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(
+      agent.id(),
+      agent,
+      AGENT_CAPABILITIES(),
+      None(),
+      agent.resources(),
+      {});
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{"role2", {{agent.id(), agent.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  Filters filter1day;
+  filter1day.set_refuse_seconds(Days(1).secs());
+  allocator->recoverResources(
+      framework.id(),
+      agent.id(),
+      allocatedResources(agent.resources(), "role2"),
+      filter1day);
+
+  // Advance the clock to trigger a batch allocation.
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  Future<Allocation> allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+
+  // Revive offers for role1, after which the agent's resources
+  // should be offered to it.
+  allocator->reviveOffers(framework.id(), {"role1"});
+
+  expected = Allocation(
+      framework.id(),
+      {{"role1", {{agent.id(), agent.resources()}}}});
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+}
+
+
+// This test ensures that resources from non-MULTI_ROLE should not be
+// allocated to MULTI_ROLE framework.
+TEST_F(HierarchicalAllocatorTest, DontOfferOldAgentToMultiRoleFramework)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  initialize();
+
+  FrameworkInfo framework = createFrameworkInfo(
+      {"foo"},
+      {FrameworkInfo::Capability::MULTI_ROLE});
+
+  allocator->addFramework(framework.id(), framework, {}, true, {});
+
+  // Total cluster resources will become cpus=2, mem=1024.
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent.id(), agent, {}, None(), agent.resources(), {});
+
+  // Advance the clock to trigger a batch allocation.
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  Future<Allocation> allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+}
+
+
+// This tests the behavior of quota when the allocation and
 // quota are disproportionate. We always try to allocate
 // up to the limit for all resources.
 // We test the following example:
@@ -6111,31 +6725,174 @@ TEST_P(HierarchicalAllocations_BENCHMARK_Test, PersistentVolumes)
     }
 
     Clock::settle();
-    offers.clear();
+    offers.clear();
+
+    Stopwatch watch;
+
+    watch.start();
+
+    // Advance the clock and trigger a batch allocation cycle.
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+
+    watch.stop();
+
+    cout << "round " << count
+         << " allocate() took " << watch.elapsed()
+         << " to make " << offers.size() << " offers"
+         << endl;
+  }
+
+  Clock::resume();
+}
+
+
+class HierarchicalAllocator_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<std::tuple<size_t, size_t>>
+{
+protected:
+  struct OfferedResources
+  {
+    FrameworkID   frameworkId;
+    SlaveID       slaveId;
+    Resources     resources;
+  };
+
+  // Adds the frameworks and the agents of the test parameters, where
+  // each agent has a portion of its resources used by a framework, and
+  // then runs allocation rounds in which `decline` is called for every
+  // offer. `declined` describes the declined offers in the output.
+  void declineOffers(
+      const lambda::function<void(const OfferedResources&)>& decline,
+      const string& declined)
+  {
+    size_t slaveCount = std::get<0>(GetParam());
+    size_t frameworkCount = std::get<1>(GetParam());
+
+    // Pause the clock because we want to manually drive the allocations.
+    Clock::pause();
+
+    vector<OfferedResources> offers;
+
+    auto offerCallback = [&offers](
+        const FrameworkID& frameworkId,
+        const hashmap<string, hashmap<SlaveID, Resources>>& resources_)
+    {
+      foreachkey (const string& role, resources_) {
+        foreachpair (const SlaveID& slaveId,
+                     const Resources& resources,
+                     resources_.at(role)) {
+          offers.push_back(OfferedResources{frameworkId, slaveId, resources});
+        }
+      }
+    };
+
+    cout << "Using " << slaveCount << " agents and "
+         << frameworkCount << " frameworks" << endl;
+
+    vector<SlaveInfo> slaves;
+    slaves.reserve(slaveCount);
+
+    vector<FrameworkInfo> frameworks;
+    frameworks.reserve(frameworkCount);
+
+    initialize(master::Flags(), offerCallback);
+
+    Stopwatch watch;
+    watch.start();
+
+    for (size_t i = 0; i < frameworkCount; i++) {
+      frameworks.push_back(createFrameworkInfo({"*"}));
+      allocator->addFramework(frameworks[i].id(), frameworks[i], {}, true, {});
+    }
+
+    // Wait for all the `addFramework` operations to be processed.
+    Clock::settle();
 
-    Stopwatch watch;
+    watch.stop();
+
+    cout << "Added " << frameworkCount << " frameworks in "
+         << watch.elapsed() << endl;
+
+    const Resources agentResources = Resources::parse(
+        "cpus:24;mem:4096;disk:4096;ports:[31000-32000]").get();
+
+    // Each agent has a portion of its resources allocated to a single
+    // framework. We round-robin through the frameworks when allocating.
+    Resources allocation =
+      Resources::parse("cpus:16;mem:2014;disk:1024").get();
+
+    Try<::mesos::Value::Ranges> ranges =
+      fragment(createRange(31000, 32000), 16);
+    ASSERT_SOME(ranges);
+    ASSERT_EQ(16, ranges->range_size());
+
+    allocation += createPorts(ranges.get());
+
+    allocation.allocate("*");
 
     watch.start();
 
-    // Advance the clock and trigger a batch allocation cycle.
-    Clock::advance(flags.allocation_interval);
+    for (size_t i = 0; i < slaveCount; i++) {
+      slaves.push_back(createSlaveInfo(agentResources));
+
+      // Add some used resources on each slave. Let's say there are 16 tasks;
+      // each is allocated 1 cpu and a random port from the port range.
+      hashmap<FrameworkID, Resources> used = {
+        {frameworks[i % frameworkCount].id(), allocation}
+      };
+
+      allocator->addSlave(
+          slaves[i].id(),
+          slaves[i],
+          AGENT_CAPABILITIES(),
+          None(),
+          slaves[i].resources(),
+          used);
+    }
+
+    // Wait for all the `addSlave` operations to be processed.
     Clock::settle();
 
     watch.stop();
 
-    cout << "round " << count
-         << " allocate() took " << watch.elapsed()
-         << " to make " << offers.size() << " offers"
-         << endl;
-  }
+    cout << "Added " << slaveCount << " agents in "
+         << watch.elapsed() << endl;
 
-  Clock::resume();
-}
+    size_t declinedOfferCount = 0;
 
+    // Loop enough times for all the frameworks to get offered all the
+    // resources.
+    for (size_t i = 0; i < frameworkCount * 2; i++) {
+      foreach (const OfferedResources& offer, offers) {
+        decline(offer);
+      }
 
-class HierarchicalAllocator_BENCHMARK_Test
-  : public HierarchicalAllocatorTestBase,
-    public WithParamInterface<std::tuple<size_t, size_t>> {};
+      declinedOfferCount += offers.size();
+
+      // Wait for the declined offers.
+      Clock::settle();
+      offers.clear();
+
+      watch.start();
+
+      // Advance the clock and trigger a background allocation cycle.
+      Clock::advance(flags.allocation_interval);
+      Clock::settle();
+
+      watch.stop();
+
+      cout << "round " << i
+           << " allocate() took " << watch.elapsed()
+           << " to make " << offers.size() << " offers"
+           << " after " << declined << " " << declinedOfferCount
+           << " offers" << endl;
+    }
+
+    Clock::resume();
+  }
+};
 
 
 // The Hierarchical Allocator benchmark tests are parameterized
@@ -6269,138 +7026,47 @@ TEST_P(HierarchicalAllocator_BENCHMARK_Test, AddAndUpdateSlave)
 // subsequent offers.
 TEST_P(HierarchicalAllocator_BENCHMARK_Test, DeclineOffers)
 {
-  size_t slaveCount = std::get<0>(GetParam());
-  size_t frameworkCount = std::get<1>(GetParam());
-
-  // Pause the clock because we want to manually drive the allocations.
-  Clock::pause();
-
-  struct OfferedResources
-  {
-    FrameworkID   frameworkId;
-    SlaveID       slaveId;
-    Resources     resources;
-  };
-
-  vector<OfferedResources> offers;
-
-  auto offerCallback = [&offers](
-      const FrameworkID& frameworkId,
-      const hashmap<string, hashmap<SlaveID, Resources>>& resources_)
-  {
-    foreachkey (const string& role, resources_) {
-      foreachpair (const SlaveID& slaveId,
-                   const Resources& resources,
-                   resources_.at(role)) {
-        offers.push_back(OfferedResources{frameworkId, slaveId, resources});
-      }
-    }
-  };
-
-  cout << "Using " << slaveCount << " agents and "
-       << frameworkCount << " frameworks" << endl;
-
-  vector<SlaveInfo> slaves;
-  slaves.reserve(slaveCount);
-
-  vector<FrameworkInfo> frameworks;
-  frameworks.reserve(frameworkCount);
-
-  initialize(master::Flags(), offerCallback);
-
-  Stopwatch watch;
-  watch.start();
-
-  for (size_t i = 0; i < frameworkCount; i++) {
-    frameworks.push_back(createFrameworkInfo({"*"}));
-    allocator->addFramework(frameworks[i].id(), frameworks[i], {}, true, {});
-  }
-
-  // Wait for all the `addFramework` operations to be processed.
-  Clock::settle();
-
-  watch.stop();
-
-  cout << "Added " << frameworkCount << " frameworks in "
-       << watch.elapsed() << endl;
-
-  const Resources agentResources = Resources::parse(
-      "cpus:24;mem:4096;disk:4096;ports:[31000-32000]").get();
-
-  // Each agent has a portion of its resources allocated to a single
-  // framework. We round-robin through the frameworks when allocating.
-  Resources allocation = Resources::parse("cpus:16;mem:2014;disk:1024").get();
-
-  Try<::mesos::Value::Ranges> ranges = fragment(createRange(31000, 32000), 16);
-  ASSERT_SOME(ranges);
-  ASSERT_EQ(16, ranges->range_size());
-
-  allocation += createPorts(ranges.get());
-
-  allocation.allocate("*");
-
-  watch.start();
-
-  for (size_t i = 0; i < slaveCount; i++) {
-    slaves.push_back(createSlaveInfo(agentResources));
-
-    // Add some used resources on each slave. Let's say there are 16 tasks;
-    // each is allocated 1 cpu and a random port from the port range.
-    hashmap<FrameworkID, Resources> used = {
-      {frameworks[i % frameworkCount].id(), allocation}
-    };
-
-    allocator->addSlave(
-        slaves[i].id(),
-        slaves[i],
-        AGENT_CAPABILITIES(),
-        None(),
-        slaves[i].resources(),
-        used);
-  }
-
-  // Wait for all the `addSlave` operations to be processed.
-  Clock::settle();
-
-  watch.stop();
-
-  cout << "Added " << slaveCount << " agents in "
-       << watch.elapsed() << endl;
-
-  size_t declinedOfferCount = 0;
-
-  // Loop enough times for all the frameworks to get offered all the resources.
-  for (size_t i = 0; i < frameworkCount * 2; i++) {
-    // Permanently decline any offered resources.
-    foreach (const OfferedResources& offer, offers) {
-      Filters filters;
-
-      filters.set_refuse_seconds(INT_MAX);
-      allocator->recoverResources(
-          offer.frameworkId, offer.slaveId, offer.resources, filters);
-    }
-
-    declinedOfferCount += offers.size();
-
-    // Wait for the declined offers.
-    Clock::settle();
-    offers.clear();
-
-    watch.start();
-
-    // Advance the clock and trigger a background allocation cycle.
-    Clock::advance(flags.allocation_interval);
-    Clock::settle();
+  Filters filters;
+  filters.set_refuse_seconds(INT_MAX);
+
+  // Permanently decline any offered resources.
+  declineOffers(
+      [&](const OfferedResources& offer) {
+        allocator->recoverResources(
+            offer.frameworkId, offer.slaveId, offer.resources, filters);
+      },
+      "filtering");
+}
 
-    watch.stop();
 
-    cout << "round " << i
-         << " allocate() took " << watch.elapsed()
-         << " to make " << offers.size() << " offers"
-         << " after filtering " << declinedOfferCount << " offers" << endl;
-  }
+// This benchmark is like `DeclineOffers`, except that each framework
+// declines a small part of every offer with a long filter and the rest
+// without a filter. The filters never apply to the whole offer, so the
+// frameworks keep getting offers, and keep adding filters for the same
+// resources.
+TEST_P(HierarchicalAllocator_BENCHMARK_Test, DeclineOffersPartially)
+{
+  Resources declined = Resources::parse("cpus:1;mem:64").get();
+  declined.allocate("*");
 
-  Clock::resume();
+  Filters longFilter;
+  longFilter.set_refuse_seconds(INT_MAX);
+
+  Filters noFilter;
+  noFilter.set_refuse_seconds(0);
+
+  declineOffers(
+      [&](const OfferedResources& offer) {
+        allocator->recoverResources(
+            offer.frameworkId, offer.slaveId, declined, longFilter);
+
+        allocator->recoverResources(
+            offer.frameworkId,
+            offer.slaveId,
+            offer.resources - declined,
+            noFilter);
+      },
+      "partially declining");
 }
 
 
@@ -7165,6 +7831,127 @@ TEST_P(HierarchicalAllocator_BENCHMARK_Test, AllocatorBacklog)
        << " allocation runs" << endl;
 }
 
+
+class HierarchicalAllocatorThreads_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<std::tuple<size_t, size_t>> {};
+
+
+// The parameters are the number of agents and the number of
+// allocation threads (see `--allocation_threads`).
+INSTANTIATE_TEST_CASE_P(
+    AgentAndThreadCount,
+    HierarchicalAllocatorThreads_BENCHMARK_Test,
+    ::testing::Combine(
+      ::testing::Values(1000U, 5000U, 10000U, 30000U),
+      ::testing::Values(1U, 2U, 4U, 8U))
+    );
+
+
+// This benchmark measures the time taken by batch allocations of all
+// agents to frameworks spread across a number of roles, depending on
+// the number of threads used by the allocator.
+TEST_P(HierarchicalAllocatorThreads_BENCHMARK_Test, FairShare)
+{
+  size_t agentCount = std::get<0>(GetParam());
+  size_t threadCount = std::get<1>(GetParam());
+
+  const size_t frameworkCount = 200;
+  const size_t roleCount = 20;
+
+  // Pause the clock because we want to manually drive the allocations.
+  Clock::pause();
+
+  struct OfferedResources
+  {
+    FrameworkID   frameworkId;
+    SlaveID       slaveId;
+    Resources     resources;
+  };
+
+  vector<OfferedResources> offers;
+
+  auto offerCallback = [&offers](
+      const FrameworkID& frameworkId,
+      const hashmap<string, hashmap<SlaveID, Resources>>& resources_)
+  {
+    foreachkey (const string& role, resources_) {
+      foreachpair (const SlaveID& slaveId,
+                   const Resources& resources,
+                   resources_.at(role)) {
+        offers.push_back(OfferedResources{frameworkId, slaveId, resources});
+      }
+    }
+  };
+
+  cout << "Using " << agentCount << " agents, " << frameworkCount
+       << " frameworks in " << roleCount << " roles and "
+       << threadCount << " allocation threads" << endl;
+
+  master::Flags flags;
+  flags.allocation_threads = threadCount;
+
+  initialize(flags, offerCallback);
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    FrameworkInfo framework =
+      createFrameworkInfo({"role" + stringify(i % roleCount)});
+
+    allocator->addFramework(framework.id(), framework, {}, true, {});
+  }
+
+  const Resources agentResources = Resources::parse(
+      "cpus:24;mem:4096;disk:4096;ports:[31000-32000]").get();
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveInfo agent = createSlaveInfo(agentResources);
+
+    allocator->addSlave(
+        agent.id(),
+        agent,
+        AGENT_CAPABILITIES(),
+        None(),
+        agent.resources(),
+        {});
+  }
+
+  // Wait for all the `addFramework` and `addSlave` operations
+  // (and the allocations they trigger) to be processed.
+  Clock::settle();
+
+  const size_t allocationsCount = 5;
+
+  for (size_t i = 0; i < allocationsCount; i++) {
+    // Recover resources with no filters so that every
+    // allocation run considers all of the agents.
+    foreach (const OfferedResources& offer, offers) {
+      allocator->recoverResources(
+          offer.frameworkId,
+          offer.slaveId,
+          offer.resources,
+          None());
+    }
+
+    // Wait for all declined offers to be processed.
+    Clock::settle();
+    offers.clear();
+
+    Stopwatch watch;
+    watch.start();
+
+    // Advance the clock and trigger a batch allocation.
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+
+    watch.stop();
+
+    cout << "allocate() took " << watch.elapsed()
+         << " to make " << offers.size() << " offers" << endl;
+  }
+
+  Clock::resume();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -0,0 +1,95 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mesos/interned.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
+#include <stout/stringify.hpp>
+
+using std::string;
+using std::thread;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+TEST(InternedStringTest, Equality)
+{
+  InternedString cpus1("cpus");
+  InternedString cpus2(string("cp") + "us");
+  InternedString mem("mem");
+
+  EXPECT_EQ(cpus1, cpus2);
+  EXPECT_EQ(cpus1.hash(), cpus2.hash());
+  EXPECT_NE(cpus1, mem);
+
+  EXPECT_EQ("cpus", cpus1.value());
+  EXPECT_EQ("mem", stringify(mem));
+
+  EXPECT_EQ(InternedString(""), InternedString());
+  EXPECT_TRUE(InternedString().empty());
+  EXPECT_FALSE(cpus1.empty());
+
+  hashset<InternedString> names = {cpus1, cpus2, mem};
+
+  EXPECT_EQ(2u, names.size());
+  EXPECT_TRUE(names.contains(InternedString("mem")));
+  EXPECT_FALSE(names.contains(InternedString("disk")));
+}
+
+
+// Interning the same values concurrently must result in the same
+// handles in all threads.
+TEST(InternedStringTest, Threads)
+{
+  const size_t numThreads = 4;
+  const size_t numValues = 1000;
+
+  vector<vector<InternedString>> results(numThreads);
+  vector<thread> threads;
+
+  for (size_t i = 0; i < numThreads; i++) {
+    threads.emplace_back([&results, i]() {
+      for (size_t j = 0; j < numValues; j++) {
+        results[i].push_back(InternedString("role" + stringify(j)));
+      }
+    });
+  }
+
+  foreach (thread& thread_, threads) {
+    thread_.join();
+  }
+
+  for (size_t j = 0; j < numValues; j++) {
+    EXPECT_EQ("role" + stringify(j), results[0][j].value());
+
+    for (size_t i = 1; i < numThreads; i++) {
+      EXPECT_EQ(results[0][j], results[i][j]);
+    }
+  }
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
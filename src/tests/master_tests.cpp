@@ -5006,6 +5006,440 @@ TEST_F(MasterTest, StateSummaryEndpoint)
 }
 
 
+// This test ensures that concurrent requests to the master's /state
+// and /state-summary endpoints, which are rendered in a batch, are
+// each answered with the right response.
+TEST_F(MasterTest, BatchedStateRequests)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  vector<Future<Response>> states;
+  vector<Future<Response>> summaries;
+
+  for (int i = 0; i < 5; i++) {
+    states.push_back(process::http::get(
+        master.get()->pid,
+        "state",
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL)));
+
+    summaries.push_back(process::http::get(
+        master.get()->pid,
+        "state-summary",
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL)));
+  }
+
+  // A request with a different query must not share the rendering.
+  Future<Response> jsonp = process::http::get(
+      master.get()->pid,
+      "state",
+      "jsonp=callback",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  foreach (const Future<Response>& response, states) {
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+    ASSERT_SOME(parse);
+
+    EXPECT_SOME_EQ(
+        slaveRegisteredMessage->slave_id().value(),
+        parse->find<JSON::String>("slaves[0].id"));
+
+    EXPECT_SOME(parse->find<JSON::String>("version"));
+  }
+
+  foreach (const Future<Response>& response, summaries) {
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+    ASSERT_SOME(parse);
+
+    EXPECT_SOME_EQ(
+        slaveRegisteredMessage->slave_id().value(),
+        parse->find<JSON::String>("slaves[0].id"));
+
+    EXPECT_NONE(parse->find<JSON::String>("version"));
+  }
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, jsonp);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      "text/javascript", "Content-Type", jsonp);
+  EXPECT_TRUE(strings::startsWith(jsonp->body, "callback("));
+}
+
+
+// This test verifies that the /state and /tasks endpoints do not
+// serve a stale rendering of a task after the task has been updated.
+TEST_F(MasterTest, StateEndpointRenderedTaskUpdates)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  TaskInfo task = createTask(offers.get()[0], "sleep 100", DEFAULT_EXECUTOR_ID);
+
+  ExecutorDriver* execDriver;
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .WillOnce(SaveArg<0>(&execDriver));
+
+  Future<TaskInfo> execTask;
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(FutureArg<1>(&execTask));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(execTask);
+
+  auto taskState = [&master](const string& endpoint, const string& path) {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        endpoint,
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+    CHECK_SOME(parse);
+
+    Result<JSON::String> state = parse->find<JSON::String>(path);
+    CHECK_SOME(state);
+
+    return state->value;
+  };
+
+  // Both endpoints render (and cache) the task while it is staging.
+  EXPECT_EQ("TASK_STAGING", taskState("state", "frameworks[0].tasks[0].state"));
+  EXPECT_EQ("TASK_STAGING", taskState("tasks", "tasks[0].state"));
+
+  TaskStatus runningStatus;
+  runningStatus.mutable_task_id()->MergeFrom(execTask->task_id());
+  runningStatus.set_state(TASK_RUNNING);
+
+  execDriver->sendStatusUpdate(runningStatus);
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  EXPECT_EQ("TASK_RUNNING", taskState("state", "frameworks[0].tasks[0].state"));
+  EXPECT_EQ("TASK_RUNNING", taskState("tasks", "tasks[0].state"));
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This ensures that the master's /state endpoint only returns the
+// objects that changed after the `state_version` passed as `since`,
+// and falls back to the full state for versions it does not know or
+// that were handed out by another master.
+TEST_F(MasterTest, StateEndpointSince)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  auto state = [&master](const string& query) {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "state",
+        query,
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+    CHECK_SOME(parse);
+
+    return parse.get();
+  };
+
+  JSON::Object before = state("");
+
+  Result<JSON::Number> version = before.find<JSON::Number>("state_version");
+  ASSERT_SOME(version);
+  EXPECT_NONE(before.find<JSON::Number>("since"));
+
+  Result<JSON::String> masterId = before.find<JSON::String>("id");
+  ASSERT_SOME(masterId);
+
+  Future<TaskInfo> execTask;
+  EXPECT_CALL(exec, registered(_, _, _, _));
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(FutureArg<1>(&execTask));
+
+  TaskInfo task = createTask(offers.get()[0], "sleep 100", DEFAULT_EXECUTOR_ID);
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(execTask);
+
+  const string since =
+    "since=" + stringify(version->as<uint64_t>()) +
+    "&master_id=" + masterId->value;
+
+  JSON::Object changes = state(since);
+
+  Result<JSON::Number> changesSince = changes.find<JSON::Number>("since");
+  ASSERT_SOME(changesSince);
+  EXPECT_EQ(version->as<uint64_t>(), changesSince->as<uint64_t>());
+
+  Result<JSON::Number> changesVersion =
+    changes.find<JSON::Number>("state_version");
+  ASSERT_SOME(changesVersion);
+  EXPECT_GT(changesVersion->as<uint64_t>(), version->as<uint64_t>());
+
+  // Only the launched task changed, the agent did not.
+  Result<JSON::Array> slaves = changes.find<JSON::Array>("slaves");
+  ASSERT_SOME(slaves);
+  EXPECT_TRUE(slaves->values.empty());
+
+  Result<JSON::String> taskId = changes.find<JSON::String>("tasks[0].id");
+  ASSERT_SOME(taskId);
+  EXPECT_EQ(task.task_id().value(), taskId->value);
+
+  // Nothing changed since the latest version.
+  JSON::Object unchanged = state(
+      "since=" + stringify(changesVersion->as<uint64_t>()) +
+      "&master_id=" + masterId->value);
+
+  Result<JSON::Array> tasks = unchanged.find<JSON::Array>("tasks");
+  ASSERT_SOME(tasks);
+  EXPECT_TRUE(tasks->values.empty());
+
+  // A version the master does not know returns the full state.
+  JSON::Object full = state(
+      "since=" + stringify(changesVersion->as<uint64_t>() + 1) +
+      "&master_id=" + masterId->value);
+
+  EXPECT_NONE(full.find<JSON::Number>("since"));
+  EXPECT_SOME(full.find<JSON::Array>("frameworks[0].tasks"));
+
+  // So does a version of another master, or one without a master ID.
+  JSON::Object otherMaster = state(
+      "since=" + stringify(version->as<uint64_t>()) +
+      "&master_id=" + id::UUID::random().toString());
+
+  EXPECT_NONE(otherMaster.find<JSON::Number>("since"));
+  EXPECT_SOME(otherMaster.find<JSON::Array>("frameworks[0].tasks"));
+
+  JSON::Object noMaster =
+    state("since=" + stringify(version->as<uint64_t>()));
+
+  EXPECT_NONE(noMaster.find<JSON::Number>("since"));
+  EXPECT_SOME(noMaster.find<JSON::Array>("frameworks[0].tasks"));
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      "since=abc",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+// This ensures that agents which disconnect and are then marked
+// unreachable are versioned, so that both the /state endpoint and the
+// v1 GET_STATE call return them as changed and then removed agents.
+TEST_F(MasterTest, StateEndpointSinceAgentRemoval)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get()->pid, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  const SlaveID slaveId = slaveRegisteredMessage->slave_id();
+
+  auto state = [&master](const Option<uint64_t>& since) {
+    Option<string> query;
+    if (since.isSome()) {
+      query = "since=" + stringify(since.get()) +
+              "&master_id=" + master.get()->getMasterInfo().id();
+    }
+
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "state",
+        query,
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+    CHECK_SOME(parse);
+
+    return parse.get();
+  };
+
+  auto version = [](const JSON::Object& object) {
+    Result<JSON::Number> number = object.find<JSON::Number>("state_version");
+    CHECK_SOME(number);
+
+    return number->as<uint64_t>();
+  };
+
+  const uint64_t registered = version(state(None()));
+
+  Clock::pause();
+
+  Future<Nothing> deactivateSlave =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::deactivateSlave);
+
+  // Stopping the agent disconnects and deactivates it in the master.
+  slave.get()->terminate();
+  slave->reset();
+
+  AWAIT_READY(deactivateSlave);
+
+  JSON::Object disconnected = state(registered);
+
+  Result<JSON::Number> since = disconnected.find<JSON::Number>("since");
+  ASSERT_SOME(since);
+  EXPECT_EQ(registered, since->as<uint64_t>());
+
+  EXPECT_SOME_EQ(
+      JSON::String(slaveId.value()),
+      disconnected.find<JSON::String>("slaves[0].id"));
+  EXPECT_SOME_EQ(
+      JSON::Boolean(false),
+      disconnected.find<JSON::Boolean>("slaves[0].active"));
+
+  const uint64_t inactive = version(disconnected);
+  EXPECT_GT(inactive, registered);
+
+  Future<Nothing> removeSlave =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::removeSlave);
+
+  // The agent does not reregister in time and is marked unreachable.
+  Clock::advance(masterFlags.agent_reregister_timeout);
+
+  AWAIT_READY(removeSlave);
+  Clock::settle();
+  Clock::resume();
+
+  JSON::Object unreachable = state(inactive);
+
+  Result<JSON::Array> slaves = unreachable.find<JSON::Array>("slaves");
+  ASSERT_SOME(slaves);
+  EXPECT_TRUE(slaves->values.empty());
+
+  EXPECT_SOME_EQ(
+      JSON::String(slaveId.value()),
+      unreachable.find<JSON::String>("removed_slaves[0]"));
+
+  // The v1 API returns the same changes.
+  v1::master::Call call;
+  call.set_type(v1::master::Call::GET_STATE);
+  call.mutable_get_state()->set_since(registered);
+  call.mutable_get_state()->set_master_id(
+      master.get()->getMasterInfo().id());
+
+  ContentType contentType = ContentType::PROTOBUF;
+
+  process::http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+  headers["Accept"] = stringify(contentType);
+
+  Future<Response> response = process::http::post(
+      master.get()->pid,
+      "api/v1",
+      headers,
+      serialize(contentType, call),
+      stringify(contentType));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<v1::master::Response> v1Response =
+    deserialize<v1::master::Response>(contentType, response->body);
+  ASSERT_SOME(v1Response);
+  ASSERT_EQ(v1::master::Response::GET_STATE, v1Response->type());
+
+  const v1::master::Response::GetState& getState = v1Response->get_state();
+
+  EXPECT_EQ(registered, getState.since());
+  EXPECT_EQ(version(unreachable), getState.version());
+  EXPECT_EQ(master.get()->getMasterInfo().id(), getState.master_id());
+  EXPECT_EQ(0, getState.get_agents().agents_size());
+  ASSERT_EQ(1, getState.removed_agents_size());
+  EXPECT_EQ(evolve(slaveId), getState.removed_agents(0));
+}
+
 // This ensures that agent capabilities are included in
 // the response of master's /state endpoint.
 TEST_F(MasterTest, StateEndpointAgentCapabilities)
@@ -0,0 +1,191 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mesos/resources.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+
+#include "common/resource_quantities.hpp"
+
+#include "tests/mesos.hpp"
+#include "tests/resources_utils.hpp"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+static ResourceQuantities quantities(const string& text)
+{
+  return ResourceQuantities::fromString(text).get();
+}
+
+
+TEST(ResourceQuantitiesTest, FromScalarResources)
+{
+  // Reservations, allocation info and disk infos are dropped,
+  // and non-scalar resources are ignored.
+  Resources resources = Resources::parse(
+      "cpus:1;cpus(role1):2;mem:512;ports:[31000-32000]").get();
+
+  resources += createPersistentVolume(
+      Megabytes(64), "role1", "id1", "path1", None(), None(), "principal1");
+
+  resources.allocate("role1");
+
+  ResourceQuantities result =
+    ResourceQuantities::fromScalarResources(resources);
+
+  EXPECT_EQ(3u, result.size());
+  EXPECT_EQ(quantities("cpus:3;mem:512;disk:64"), result);
+
+  // Zero quantities are not kept.
+  EXPECT_TRUE(ResourceQuantities::fromScalarResources(
+      Resources::parse("cpus:0;mem:0").get()).empty());
+
+  EXPECT_ERROR(ResourceQuantities::fromString("ports:[31000-32000]"));
+}
+
+
+TEST(ResourceQuantitiesTest, Get)
+{
+  ResourceQuantities result = quantities("cpus:1.5;mem:512");
+
+  EXPECT_EQ(1.5, result.get("cpus").value());
+  EXPECT_EQ(512, result.get("mem").value());
+  EXPECT_EQ(0, result.get("disk").value());
+}
+
+
+TEST(ResourceQuantitiesTest, Arithmetic)
+{
+  ResourceQuantities left = quantities("cpus:1;mem:512");
+  ResourceQuantities right = quantities("cpus:0.5;disk:1024");
+
+  EXPECT_EQ(quantities("cpus:1.5;mem:512;disk:1024"), left + right);
+  EXPECT_EQ(quantities("cpus:0.5;mem:512"), left - right);
+
+  // Subtraction does not go below zero.
+  EXPECT_EQ(quantities("disk:1024"), right - left);
+  EXPECT_TRUE((left - left).empty());
+
+  ResourceQuantities sum;
+  sum += left;
+  sum += right;
+  sum -= right;
+
+  EXPECT_EQ(left, sum);
+
+  // Like `Value::Scalar`, the arithmetic uses a fixed point
+  // representation, so the result is exact to three decimals.
+  ResourceQuantities tenth = quantities("cpus:0.1");
+
+  ResourceQuantities total;
+  for (int i = 0; i < 10; i++) {
+    total += tenth;
+  }
+
+  EXPECT_EQ(quantities("cpus:1"), total);
+}
+
+
+TEST(ResourceQuantitiesTest, Contains)
+{
+  ResourceQuantities quantities1 = quantities("cpus:2;mem:512");
+
+  EXPECT_TRUE(quantities1.contains(ResourceQuantities()));
+  EXPECT_TRUE(quantities1.contains(quantities("cpus:2")));
+  EXPECT_TRUE(quantities1.contains(quantities("cpus:1;mem:512")));
+
+  EXPECT_FALSE(quantities1.contains(quantities("cpus:2.001")));
+  EXPECT_FALSE(quantities1.contains(quantities("cpus:1;disk:1")));
+  EXPECT_FALSE(ResourceQuantities().contains(quantities1));
+}
+
+
+TEST(ResourceQuantitiesTest, Printing)
+{
+  EXPECT_EQ("cpus:1.5; mem:512", stringify(quantities("mem:512;cpus:1.5")));
+  EXPECT_EQ("", stringify(ResourceQuantities()));
+}
+
+
+// Performs the same operations as `Resources_Scalar_Arithmetic_BENCHMARK_Test`
+// but on the quantities of typical scalar resources.
+TEST(ResourceQuantities_BENCHMARK_Test, Arithmetic)
+{
+  const ResourceQuantities quantities_ =
+    quantities("cpus:1;gpus:1;mem:128;disk:256");
+
+  const size_t totalOperations = 50000;
+
+  ResourceQuantities total;
+  Stopwatch watch;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total += quantities_;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total += r' operations"
+       << " on " << quantities_ << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total -= quantities_;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total -= r' operations"
+       << " on " << quantities_ << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total = total + quantities_;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total = total + r' operations"
+       << " on " << quantities_ << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total = total - quantities_;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total = total - r' operations"
+       << " on " << quantities_ << endl;
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
@@ -1770,6 +1770,83 @@ TEST(ResourcesTest, ToUnreserved)
 }
 
 
+// Resources are only combined if their names and roles match, this
+// ensures that the roles are still tracked correctly after they were
+// changed by reserving, unreserving, allocating or unallocating.
+TEST(ResourcesTest, CombineAfterChangingRoles)
+{
+  Resources unreserved = Resources::parse("cpus:1").get();
+  Resources reserved = createReservedResource(
+      "cpus", "2", createDynamicReservationInfo("role1", "principal"));
+
+  Resources pushed = unreserved.pushReservation(
+      createDynamicReservationInfo("role1", "principal"));
+
+  EXPECT_EQ(1u, (pushed + reserved).size());
+  EXPECT_SOME_EQ(3.0, (pushed + reserved).cpus());
+  EXPECT_TRUE((reserved - pushed).contains(pushed));
+
+  EXPECT_EQ(1u, (reserved.popReservation() + unreserved).size());
+  EXPECT_EQ(1u, (reserved.toUnreserved() + unreserved).size());
+  EXPECT_TRUE((reserved.toUnreserved() - unreserved).contains(unreserved));
+
+  Resources allocated1 = unreserved;
+  allocated1.allocate("role1");
+
+  Resources allocated2 = unreserved;
+  allocated2.allocate("role2");
+
+  EXPECT_EQ(2u, (allocated1 + allocated2).size());
+
+  allocated2.allocate("role1");
+
+  EXPECT_EQ(1u, (allocated1 + allocated2).size());
+
+  allocated1.unallocate();
+
+  EXPECT_EQ(allocated1, unreserved);
+  EXPECT_EQ(1u, (allocated1 + unreserved).size());
+  EXPECT_TRUE((allocated1 - unreserved).empty());
+}
+
+
+// Copies of resources share the underlying protobufs until they are
+// modified, this ensures that modifying a copy doesn't affect the
+// resources it was copied from and vice versa.
+TEST(ResourcesTest, CopyOnWrite)
+{
+  const Resources original = Resources::parse("cpus:1;mem:512").get();
+
+  Resources copy = original;
+  copy += Resources::parse("cpus:1").get();
+  copy -= Resources::parse("mem:256").get();
+
+  EXPECT_EQ(Resources::parse("cpus:1;mem:512").get(), original);
+  EXPECT_EQ(Resources::parse("cpus:2;mem:256").get(), copy);
+
+  Resources allocated = original;
+  allocated.allocate("role1");
+
+  foreach (const Resource& resource, original) {
+    EXPECT_FALSE(resource.has_allocation_info());
+  }
+
+  Resources reserved = original.pushReservation(
+      createDynamicReservationInfo("role1", "principal"));
+
+  EXPECT_EQ(original, original.filter(&Resources::isUnreserved));
+  EXPECT_EQ(original, reserved.toUnreserved());
+
+  // Modifying the original doesn't affect existing copies either.
+  Resources modified = original;
+  copy = modified;
+  modified += Resources::parse("cpus:1").get();
+
+  EXPECT_EQ(original, copy);
+  EXPECT_SOME_EQ(2.0, modified.cpus());
+}
+
+
 TEST(ResourcesTest, Find)
 {
   Resources resources1 = Resources::parse(
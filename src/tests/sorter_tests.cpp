@@ -22,6 +22,8 @@
 
 #include <mesos/resources.hpp>
 
+#include <process/owned.hpp>
+
 #include <stout/gtest.hpp>
 
 #include "master/allocator/sorter/drf/sorter.hpp"
@@ -30,6 +32,9 @@
 #include "tests/resources_utils.hpp"
 
 using mesos::internal::master::allocator::DRFSorter;
+using mesos::internal::master::allocator::Sorter;
+
+using process::Owned;
 
 using std::cout;
 using std::endl;
@@ -653,6 +658,115 @@ TEST(SorterTest, HierarchicalIterationOrder)
 }
 
 
+// This test checks that changes to the allocation of clients that
+// are made after the tree has been sorted (and which hence move the
+// affected nodes within the sorted tree rather than re-sorting the
+// whole tree) result in the correct order.
+TEST(SorterTest, IncrementalSort)
+{
+  DRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("agentId");
+
+  Resources totalResources = Resources::parse("cpus:100;mem:100").get();
+  sorter.add(slaveId, totalResources);
+
+  sorter.add("a/x");
+  sorter.add("a/y");
+  sorter.add("b");
+  sorter.add("c/z");
+
+  sorter.activate("a/x");
+  sorter.activate("a/y");
+  sorter.activate("b");
+  sorter.activate("c/z");
+
+  // Shares: a/x = 0, a/y = 0, b = 0, c/z = 0.
+  EXPECT_EQ(vector<string>({"a/x", "a/y", "b", "c/z"}), sorter.sort());
+
+  sorter.allocated("a/x", slaveId, Resources::parse("cpus:10;mem:10").get());
+
+  // Shares: b = 0, c = 0, a = 0.1 (a/y = 0, a/x = 0.1).
+  EXPECT_EQ(vector<string>({"b", "c/z", "a/y", "a/x"}), sorter.sort());
+
+  sorter.allocated("b", slaveId, Resources::parse("cpus:20;mem:20").get());
+
+  // Shares: c = 0, a = 0.1 (a/y = 0, a/x = 0.1), b = 0.2.
+  EXPECT_EQ(vector<string>({"c/z", "a/y", "a/x", "b"}), sorter.sort());
+
+  sorter.unallocated(
+      "a/x", slaveId, Resources::parse("cpus:10;mem:10").get());
+
+  // Shares: c = 0, a = 0 (a/y = 0, a/x = 0), b = 0.2. Ties are broken
+  // by the number of allocations, which is 1 for "a" and "a/x".
+  EXPECT_EQ(vector<string>({"c/z", "a/y", "a/x", "b"}), sorter.sort());
+
+  // Allocations to an inactive client change the position of its
+  // ancestors, and its own position once it is activated.
+  sorter.deactivate("a/y");
+  sorter.allocated("a/y", slaveId, Resources::parse("cpus:50;mem:50").get());
+
+  // Shares: c = 0, b = 0.2, a = 0.5 (a/x = 0).
+  EXPECT_EQ(vector<string>({"c/z", "b", "a/x"}), sorter.sort());
+
+  sorter.activate("a/y");
+
+  // Shares: c = 0, b = 0.2, a = 0.5 (a/x = 0, a/y = 0.5).
+  EXPECT_EQ(vector<string>({"c/z", "b", "a/x", "a/y"}), sorter.sort());
+}
+
+
+// This test checks that a snapshot of a sorter sorts the same way
+// as the sorter, and that allocations made against the snapshot
+// don't affect the original sorter.
+TEST(SorterTest, Snapshot)
+{
+  DRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("agentId");
+
+  Resources totalResources = Resources::parse("cpus:100;mem:100").get();
+  sorter.add(slaveId, totalResources);
+
+  sorter.add("a/x");
+  sorter.add("a/y");
+  sorter.add("b");
+  sorter.add("c");
+
+  sorter.activate("a/x");
+  sorter.activate("a/y");
+  sorter.activate("b");
+
+  sorter.allocated("a/x", slaveId, Resources::parse("cpus:10;mem:10").get());
+  sorter.allocated("b", slaveId, Resources::parse("cpus:5;mem:5").get());
+
+  // Shares: b = 0.05, a = 0.1 (a/y = 0, a/x = 0.1); "c" is inactive.
+  EXPECT_EQ(vector<string>({"b", "a/y", "a/x"}), sorter.sort());
+
+  Owned<Sorter> snapshot(sorter.snapshot());
+
+  EXPECT_EQ(sorter.count(), snapshot->count());
+  EXPECT_EQ(sorter.sort(), snapshot->sort());
+  EXPECT_EQ(
+      sorter.allocationScalarQuantities("a/x"),
+      snapshot->allocationScalarQuantities("a/x"));
+
+  snapshot->allocated("b", slaveId, Resources::parse("cpus:20;mem:20").get());
+
+  // Shares: a = 0.1 (a/y = 0, a/x = 0.1), b = 0.25.
+  EXPECT_EQ(vector<string>({"a/y", "a/x", "b"}), snapshot->sort());
+  EXPECT_EQ(vector<string>({"b", "a/y", "a/x"}), sorter.sort());
+
+  // The snapshot does not copy the resources allocated on each
+  // agent, but only the allocations made after it was taken.
+  EXPECT_EQ(
+      Resources::parse("cpus:20;mem:20").get(),
+      snapshot->allocation("b", slaveId));
+}
+
+
 // This test checks what happens when a new sorter client is added as
 // a child of what was previously a leaf node.
 TEST(SorterTest, AddChildToLeaf)
@@ -1528,15 +1642,17 @@ TEST(SorterTest, RemoveSharedResources)
   sorter.add(
       slaveId, Resources::parse("cpus:100;mem:100;disk(role1):900").get());
 
-  Resources quantity1 = sorter.totalScalarQuantities();
+  ResourceQuantities quantity1 = sorter.totalScalarQuantities();
 
   sorter.add(slaveId, sharedDisk);
-  Resources quantity2 = sorter.totalScalarQuantities();
+  ResourceQuantities quantity2 = sorter.totalScalarQuantities();
 
-  EXPECT_EQ(Resources::parse("disk(role1):100").get(), quantity2 - quantity1);
+  EXPECT_EQ(
+      ResourceQuantities::fromString("disk:100").get(),
+      quantity2 - quantity1);
 
   sorter.add(slaveId, sharedDisk);
-  Resources quantity3 = sorter.totalScalarQuantities();
+  ResourceQuantities quantity3 = sorter.totalScalarQuantities();
 
   EXPECT_NE(quantity1, quantity3);
   EXPECT_EQ(quantity2, quantity3);
@@ -1593,6 +1709,7 @@ TEST_P(Sorter_BENCHMARK_Test, FullSort)
       clients.push_back(clientId);
 
       sorter.add(clientId);
+      sorter.activate(clientId);
     }
   }
   watch.stop();
@@ -1661,6 +1778,30 @@ TEST_P(Sorter_BENCHMARK_Test, FullSort)
   cout << "No-op sort of " << clientCount << " clients took "
        << watch.elapsed() << endl;
 
+  // Like the allocator, allocate to the first client in sort order on
+  // each agent, sorting before every allocation.
+  Resources incremented = Resources::parse("cpus:1;mem:1").get();
+
+  vector<string> incrementedClients;
+  incrementedClients.reserve(agentCount);
+
+  watch.start();
+  {
+    foreach (const SlaveID& slaveId, agents) {
+      const string client = sorter.sort().front();
+      sorter.allocated(client, slaveId, incremented);
+      incrementedClients.push_back(client);
+    }
+  }
+  watch.stop();
+
+  cout << "Sorted and allocated on " << agentCount << " agents in "
+       << watch.elapsed() << endl;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    sorter.unallocated(incrementedClients[i], agents[i], incremented);
+  }
+
   watch.start();
   {
     // Unallocate resources on all agents, round-robin through the clients.
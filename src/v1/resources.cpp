@@ -1334,6 +1334,10 @@ bool Resources::Resource_::contains(const Resource_& that) const
     return false;
   }
 
+  if (!hasSameKeys(that)) {
+    return false;
+  }
+
   // Assuming the wrapped Resource objects are equal, the 'contains'
   // relationship is determined by the relationship of the counters
   // for shared resources.
@@ -1407,6 +1411,20 @@ bool Resources::Resource_::operator!=(const Resource_& that) const
 }
 
 
+void Resources::Resource_::internKeys()
+{
+  name = InternedString(resource.name());
+
+  reservationRole = resource.reservations_size() > 0
+    ? InternedString(resource.reservations().rbegin()->role())
+    : InternedString();
+
+  allocationRole = resource.has_allocation_info()
+    ? InternedString(resource.allocation_info().role())
+    : InternedString();
+}
+
+
 Resources::Resources(const Resource& resource)
 {
   // NOTE: Invalid and zero Resource object will be ignored.
@@ -1478,8 +1496,11 @@ size_t Resources::count(const Resource& that) const
 
 void Resources::allocate(const string& role)
 {
+  const InternedString allocationRole(role);
+
   foreach (Resource_& resource_, resources) {
     resource_.resource.mutable_allocation_info()->set_role(role);
+    resource_.allocationRole = allocationRole;
   }
 }
 
@@ -1489,6 +1510,7 @@ void Resources::unallocate()
   foreach (Resource_& resource_, resources) {
     if (resource_.resource.has_allocation_info()) {
       resource_.resource.clear_allocation_info();
+      resource_.allocationRole = InternedString();
     }
   }
 }
@@ -1595,6 +1617,7 @@ Resources Resources::pushReservation(
   foreach (Resource_ resource_, *this) {
     resource_.resource.add_reservations()->CopyFrom(reservation);
     CHECK_NONE(Resources::validate(resource_.resource));
+    resource_.internKeys();
     result.add(resource_);
   }
 
@@ -1609,6 +1632,7 @@ Resources Resources::popReservation() const
   foreach (Resource_ resource_, resources) {
     CHECK_GT(resource_.resource.reservations_size(), 0);
     resource_.resource.mutable_reservations()->RemoveLast();
+    resource_.internKeys();
     result.add(resource_);
   }
 
@@ -1622,6 +1646,7 @@ Resources Resources::toUnreserved() const
 
   foreach (Resource_ resource_, *this) {
     resource_.resource.clear_reservations();
+    resource_.reservationRole = InternedString();
     result.add(resource_);
   }
 
@@ -1927,6 +1952,7 @@ Option<Resources> Resources::find(const Resource& target) const
           r.resource.mutable_reservations()->CopyFrom(
               resource_.resource.reservations());
 
+          r.internKeys();
           found.add(r);
         }
 
@@ -2003,7 +2029,10 @@ void Resources::add(const Resource_& that)
 
   bool found = false;
   foreach (Resource_& resource_, resources) {
-    if (internal::addable(resource_.resource, that)) {
+    // Comparing the interned keys first rules out most resources
+    // without having to compare the protobufs.
+    if (resource_.hasSameKeys(that) &&
+        internal::addable(resource_.resource, that)) {
       resource_ += that;
       found = true;
       break;
@@ -2078,7 +2107,8 @@ void Resources::subtract(const Resource_& that)
   for (size_t i = 0; i < resources.size(); i++) {
     Resource_& resource_ = resources[i];
 
-    if (internal::subtractable(resource_.resource, that)) {
+    if (resource_.hasSameKeys(that) &&
+        internal::subtractable(resource_.resource, that)) {
       resource_ -= that;
 
       // Remove the resource if it has become negative or empty.